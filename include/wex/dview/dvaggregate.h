@@ -0,0 +1,141 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __DVAggregate_h
+#define __DVAggregate_h
+
+/*
+ * wxDVCalendarAggregate summarizes a time series by the hours, days and
+ * months of DView's 8760 hour year in a single pass over its points, for
+ * the hourly, daily and monthly time series, the statistics table and the
+ * profiles to share.  Points are folded into day buckets as they are read
+ * and months are merged from days.  Hours are only counted: their buckets are
+ * read again from the points when asked for, so for hourly data the aggregate
+ * stays a small fraction of the data set.  An update only reads the points
+ * appended since the last one, or since the month of the first point that
+ * changed (see Invalidate).
+ *
+ * There is one aggregate per data set (see Get), shared by everything that
+ * shows it.  All methods are thread safe, so it can be updated on a worker
+ * thread (see wxDVStatisticsTableCtrl).
+ */
+
+#include <stddef.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class wxDVTimeSeriesDataSet;
+
+enum wxDVCalendarPeriod {
+    wxDV_PERIOD_HOUR, wxDV_PERIOD_DAY, wxDV_PERIOD_MONTH
+};
+
+struct wxDVPeriodStats {
+    double lower, upper; // hours since Jan 1 00:00 of year 1
+    size_t first; // index of the first point of the period in the data set
+    double count; // points that are not missing
+    double sum;
+    double min, max; // missing if count is 0
+    double sqDev; // sum of squared deviations from the mean
+
+    double Mean() const;
+
+    //Population standard deviation, 0 if count is 0.
+    double StDev() const;
+
+    void Add(double y);
+
+    //Adds the points of p; the periods' deviations are combined without revisiting the points.
+    void Merge(const wxDVPeriodStats &p);
+};
+
+class wxDVCalendarAggregate {
+public:
+    //Hours since Jan 1 00:00 at which each month of a year starts.
+    static const double MONTH_START_HOURS[13];
+
+    //Finds the hour, day or month that hour x falls in.
+    static void GetPeriod(double x, wxDVCalendarPeriod period, double *lower, double *upper);
+
+    //Month of the year (0-11) that hour x falls in.
+    static int GetMonthOfYear(double x);
+
+    //The aggregate of d, made (empty) on first request.  It lives as long as something holds on to it.
+    static std::shared_ptr<wxDVCalendarAggregate> Get(wxDVTimeSeriesDataSet *d);
+
+    explicit wxDVCalendarAggregate(wxDVTimeSeriesDataSet *d);
+
+    wxDVTimeSeriesDataSet *GetDataSet() const { return m_data; }
+
+    //Folds in the points appended to the data set since the last update (reading a lazy data set).
+    //Starts over if the data set got shorter.
+    void Update();
+
+    //The points from index from on were changed or replaced; the next update reads them again.
+    void Invalidate(size_t from);
+
+    //Number of points summarized so far.
+    size_t GetLength() const;
+
+    size_t GetPeriodCount(wxDVCalendarPeriod period) const;
+
+    //Copies the periods from index start on.  Only periods with points are kept; the last one grows
+    //with the points appended to the data set.  Hours are computed from the points of the data set.
+    void GetPeriods(wxDVCalendarPeriod period, size_t start, std::vector<wxDVPeriodStats> &periods) const;
+
+    //Points per day in the profiles: 24 / timestep, or 0 if the timestep is longer than a day.
+    size_t GetProfileSlots() const;
+
+    //Sum and count of the non-missing points at each time of day of a month of the year (0-11),
+    //all years together.  Slot 0 starts at the data set's offset within its timestep.
+    void GetProfile(int month, std::vector<double> &sums, std::vector<double> &counts) const;
+
+private:
+    void Restart();
+
+    wxDVTimeSeriesDataSet *m_data;
+    mutable std::mutex m_mutex;
+    size_t m_length;
+    std::vector<wxDVPeriodStats> m_days, m_months;
+    std::vector<size_t> m_dayHours; // number of hours with points before each day
+    size_t m_hours; // hours with points so far
+    double m_hourUpper; // end of the last of them
+    size_t m_openMonthStart; // index in m_days of the first day of the last month
+    size_t m_slots;
+    double m_slotOffset;
+    std::vector<double> m_profileLower; // start of each month with a profile row
+    std::vector<double> m_profileSums, m_profileCounts; // m_profileLower.size() x m_slots
+};
+
+#endif
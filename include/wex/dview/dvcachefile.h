@@ -0,0 +1,85 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __DVCacheFile_h
+#define __DVCacheFile_h
+
+/*
+ * wxDVCacheFile keeps a binary columnar copy of the data sets read from a
+ * file, so that reopening a large csv/epw/sql file maps the cache instead of
+ * parsing the source again.  Caches live in the user's local data directory
+ * and are only used while the source file's path, size and modification time
+ * still match the ones recorded when the cache was written.  A cache that no
+ * longer matches is deleted when it is found, and after each write the least
+ * recently used caches are deleted while the directory is over its size limit.
+ * Small files are not cached at all, since parsing them is quick.
+ *
+ * A variant string distinguishes caches of the same file read with different
+ * options, e.g. the SI or IP units choice for Energy+ sql files.
+ *
+ * A wxDVResampledDataSet is stored as its source samples and grid index, not
+ * its interpolated grid, and read back as a wxDVResampledDataSet.
+ */
+
+#include <vector>
+
+#include <wx/string.h>
+
+class wxDVArrayDataSet;
+
+class wxDVCacheFile {
+public:
+    static wxString GetCacheDir();
+
+    static wxString GetCachePath(const wxString &sourceFile, const wxString &variant = wxEmptyString);
+
+    static bool Write(const wxString &sourceFile, const std::vector<wxDVArrayDataSet *> &dataSets,
+                      const wxString &variant = wxEmptyString);
+
+    // Creates new data sets from an up-to-date cache; the caller takes ownership.
+    static bool Read(const wxString &sourceFile, std::vector<wxDVArrayDataSet *> &dataSets,
+                     const wxString &variant = wxEmptyString);
+
+    static bool Remove(const wxString &sourceFile, const wxString &variant = wxEmptyString);
+
+    // Source files smaller than this are not cached.
+    static void SetMinSourceSize(wxUint64 bytes);
+
+    static wxUint64 GetMinSourceSize();
+
+    // Total size of the cache directory that writes trim it to; 0 means no limit.
+    static void SetMaxTotalSize(wxUint64 bytes);
+
+    static wxUint64 GetMaxTotalSize();
+};
+
+#endif
@@ -36,6 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 #include <wx/panel.h>
 #include "wex/plot/plplotctrl.h"
+#include "wex/dview/dvmemorybudget.h"
 
 class wxDVTimeSeriesDataSet;
 
@@ -57,6 +58,8 @@ public:
 
     void RemoveDataSet(wxDVTimeSeriesDataSet *d);
 
+    void UpdateDataSet(wxDVTimeSeriesDataSet *d); //Call after d changed.
+
     void RemoveAllDataSets();
 
     void ShowPlotAtIndex(int index);
@@ -87,13 +90,20 @@ private:
     wxDVSelectionListCtrl *m_dataSelector;
     wxSearchCtrl *m_srchCtrl;
 
-    struct PlotSet {
-        PlotSet(wxDVTimeSeriesDataSet *ds);
+    //The curve of a data set; the memory budget may free it while it is hidden.
+    struct PlotSet : public wxDVMemoryBudget::Entry {
+        PlotSet(wxDVTimeSeriesDataSet *ds, wxPLPlotCtrl *plotSurface);
 
         ~PlotSet();
 
+        virtual size_t GetMemorySize() const;
+
+        virtual bool Evict();
+
         wxDVTimeSeriesDataSet *dataset;
+        wxPLPlotCtrl *surface; // the curve is shown when it is on this
         wxPLLinePlot *plot;
+        unsigned long version; // of the data set the curve was calculated from
         wxPLPlotCtrl::AxisPos axisPosition;
     };
 
@@ -75,6 +75,11 @@ class wxTimerEvent;
 
 class wxDVDMapCtrl : public wxPanel {
 public:
+    //How samples are combined when several cells share a device pixel.
+    enum AggregateMode {
+        AGGREGATE_MEAN, AGGREGATE_MIN, AGGREGATE_MAX
+    };
+
     wxDVDMapCtrl(wxWindow *parent, wxWindowID id = wxID_ANY,
                  const wxPoint &pos = wxDefaultPosition, const wxSize &size = wxDefaultSize);
 
@@ -86,6 +91,9 @@ public:
     void RemoveDataSet(wxDVTimeSeriesDataSet *d); //releases ownership, does not delete.
     void RemoveAllDataSets(); //clear all data sets from graphs and memory. (delete plottables.  Never took ownership.
 
+    //Call after points were appended to d, which had prevLength points before.
+    void UpdateDataSet(wxDVTimeSeriesDataSet *d, size_t prevLength);
+
     wxString GetCurrentDataName();
 
     bool SetCurrentDataName(const wxString &name);
@@ -98,6 +106,10 @@ public:
 
     bool IsReversedColours();
 
+    void SetAggregateMode(AggregateMode mode);
+
+    AggregateMode GetAggregateMode();
+
     void SelectDataSetAtIndex(int index);
 
     int GetNumberOfSelections();
@@ -213,6 +225,8 @@ public:
 
     void OnReverseColours(wxCommandEvent &);
 
+    void OnAggregateSelection(wxCommandEvent &);
+
     void Invalidate(); // recalculate and rerender plot
 
 private:
@@ -230,6 +244,7 @@ private:
     wxSearchCtrl *m_srchCtrl;
     wxChoice *m_colourMapSelector;
     wxCheckBox *m_reverseColours;
+    wxChoice *m_aggregateSelector;
 
     wxTextCtrl *m_minTextBox;
     wxTextCtrl *m_maxTextBox;
@@ -0,0 +1,182 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __DVFileLoader_h
+#define __DVFileLoader_h
+
+/*
+ * wxDVFileLoader reads data files into a wxDVPlotCtrl in the background.
+ * Each file goes through three stages:
+ *
+ *   read    wxDVFileReader::ReadDataSets parses it on a worker thread;
+ *   derive  the same thread computes the calendar aggregates and min/max
+ *           index that the tabs would otherwise build when first shown;
+ *   publish batches of data sets are added to the plot on the UI thread
+ *           as soon as they are derived, so the first channels can be
+ *           plotted while the rest are still being prepared.
+ *
+ * Files are read one after the other, in the order they were queued.
+ * Progress and the outcome of each file are reported to a handler with
+ * wxDVFileLoaderEvent.  Energy+ sql files and followed files are not read
+ * this way; use wxDVFileReader::FastRead for those.
+ */
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <wx/event.h>
+#include <wx/arrstr.h>
+
+#include "wex/dview/dvworkerpool.h"
+
+class wxDVPlotCtrl;
+
+class wxDVArrayDataSet;
+
+class wxDVCalendarAggregate;
+
+BEGIN_DECLARE_EVENT_TYPES()
+DECLARE_EVENT_TYPE(wxEVT_DVFILELOADER, -1)
+END_DECLARE_EVENT_TYPES()
+
+class wxDVFileLoaderEvent : public wxEvent {
+public:
+    enum {
+        PROGRESS, LOADED, FAILED, CANCELED
+    };
+
+    wxDVFileLoaderEvent(int id, wxEventType type, int code, const wxString &fileName,
+                        int percent = 0, int filesQueued = 0, int dataSetsAdded = 0)
+            : wxEvent(id, type) {
+        m_code = code;
+        m_fileName = fileName;
+        m_percent = percent;
+        m_filesQueued = filesQueued;
+        m_dataSetsAdded = dataSetsAdded;
+    }
+
+    wxDVFileLoaderEvent(const wxDVFileLoaderEvent &evt)
+            : wxEvent(evt.GetId(), evt.GetEventType()),
+              m_code(evt.m_code),
+              m_fileName(evt.m_fileName),
+              m_percent(evt.m_percent),
+              m_filesQueued(evt.m_filesQueued),
+              m_dataSetsAdded(evt.m_dataSetsAdded) {}
+
+    int GetStatusCode() const { return m_code; }
+
+    wxString GetFileName() const { return m_fileName; }
+
+    // How far the file has got, 0-100.
+    int GetPercent() const { return m_percent; }
+
+    // Files waiting to be read after this one.
+    int GetFilesQueued() const { return m_filesQueued; }
+
+    // Data sets of the file that were added to the plot, set once the file is done.  A CANCELED file
+    // may have some; they stay in the plot.
+    int GetDataSetsAdded() const { return m_dataSetsAdded; }
+
+    virtual wxEvent *Clone() const { return new wxDVFileLoaderEvent(*this); }
+
+protected:
+    int m_code;
+    wxString m_fileName;
+    int m_percent;
+    int m_filesQueued;
+    int m_dataSetsAdded;
+};
+
+typedef void (wxEvtHandler::*wxDVFileLoaderEventFunction)(wxDVFileLoaderEvent &);
+
+#define wxDVFileLoaderEventFunction(func) \
+        (wxObjectEventFunction)(wxEventFunction)wxStaticCastEvent(wxDVFileLoaderEventFunction, &func)
+
+#define EVT_DVFILELOADER(id, fn) \
+        wx__DECLARE_EVT1(wxEVT_DVFILELOADER, id, wxDVFileLoaderEventFunction(fn))
+
+class wxDVFileLoader : public wxEvtHandler {
+public:
+    // Data sets are added to plotWin; events are sent to handler with the given id.
+    wxDVFileLoader(wxDVPlotCtrl *plotWin, wxEvtHandler *handler, int id = wxID_ANY);
+
+    virtual ~wxDVFileLoader(); // cancels what is left and waits for the worker
+
+    void Load(const wxString &fileName);
+
+    // true if the file is queued or being read.
+    bool IsLoading(const wxString &fileName) const;
+
+    bool IsBusy() const { return m_files.GetCount() > 0; }
+
+    // Stops reading.  Data sets published so far stay in the plot, the rest are dropped.  The files that
+    // were not finished are forgotten right away, and reported as CANCELED once the worker lets go of them,
+    // with the number of their data sets that stayed.
+    void Cancel();
+
+private:
+    // Data sets of a file ready to be added to the plot.
+    struct Batch {
+        wxString fileName;
+        std::vector<wxDVArrayDataSet *> dataSets;
+        std::vector<size_t> missing; // empty cells of each data set
+        std::vector<std::shared_ptr<wxDVCalendarAggregate> > aggregates; // kept alive until the tabs pick them up
+        std::shared_ptr<std::atomic<bool> > cancel;
+        int code; // PROGRESS until the file's last batch
+    };
+
+    void ReadFile(const wxString &fileName, std::shared_ptr<std::atomic<bool> > cancel);
+
+    void Hand(Batch &batch); // worker to UI thread
+
+    void OnBatchesReady();
+
+    void Post(int code, const wxString &fileName, int percent, int dataSetsAdded = 0);
+
+    wxDVPlotCtrl *m_plotWin;
+    wxEvtHandler *m_handler;
+    int m_id;
+    wxArrayString m_files; // queued or being read, UI thread only
+    std::shared_ptr<std::atomic<bool> > m_cancel; // set by Cancel for the files queued before it
+    std::atomic<int> m_filesQueued;
+    std::mutex m_readyMutex;
+    std::deque<Batch> m_ready;
+    std::vector<wxDVArrayDataSet *> m_missingDataSets; // of the file being published, for one report at its end
+    std::vector<size_t> m_missing;
+    int m_dataSetsAdded; // of the file being published
+    wxDVWorkerPool m_worker;
+};
+
+#endif
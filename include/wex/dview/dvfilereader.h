@@ -44,7 +44,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * can convert the sql input from its native IP to SI units and values.
  */
 #include <stdio.h>
+#include <atomic>
+#include <functional>
 #include <vector>
+#include <wx/arrstr.h>
+#include <wx/filefn.h>
 #include <wx/string.h>
 
 struct sqlite3;
@@ -55,39 +59,149 @@ class wxDVArrayDataSet;
 
 class wxDateTime;
 
+class wxStopWatch;
+
+class wxWindow;
+
+/*
+ * wxDVFileFollower picks up data rows that are appended to a csv/txt file,
+ * e.g. by a running simulation, after wxDVFileReader::FastRead has read it.
+ * The data sets belong to the plot control they were added to, so stop
+ * following before they are removed from it.
+ */
+class wxDVFileFollower {
+public:
+    wxDVFileFollower();
+
+    bool IsOk() const { return m_dataSets.size() > 0; }
+
+    wxString GetFileName() const { return m_fileName; }
+
+    const std::vector<wxDVArrayDataSet *> &GetDataSets() const { return m_dataSets; }
+
+    // Appends the complete rows written since the last call to the data sets and returns how many
+    // were read, or -1 if the file can no longer be followed (it shrank, was removed or has ended).
+    // prevLengths receives the length of each data set before the new rows.
+    int ReadAppendedRows(std::vector<size_t> &prevLengths);
+
+    void Stop();
+
+private:
+    friend class wxDVFileReader;
+
+    wxString m_fileName;
+    std::vector<wxDVArrayDataSet *> m_dataSets;
+    wxFileOffset m_offset; // where the first row not read yet starts
+    bool m_commaDelimiters;
+    bool m_ended;
+    // lengths of the data sets before the last row, if it was read from an incomplete line
+    std::vector<size_t> m_partialRowLengths;
+};
+
 using namespace std;
 
 class wxDVFileReader {
 public:
     static void ReadDataFromCSV(wxDVPlotCtrl *plotWin, const wxString &filename, wxChar separator = ',');
 
+    // memory_map parses the data rows in place from a read-only mapping of the file
+    // instead of copying them line by line; it falls back to stdio if mapping fails.
+    // If follower is given, it is set up to read rows appended to a csv/txt file later on;
+    // such files are neither read from nor written to the cache.
     static bool
-    FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int prealloc_data = 8760, int prealloc_lnchars = 1024);
+    FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int prealloc_data = 8760, int prealloc_lnchars = 1024,
+             bool memory_map = true, wxDVFileFollower *follower = 0);
 
     static bool Read8760WFLines(std::vector<wxDVArrayDataSet *> &dataSets, FILE *infile, int wfType);
 
     static bool ReadWeatherFile(wxDVPlotCtrl *plotWin, const wxString &filename);
 
+    // True for the weather files FastRead hands to ReadWeatherFile (tm2, epw).
+    static bool IsWeatherFile(const wxString &filename);
+
+    // Reads several weather files at once without touching the UI; dataSets[i] receives the
+    // data sets of filenames[i], or none if it could not be read. Add them with AddWeatherDataSets.
+    static void ReadWeatherFiles(const wxArrayString &filenames,
+                                 std::vector<std::vector<wxDVArrayDataSet *> > &dataSets);
+
+    // Adds the data sets of a weather file to the plot, which takes ownership. False if there are none.
+    static bool AddWeatherDataSets(wxDVPlotCtrl *plotWin, const wxString &filename,
+                                   std::vector<wxDVArrayDataSet *> &dataSets);
+
     static bool ReadSQLFile(wxDVPlotCtrl *plotWin, const wxString &filename);
 
+    // Reads a csv/txt, weather or cached file like FastRead, but only into data sets (with their group names
+    // set) so it can run on a worker thread; see wxDVFileLoader.  Energy+ sql files are not read this way.
+    // missing receives the number of empty cells of each data set.  Gives up, returning false, once cancel is set.
+    // progress is called with the bytes parsed so far and the file size while a csv/txt file is parsed, from
+    // the threads parsing it, so it must be thread safe.
+    typedef std::function<void(size_t parsed, size_t total)> ProgressFunc;
+
+    static bool ReadDataSets(const wxString &filename, std::vector<wxDVArrayDataSet *> &dataSets,
+                             std::vector<size_t> &missing, const std::atomic<bool> *cancel = 0,
+                             const ProgressFunc &progress = ProgressFunc());
+
+    // Shows one message for all the data sets that have empty cells, once a file has been read.
+    static void ReportMissingData(wxWindow *parent, const std::vector<wxDVArrayDataSet *> &dataSets,
+                                  const std::vector<size_t> &missing);
+
+    // Files read successfully are cached in a binary sidecar (see wxDVCacheFile)
+    // that is used instead of parsing the file again while it is unchanged.
+    static void SetUseCache(bool b);
+
+    static bool GetUseCache();
+
+    // Csv/txt files with at least this many columns are opened lazily: only a row index is built,
+    // and each column is parsed the first time it is viewed. Such files are not cached; 0 turns this off.
+    static void SetLazyColumns(int minColumns);
+
+    static int GetLazyColumns();
+
     static bool IsNumeric(wxString stringToCheck);
 
     static bool IsDate(wxString stringToCheck);
 
+    // Locale independent atof() for a range that need not be null terminated.
+    // If stop is given, it receives the position after the last character used.
+    static double ParseDouble(const char *p, const char *end, const char **stop = 0);
+
 private:
+    static bool ReadWeatherDataSets(const wxString &filename, std::vector<wxDVArrayDataSet *> &dataSets);
+
+    static bool AddCachedDataSets(wxDVPlotCtrl *plotWin, const wxString &filename,
+                                  const wxString &variant = wxEmptyString);
+
+    struct TextFileInfo;
+
+    // The part of FastRead that parses a csv/txt file; it does not touch the UI.
+    static bool ReadTextDataSets(const wxString &filename, int prealloc_data, unsigned &lnchars, bool memory_map,
+                                 wxDVFileFollower *follower, std::vector<wxDVArrayDataSet *> &dataSets,
+                                 TextFileInfo &info, const std::atomic<bool> *cancel,
+                                 const ProgressFunc &progress);
+
+    static bool AddFastReadDataSets(wxDVPlotCtrl *plotWin, const wxString &filename,
+                                    std::vector<wxDVArrayDataSet *> &dataSets,
+                                    int line, int columns, int prealloc_data, unsigned lnchars,
+                                    int nthreads, wxStopWatch &sw, bool writeCache);
+
     static wxString ColumnText(const unsigned char *column);
 
     static bool IsEnergyPlus(sqlite3 *db);
 
     static void ExecAndThrowOnError(const std::string &t_stmt, sqlite3 *db);
 
-    // Interpolates to synthesize data at the 1 minute timeStep
-    static void NonuniformTimestepInterpolation(const std::vector<wxDateTime> &times, std::vector<double> &values);
+    // Places each sample on the 1 minute timeStep grid, for interpolation by wxDVResampledDataSet
+    static void NonuniformTimestepGrid(const std::vector<wxDateTime> &times, std::vector<size_t> &gridIndex);
 
     static void InitUnitConversions();
 
     // Converts both the units and the values
     static bool ConvertUnits(std::string &units, std::vector<double> &values, bool convertSIToIP = true);
+
+    // As above, but appends units that can't be converted to failedUnits ("units, ") instead of
+    // showing a message, so it can be used off the UI thread.
+    static bool ConvertUnits(std::string &units, std::vector<double> &values, bool convertSIToIP,
+                             wxString *failedUnits);
 };
 
 #endif
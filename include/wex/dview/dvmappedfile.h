@@ -0,0 +1,77 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __DVMappedFile_h
+#define __DVMappedFile_h
+
+/*
+ * wxDVMappedFile maps a whole file read-only into memory so the readers can
+ * tokenize it in place instead of copying it line by line through stdio.
+ * Only the bytes that are actually touched get paged in.
+ */
+
+#include <stddef.h>
+
+#include <wx/string.h>
+
+class wxDVMappedFile {
+public:
+    wxDVMappedFile();
+
+    ~wxDVMappedFile();
+
+    bool Open(const wxString &filename);
+
+    void Close();
+
+    bool IsOk() const { return m_data != 0; }
+
+    const char *GetData() const { return m_data; }
+
+    size_t GetSize() const { return m_size; }
+
+private:
+    wxDVMappedFile(const wxDVMappedFile &);
+
+    wxDVMappedFile &operator=(const wxDVMappedFile &);
+
+    const char *m_data;
+    size_t m_size;
+#ifdef __WXMSW__
+    void *m_fileHandle;
+    void *m_mapHandle;
+#else
+    int m_fd;
+#endif
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __DVMemoryBudget_h
+#define __DVMemoryBudget_h
+
+/*
+ * wxDVMemoryBudget keeps the data the views derive from the data sets (sorted
+ * values, duration curves) within a memory limit.  Each derived product is an
+ * entry that reports its size when it is used; when the sizes add up to more
+ * than the limit, the least recently used entries are evicted.  An evicted
+ * entry frees its data and computes it again the next time it is shown.
+ * Entries that are on screen refuse to go.  Use from the user interface
+ * thread only.
+ */
+
+#include <stddef.h>
+
+#include <list>
+#include <map>
+
+class wxDVMemoryBudget {
+public:
+    //Data derived from a data set that can be freed and computed again.
+    class Entry {
+    public:
+        Entry() {}
+
+        //Leaves the budget.
+        virtual ~Entry();
+
+        //Bytes held now, 0 once evicted.
+        virtual size_t GetMemorySize() const = 0;
+
+        //Frees the data, or returns false if it is shown and has to stay.  Must not call the budget.
+        virtual bool Evict() = 0;
+
+    private:
+        Entry(const Entry &);
+
+        Entry &operator=(const Entry &);
+    };
+
+    //The budget shared by all views.
+    static wxDVMemoryBudget &Get();
+
+    //Evicts entries right away if the usage is over the new limit.
+    void SetLimit(size_t bytes);
+
+    size_t GetLimit() const { return m_limit; }
+
+    //Bytes held by the entries as of their last Touch.
+    size_t GetUsage() const { return m_usage; }
+
+    //Records the size of e after it was used or changed and makes it the most recently used entry,
+    //then evicts the least recently used others while the usage is over the limit.
+    void Touch(Entry *e);
+
+    //Forgets e without evicting it.
+    void Remove(Entry *e);
+
+private:
+    wxDVMemoryBudget();
+
+    //Evicts from the least recently used end, sparing keep.
+    void Trim(Entry *keep);
+
+    struct Item {
+        Entry *entry;
+        size_t size;
+    };
+
+    size_t m_limit;
+    size_t m_usage;
+    std::list<Item> m_items; // most recently used first; entries holding nothing are left out
+    std::map<Entry *, std::list<Item>::iterator> m_index;
+};
+
+#endif
@@ -64,9 +64,17 @@ public:
     //When a data set is added, wxDVTimeSeriesCtrl takes ownership and will delete it upon destruction.
     void AddDataSet(wxDVTimeSeriesDataSet *d, bool update_ui = true);
 
+    //Adds several data sets at once, refreshing the tabs only after the last one.
+    //Their statistics are computed in parallel in the background (see wxDVStatisticsTableCtrl).
+    void AddDataSets(const std::vector<wxDVTimeSeriesDataSet *> &d, bool update_ui = true);
+
     //RemoveDataSet releases ownership.
     void RemoveDataSet(wxDVTimeSeriesDataSet *d);
 
+    //Call after points were appended to d, which had prevLength points before.
+    //Summaries and statistics are extended rather than recalculated from scratch.
+    void UpdateDataSet(wxDVTimeSeriesDataSet *d, size_t prevLength, bool update_ui = true);
+
     //RemoveAll deletes data sets.
     void RemoveAllDataSets();
 
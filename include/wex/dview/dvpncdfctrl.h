@@ -34,10 +34,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __DVPnCdfCtrl_h
 
 #include <wx/panel.h>
+#include <memory>
 #include <vector>
 
 #include "wex/plot/plhistplot.h"
 
+#include "wex/dview/dvmemorybudget.h"
 #include "wex/dview/dvtimeseriesdataset.h"
 
 class wxCheckBox;
@@ -48,6 +50,8 @@ class wxComboBox;
 
 class wxDVSelectionListCtrl;
 
+class wxDVSortedValues;
+
 class wxPLLinePlot;
 
 class wxPlPlotCtrl;
@@ -72,6 +76,8 @@ public:
 
     void RemoveAllDataSets();
 
+    void UpdateDataSet(wxDVTimeSeriesDataSet *d); //Call after points were appended to d.
+
     wxString GetCurrentDataName();
 
     bool SetCurrentDataName(const wxString &name, bool restrictNoSmallDataSet = false);
@@ -100,6 +106,10 @@ public:
     void SetPValue(double pValue);
     double GetPValueX() { return m_pValue_x; };
 
+    //Approximate cdfs come from a wxDVQuantileSketch instead of sorting every value.
+    bool IsCdfApproximate() const { return m_approximateCdf; }
+    void SetCdfApproximate(bool approximate);
+
     void ReadCdfFrom(wxDVTimeSeriesDataSet &d, std::vector<wxRealPoint> *cdfArray);
 
     void ChangePlotDataTo(wxDVTimeSeriesDataSet *d, bool forceDataRefresh = false);
@@ -127,17 +137,34 @@ public:
 
     void OnShowZerosClick(wxCommandEvent &);
 
+    void OnApproximateCdfClick(wxCommandEvent &);
+
  //   void OnPlotTypeSelection(wxCommandEvent &);
 
 private:
+    //Exact cdf of a data set, shared with the duration curves.  The memory budget
+    //may drop it while another data set is shown; it is sorted again when needed.
+    struct CdfValues : public wxDVMemoryBudget::Entry {
+        explicit CdfValues(wxDVPnCdfCtrl *ctrl) : owner(ctrl) {}
+
+        virtual size_t GetMemorySize() const;
+
+        virtual bool Evict();
+
+        wxDVPnCdfCtrl *owner;
+        std::shared_ptr<const wxDVSortedValues> values;
+    };
+
     std::vector<wxDVTimeSeriesDataSet *> m_dataSets;
     int m_selectedDataSetIndex;
     double m_pValue; // user entered or set programmatically
     double m_pValue_x; // x coordinant of user specified p Value
-    std::vector<std::vector<wxRealPoint> *> m_cdfPlotData; //We track cdf plots since they take long to calculate.
+    std::vector<std::vector<wxRealPoint> *> m_cdfPlotData; //We track approximate cdf plots since they take long to calculate.
+    std::vector<CdfValues *> m_sortedValues; //Exact cdfs, parallel to m_dataSets.
 
     bool m_bshowpvalue;
     bool m_bshowhidezeros;
+    bool m_approximateCdf;
  //   wxTextCtrl* m_y1MaxTextBox;
  //   wxTextCtrl* m_y2MaxTextBox;
     
@@ -154,6 +181,7 @@ private:
     wxComboBox *m_binsCombo;
     wxChoice *m_normalizeChoice;
     wxCheckBox *m_hideZeros;
+    wxCheckBox *m_approximateCdfCheck;
   //  wxChoice *m_PlotTypeDisplayed;
 
     wxPLPlotCtrl *m_plotSurface;
@@ -164,6 +192,12 @@ private:
 
     void InvalidatePlot();
 
+    //Reads the cdf of m_dataSets[index] in the current mode, unless it is up to date, and plots it.
+    void ReadCdf(int index, bool forceDataRefresh);
+
+    //The last value of the cdf of m_dataSets[index] at or below percent (or the first one); false if it is empty.
+    bool GetCdfValue(int index, double percent, double *x);
+
  //   void EnterY1Max();
  //   void EnterY2Max();
     void EnterPValue();
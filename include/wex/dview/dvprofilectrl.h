@@ -33,13 +33,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __DV_ProfileCtrl_h
 #define __DV_ProfileCtrl_h
 
+#include <memory>
 #include <vector>
 #include <wx/panel.h>
 
 #include "wex/plot/plplotctrl.h"
+#include "wex/dview/dvworkerpool.h"
 
 class wxDVTimeSeriesDataSet;
 
+class wxDVCalendarAggregate;
+
 class wxPLLinePlot;
 
 class wxDVSelectionListCtrl;
@@ -67,6 +71,8 @@ public:
     void AddDataSet(wxDVTimeSeriesDataSet *d, bool update_ui);
 
     bool RemoveDataSet(wxDVTimeSeriesDataSet *d); //true if found & removed.
+
+    void UpdateDataSet(wxDVTimeSeriesDataSet *d); //Call after d changed.
     //RemoveAllDataSets does not delete original datasets since we never took ownership.
     void RemoveAllDataSets();
 
@@ -115,10 +121,15 @@ private:
 
         ~PlotSet();
 
+        //The plots are up to date with the data set.
+        bool IsCalculated() const;
+
         void CalculateProfileData();
 
         wxDVTimeSeriesDataSet *dataset;
+        std::shared_ptr<wxDVCalendarAggregate> aggregate; // shared with the other views of dataset
         wxPLLinePlot *plots[13];
+        unsigned long version; // of the data set the plots were calculated from
         wxPLPlotCtrl::AxisPos axisPosition;
     };
 
@@ -135,6 +146,9 @@ private:
 
     void CalculateProfilePlotData(PlotSet *ps);
 
+    //Brings the aggregates of the plot sets at indices up to date on m_workers, then builds their plots.
+    void CalculateProfileData(const std::vector<int> &indices);
+
     void MonthSelection(unsigned index);
 
     void OnTimer(wxTimerEvent &event);
@@ -144,6 +158,8 @@ private:
     std::vector<int> m_selections;
     unsigned m_counter;
 
+    wxDVWorkerPool m_workers;
+
 DECLARE_EVENT_TABLE();
 };
 
@@ -0,0 +1,103 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __DVQuantileSketch_h
+#define __DVQuantileSketch_h
+
+/*
+ * wxDVQuantileSketch summarizes a stream of values in one pass so that
+ * quantiles and ranks can be read back approximately.  It is a KLL sketch:
+ * a stack of compactors where level h holds items standing for 2^h values
+ * each.  When the sketch is full, the lowest full level is sorted and every
+ * other item (starting at a random offset) moves up a level.  Memory stays
+ * at about 3*k values whatever the stream length, and sketches of separate
+ * streams can be merged.  Ranks are typically off by no more than about
+ * GetRankError() (as a fraction of the count).
+ */
+
+#include <stddef.h>
+
+#include <random>
+#include <vector>
+
+class wxDVQuantileSketch {
+public:
+    //Larger k is more accurate and bigger; k=200 gives about 1.3% rank error.
+    explicit wxDVQuantileSketch(unsigned k = 200);
+
+    void Clear();
+
+    void Add(double value);
+
+    void Merge(const wxDVQuantileSketch &other);
+
+    bool IsEmpty() const { return m_count == 0; }
+
+    //Number of values added, and number the sketch retains to stand for them.
+    size_t GetCount() const { return m_count; }
+
+    size_t GetRetainedCount() const { return m_retained; }
+
+    //Exact extremes of the values added.
+    double GetMin() const { return m_min; }
+
+    double GetMax() const { return m_max; }
+
+    //fraction 0 returns the min and 1 the max.
+    double GetQuantile(double fraction) const;
+
+    //Fraction of the values <= value.
+    double GetRank(double value) const;
+
+    //Approximate rank error for this k, not a guaranteed bound.
+    double GetRankError() const;
+
+    //The retained values in order, each with the number of values it is estimated to be >=.
+    void GetSortedView(std::vector<double> &values, std::vector<double> &counts) const;
+
+private:
+    size_t GetCapacity(size_t level) const;
+
+    void UpdateCapacity();
+
+    void Compress();
+
+    unsigned m_k;
+    size_t m_count;
+    size_t m_retained;
+    size_t m_capacity; // sum of the level capacities
+    double m_min, m_max;
+    std::vector<std::vector<double> > m_levels;
+    std::minstd_rand m_random;
+};
+
+#endif
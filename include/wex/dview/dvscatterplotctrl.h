@@ -37,6 +37,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <vector>
 
+#include "wex/dview/dvworkerpool.h"
+
 class wxCheckBox;
 
 class wxDVSelectionListCtrl;
@@ -73,6 +75,11 @@ public:
 
     bool IsAnythingSelected();
 
+    //Channel pairs longer than this are drawn as point densities instead of markers; 0 never does.
+    void SetDensityThreshold(size_t npoints);
+
+    size_t GetDensityThreshold() const { return m_densityThreshold; }
+
     void ReadState(std::string filename);
 
     void WriteState(std::string filename);
@@ -97,6 +104,8 @@ private:
     wxPLPlotCtrl *m_plotSurface;
     wxCheckBox *m_showPerfAgreeLine;
     bool m_showLine;
+    size_t m_densityThreshold;
+    wxDVWorkerPool m_workers;
 
     void SetXAxisChannel(int index);
 
@@ -0,0 +1,91 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __DVSortedValues_h
+#define __DVSortedValues_h
+
+/*
+ * wxDVSortedValues holds the non-missing values of a data set in ascending
+ * order, for the duration curve and the exact cdf to share.  There is one
+ * per data set and zeros setting (see Get); it is freed when the last view
+ * holding it lets go, which the views do when the data set is removed or
+ * when wxDVMemoryBudget evicts their hold on it.
+ */
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+class wxDVTimeSeriesDataSet;
+
+class wxDVSortedValues {
+public:
+    //The sorted values of d, without its zeros if ignoreZeros.  They are sorted on the first request,
+    //and again once d has changed (see wxDVTimeSeriesDataSet::GetVersion).  The values without zeros are cut from the full ones when those are cached.
+    static std::shared_ptr<const wxDVSortedValues> Get(wxDVTimeSeriesDataSet *d, bool ignoreZeros);
+
+    //Sorts values in chunks on a wxDVWorkerPool and merges the chunks.
+    static void Sort(std::vector<double> &values);
+
+    wxDVSortedValues(wxDVTimeSeriesDataSet *d, bool ignoreZeros);
+
+    wxDVTimeSeriesDataSet *GetDataSet() const { return m_data; }
+
+    //Length of the data set when its values were read.
+    size_t GetDataLength() const { return m_dataLength; }
+
+    //Version of the data set's values that were read.
+    unsigned long GetDataVersion() const { return m_dataVersion; }
+
+    bool IgnoresZeros() const { return m_ignoreZeros; }
+
+    size_t Length() const { return m_values.size(); }
+
+    double At(size_t i) const { return m_values[i]; }
+
+    const std::vector<double> &GetValues() const { return m_values; }
+
+private:
+    wxDVSortedValues() {}
+
+    //The values of all without zeros.
+    static std::shared_ptr<const wxDVSortedValues> WithoutZeros(const wxDVSortedValues &all);
+
+    wxDVTimeSeriesDataSet *m_data;
+    size_t m_dataLength;
+    unsigned long m_dataVersion;
+    bool m_ignoreZeros;
+    std::vector<double> m_values;
+};
+
+#endif
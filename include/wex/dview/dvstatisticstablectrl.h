@@ -56,9 +56,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <wx/stream.h>
 
+#include <map>
+
 #include "wex/numeric.h"
 
 #include "wex/dview/dvtimeseriesdataset.h"
+#include "wex/dview/dvworkerpool.h"
 
 enum {
     ID_STATISTICS_CTRL = 50,
@@ -109,6 +112,9 @@ public:
 
     void RemoveAllChildren();
 
+    void SetValues(double avg, double min, double max, double sum, double stdev, double avgdailymin,
+                   double avgdailymax);
+
     wxString GetName();
 
     double GetMean();
@@ -153,6 +159,9 @@ public:
 
     void Refresh(std::vector<wxDVVariableStatistics *> stats, bool showMonths);
 
+    // Updates the values of the existing nodes in place; false if the tree no longer matches stats.
+    bool UpdateValues(std::vector<wxDVVariableStatistics *> stats, bool showMonths);
+
     wxDataViewItem GetRoot();
 
     // override sorting to always sort branches ascendingly
@@ -191,8 +200,16 @@ public:
 
     void RebuildDataViewCtrl();
 
+    void UpdateDataViewCtrl(); //Refreshes the values shown, rebuilding only if rows were added.
+
+    //The statistics of a loaded data set are computed on a worker thread and show up in the table when ready.
+    //The data set must not change meanwhile; call WaitForStatistics() before appending points to it.
     void AddDataSet(wxDVTimeSeriesDataSet *d);
 
+    void UpdateDataSet(wxDVTimeSeriesDataSet *d); //Call after points were appended to d.
+
+    void WaitForStatistics(); //Blocks until the background computations are done.
+
     bool RemoveDataSet(wxDVTimeSeriesDataSet *d); //Releases ownership, does not delete. //true if found & removed.
     void RemoveAllDataSets(); //Clears all data sets from graphs and memory.
     void WriteDataAsText(wxUniChar sep, wxOutputStream &os, bool visible_only = true, bool include_x = true);
@@ -214,9 +231,19 @@ private:
     wxMenu m_contextMenu;
     wxCheckBox *m_chkShowMonths;
     bool m_showMonths;
+    wxDVWorkerPool m_workers;
+    std::map<wxDVStatisticsDataSet *, size_t> m_pending; // latest request for each data set being computed
+    size_t m_lastRequest;
+    bool m_refreshQueued;
 
     void ShowMonths();
 
+    void ComputeInBackground(wxDVStatisticsDataSet *ds);
+
+    void OnStatisticsReady(wxDVStatisticsDataSet *ds, size_t request, const std::vector<StatisticsPoint> &points);
+
+    void OnStatisticsRefresh();
+
     // event handlers
     void OnCollapse(wxCommandEvent &event);
 
@@ -226,6 +253,8 @@ private:
 
     void OnContextMenu(wxDataViewEvent &event);
 
+    void OnShow(wxShowEvent &e);
+
 DECLARE_EVENT_TABLE();
 };
 
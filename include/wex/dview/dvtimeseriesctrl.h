@@ -170,6 +170,9 @@ public:
     bool RemoveDataSet(wxDVTimeSeriesDataSet *d); //Releases ownership, does not delete. //true if found & removed.
     void RemoveAllDataSets(); //Clears all data sets from graphs and memory.
 
+    //Call after points were appended to d, which had prevLength points before.
+    void UpdateDataSet(wxDVTimeSeriesDataSet *d, size_t prevLength);
+
     //Data Selection:
     wxDVSelectionListCtrl *GetDataSelectionList();
 
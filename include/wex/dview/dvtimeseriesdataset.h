@@ -45,22 +45,132 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *    -This is necessary because of how we iterate through a data set to plot it.
  * -Even Time Step: consecutive points have the same deltaX.
  *    -This is necessary because of how we average in the profile view.
+ *    -wxDVArrayDataSet relies on this to avoid storing x at all.
  *
- * Also, we don't handle missing data points yet.
+ * Missing data points are stored as NaN (see IsMissing) and are left out of
+ * statistics, summaries, profiles and distributions, and drawn as gaps.
  */
 
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include <wx/gdicmn.h>
 #include <wx/string.h>
 #include <math.h>
 
+class wxDVTimeSeriesDataSet;
+
+class wxDVCalendarAggregate;
+
+/*
+ * wxDVMinMaxIndex answers min/max queries over a range of a data set's y
+ * values without scanning all of it: a sparse table over the min and max of
+ * fixed blocks of samples, so only the partial blocks at the ends of a range
+ * are read.  It is built on first use, and after a change only the blocks
+ * from the first changed sample on are recomputed.  Copies start out empty.
+ */
+class wxDVMinMaxIndex {
+public:
+    enum {
+        BLOCK_SIZE = 256
+    };
+
+    wxDVMinMaxIndex();
+
+    wxDVMinMaxIndex(const wxDVMinMaxIndex &);
+
+    wxDVMinMaxIndex &operator=(const wxDVMinMaxIndex &);
+
+    //The samples from index on have changed (or were removed).
+    void Invalidate(size_t index = 0);
+
+    //Narrows *min and *max by the y values of d in [start, end), skipping missing values.
+    void Query(const wxDVTimeSeriesDataSet &d, size_t start, size_t end, double *min, double *max);
+
+private:
+    void Update(const wxDVTimeSeriesDataSet &d);
+
+    std::mutex m_mutex;
+    size_t m_valid; // samples the blocks are up to date for
+    size_t m_length; // length of the data set when they were computed
+    //Level k holds the min (max) of the 2^k blocks starting at each block.
+    std::vector<std::vector<double> > m_mins, m_maxs;
+};
+
+/*
+ * wxDVLODBucket summarizes a run of consecutive samples well enough to draw
+ * it as a line at less than a pixel per sample: the first and last values and
+ * the extremes in the order they occur.  Missing values are skipped; a run of
+ * only missing values has missing first/last and min/max of +/-infinity.
+ */
+struct wxDVLODBucket {
+    double first, last;
+    double min, max;
+    bool minFirst; // the minimum occurs before the maximum
+
+    static wxDVLODBucket Sample(double y);
+
+    static wxDVLODBucket Empty() { return Sample(std::numeric_limits<double>::quiet_NaN()); }
+
+    bool AllMissing() const { return first != first; }
+
+    //Extends the run by the samples of next, which directly follow it.
+    void Append(const wxDVLODBucket &next);
+};
+
+/*
+ * wxDVLODPyramid keeps wxDVLODBuckets of a data set's y values for every
+ * power-of-two bucket size from 2^MIN_LEVEL samples up, so a zoomed-out view
+ * can be drawn from a few buckets per pixel column instead of every sample.
+ * Like wxDVMinMaxIndex it is built on first use and updated from the first
+ * changed sample on; copies start out empty.
+ */
+class wxDVLODPyramid {
+public:
+    enum {
+        MIN_LEVEL = 4
+    };
+
+    wxDVLODPyramid();
+
+    wxDVLODPyramid(const wxDVLODPyramid &);
+
+    wxDVLODPyramid &operator=(const wxDVLODPyramid &);
+
+    void Invalidate(size_t index = 0);
+
+    //Sets buckets to buckets [first, end) of size 2^level, i.e. samples [first << level, end << level).
+    //The last bucket of a level may be partial.  level must be at least MIN_LEVEL.
+    void Query(const wxDVTimeSeriesDataSet &d, size_t level, size_t first, size_t end,
+               std::vector<wxDVLODBucket> &buckets);
+
+private:
+    void Update(const wxDVTimeSeriesDataSet &d);
+
+    std::mutex m_mutex;
+    size_t m_valid;
+    size_t m_length;
+    std::vector<std::vector<wxDVLODBucket> > m_levels; // m_levels[k] has buckets of 2^(MIN_LEVEL+k) samples
+};
+
 class wxDVTimeSeriesDataSet {
     wxString m_metaData, m_groupName;
+    mutable std::atomic<unsigned long> m_version;
 protected:
     /*Constructors and Destructors*/
     wxDVTimeSeriesDataSet();
 
+    /*A copy gets a version of its own.*/
+    wxDVTimeSeriesDataSet(const wxDVTimeSeriesDataSet &d);
+
+    wxDVTimeSeriesDataSet &operator=(const wxDVTimeSeriesDataSet &d);
+
+    /*Must be called whenever the y values change.*/
+    void NewVersion() const;
+
 public:
     virtual ~wxDVTimeSeriesDataSet();
 
@@ -79,6 +189,32 @@ public:
 
     virtual wxString GetLabel() const;
 
+    /*A missing y value, e.g. an empty cell in a csv file.*/
+    static double MissingValue() { return std::numeric_limits<double>::quiet_NaN(); }
+
+    static bool IsMissing(double y) { return y != y; }
+
+    /*Changes whenever the y values do, and is never shared by two data sets, so a cache of
+     *derived data can tell it is stale even when the length is the same.*/
+    unsigned long GetVersion() const { return m_version.load(std::memory_order_acquire); }
+
+    /*False while the y values have not been read yet (see wxDVLazyArrayDataSet).
+     *Views should not compute anything from such a data set until it is shown.*/
+    virtual bool IsLoaded() const { return true; }
+
+    /*Bulk access for hot loops: x or y values of samples [start, end).
+     *Returns a pointer into the dataset's own storage if it has a contiguous
+     *column, otherwise fills buf from At() and returns buf's data. The result
+     *is only valid until the dataset or buf changes. Callers walking a whole
+     *dataset should do so in blocks of SPAN_CHUNK_SIZE to bound buf's size.*/
+    enum {
+        SPAN_CHUNK_SIZE = 8192
+    };
+
+    virtual const double *GetXSpan(size_t start, size_t end, std::vector<double> &buf) const;
+
+    virtual const double *GetYSpan(size_t start, size_t end, std::vector<double> &buf) const;
+
     /*Helper Functions*/
     wxRealPoint operator[](size_t i) const;
 
@@ -105,14 +241,110 @@ public:
     virtual wxString GetGroupName() const { return m_groupName; }
 
     virtual void SetGroupName(const wxString &g) { m_groupName = g; }
+
+    /*Level of detail for drawing: sets buckets to summaries of samples [first << level, end << level)
+     *in buckets of 2^level samples.  Returns false if the data set keeps no wxDVLODPyramid at that
+     *level, or its samples are not at m_offset + i*m_timestep.*/
+    virtual bool GetLODBuckets(size_t level, size_t first, size_t end, std::vector<wxDVLODBucket> &buckets) const;
+
+protected:
+    /*Narrows *min and *max by samples [start, end) using an index, if the subclass keeps
+     *one; returns false to have GetMinAndMaxInRange scan them instead.*/
+    virtual bool QueryMinMaxIndex(size_t start, size_t end, double *min, double *max) const;
 };
 
-class wxDVArrayDataSet : public wxDVTimeSeriesDataSet {
+/*
+ * wxDVArrayDataSetBase holds what wxDVArrayDataSet and wxDVPointArrayDataSet
+ * share: the labels, the (nominal) timestep and offset, and the y values with
+ * their min/max index.  How the x values are kept is up to the subclass.
+ */
+class wxDVArrayDataSetBase : public wxDVTimeSeriesDataSet {
+public:
+    //A wxDVArrayDataSet if the points are evenly spaced, otherwise a wxDVPointArrayDataSet.
+    static wxDVArrayDataSetBase *Create(const wxString &var, const std::vector<wxRealPoint> &data);
+
+    virtual size_t Length() const;
+
+    virtual double GetTimeStep() const;
+
+    virtual double GetOffset() const;
+
+    virtual wxString GetSeriesTitle() const;
+
+    virtual wxString GetUnits() const;
+
+    virtual const double *GetYSpan(size_t start, size_t end, std::vector<double> &buf) const;
+
+    virtual void Copy(const std::vector<double> &data) = 0;
+
+    //Drops all samples and frees their storage.
+    virtual void Clear() = 0;
+
+    //Drops the samples from index len on.
+    virtual void Truncate(size_t len) = 0;
+
+    virtual void Alloc(size_t n) = 0;
+
+    virtual void Append(const wxRealPoint &p) = 0;
+
+    virtual void AppendY(double y) = 0;
+
+    virtual void AppendY(const double *y, size_t n) = 0;
+
+    virtual void Set(size_t i, double x, double y) = 0;
+
+    void SetY(size_t i, double y);
+
+    void SetSeriesTitle(const wxString &title);
+
+    void SetUnits(const wxString &units);
+
+    void SetTimeStep(double ts);
+
+    void SetOffset(double off);
+
+    //x values are no longer recomputed: these do nothing beyond setting the timestep or offset.
+    wxDEPRECATED(void SetTimeStep(double ts, bool recompute_x));
+
+    wxDEPRECATED(void SetOffset(double off, bool recompute_x));
+
+    wxDEPRECATED(void RecomputeXData());
+
+protected:
+    wxDVArrayDataSetBase();
+
+    wxDVArrayDataSetBase(const wxString &var, const wxString &units, double offset, double timestep,
+                         const std::vector<double> &data);
+
+    virtual bool QueryMinMaxIndex(size_t start, size_t end, double *min, double *max) const;
+
+    //Must be called by anything that changes m_yData, with the first index changed.
+    virtual void YDataChanged(size_t index = 0) const;
+
+    wxString m_varLabel;
+    wxString m_varUnits;
+    double m_timestep; // timestep in hours - fractional hours okay
+    double m_offset; // offset in hours from Jan1 00:00 - fractional hours okay
+    std::vector<double> m_yData;
+
+private:
+    mutable wxDVMinMaxIndex m_minMaxIndex;
+};
+
+/*
+ * wxDVArrayDataSet stores only the y values of a uniform time series.
+ * The x value of sample i is computed as m_offset + i*m_timestep, so
+ * the x component of any point passed to Append() or Set() is ignored,
+ * with a warning if it is off the grid.  Use wxDVPointArrayDataSet (or
+ * wxDVArrayDataSetBase::Create) when the x values are not evenly spaced.
+ */
+class wxDVArrayDataSet : public wxDVArrayDataSetBase {
 public:
     wxDVArrayDataSet();
 
     wxDVArrayDataSet(const wxString &var, const std::vector<double> &data);
 
+    // offset and timestep are taken from the x values of the first two points
     wxDVArrayDataSet(const wxString &var, const std::vector<wxRealPoint> &data);
 
     wxDVArrayDataSet(const wxString &var, const wxString &units, const double &timestep);
@@ -125,44 +357,196 @@ public:
 
     virtual wxRealPoint At(size_t i) const;
 
+    virtual const double *GetXSpan(size_t start, size_t end, std::vector<double> &buf) const;
+
+    virtual void Copy(const std::vector<double> &data);
+
+    virtual void Clear();
+
+    virtual void Truncate(size_t len);
+
+    virtual void Alloc(size_t n);
+
+    virtual void Append(const wxRealPoint &p);
+
+    virtual void AppendY(double y);
+
+    virtual void AppendY(const double *y, size_t n);
+
+    virtual void Set(size_t i, double x, double y);
+
+    virtual bool GetLODBuckets(size_t level, size_t first, size_t end, std::vector<wxDVLODBucket> &buckets) const;
+
+protected:
+    virtual void YDataChanged(size_t index = 0) const;
+
+private:
+    //Warns, once per data set, about an x value that is not where sample i lies.
+    void CheckX(size_t i, double x);
+
+    bool m_offGridReported;
+    mutable wxDVLODPyramid m_lodPyramid;
+};
+
+/*
+ * wxDVPointArrayDataSet keeps an explicit x column next to the y values,
+ * for derived or irregular series (e.g. monthly averages) whose samples
+ * don't fall on m_offset + i*m_timestep.  The timestep is nominal only:
+ * it places values appended without an x, and changing it moves nothing.
+ */
+class wxDVPointArrayDataSet : public wxDVArrayDataSetBase {
+public:
+    wxDVPointArrayDataSet();
+
+    wxDVPointArrayDataSet(const wxString &var, const std::vector<wxRealPoint> &data);
+
+    wxDVPointArrayDataSet(const wxString &var, const wxString &units, const double &timestep);
+
+    virtual wxRealPoint At(size_t i) const;
+
+    virtual const double *GetXSpan(size_t start, size_t end, std::vector<double> &buf) const;
+
+    //Replaces the y values; their x values are spaced by the timestep from the offset.
+    virtual void Copy(const std::vector<double> &data);
+
+    virtual void Clear();
+
+    virtual void Truncate(size_t len);
+
+    virtual void Alloc(size_t n);
+
+    virtual void Append(const wxRealPoint &p);
+
+    virtual void AppendY(double y);
+
+    virtual void AppendY(const double *y, size_t n);
+
+    virtual void Set(size_t i, double x, double y);
+
+private:
+    std::vector<double> m_xData;
+};
+
+/*
+ * wxDVColumnLoader reads the values of one column of a file on request,
+ * for data sets that were created without reading them.
+ */
+class wxDVColumnLoader {
+public:
+    virtual ~wxDVColumnLoader() {}
+
+    //Appends the values of the given column to y. Returns false if they could not be read.
+    virtual bool LoadColumn(size_t column, std::vector<double> &y) = 0;
+};
+
+/*
+ * wxDVLazyArrayDataSet is a wxDVArrayDataSet whose y values are read by a
+ * wxDVColumnLoader the first time they are accessed, so that opening a file
+ * with many columns only costs the columns that are looked at.  Length(),
+ * the x values and the labels are known without reading the column.
+ * Loading is thread safe; a column that can't be read reads as missing values.
+ */
+class wxDVLazyArrayDataSet : public wxDVArrayDataSet {
+public:
+    //Takes the labels, timestep, offset and any values already read from header.
+    //length is the length once loaded, including those values.
+    wxDVLazyArrayDataSet(const wxDVArrayDataSet &header, size_t length,
+                         const std::shared_ptr<wxDVColumnLoader> &loader, size_t column);
+
+    virtual bool IsLoaded() const;
+
+    virtual wxRealPoint At(size_t i) const;
+
     virtual size_t Length() const;
 
-    virtual double GetTimeStep() const;
+    virtual const double *GetYSpan(size_t start, size_t end, std::vector<double> &buf) const;
 
-    virtual double GetOffset() const;
+    virtual void Copy(const std::vector<double> &data);
 
-    virtual wxString GetSeriesTitle() const;
+    virtual void Clear();
 
-    virtual wxString GetUnits() const;
+    virtual void Truncate(size_t len);
 
-    void Copy(const std::vector<double> &data);
+    virtual void Alloc(size_t n);
 
-    void Clear();
+    virtual void Append(const wxRealPoint &p);
 
-    void Alloc(size_t n);
+    virtual void AppendY(double y);
 
-    void Append(const wxRealPoint &p);
+    virtual void AppendY(const double *y, size_t n);
 
-    void Set(size_t i, double x, double y);
+    virtual void Set(size_t i, double x, double y);
 
-    void SetY(size_t i, double y);
+    void Load() const;
 
-    void SetSeriesTitle(const wxString &title);
+    virtual bool GetLODBuckets(size_t level, size_t first, size_t end, std::vector<wxDVLODBucket> &buckets) const;
 
-    void SetUnits(const wxString &units);
+protected:
+    virtual bool QueryMinMaxIndex(size_t start, size_t end, double *min, double *max) const;
+
+private:
+    size_t m_length;
+    size_t m_column;
+    mutable std::shared_ptr<wxDVColumnLoader> m_loader;
+    mutable std::atomic<bool> m_loaded;
+    mutable std::mutex m_loadMutex;
+};
+
+/*
+ * wxDVResampledDataSet presents irregularly spaced samples (e.g. EnergyPlus
+ * HVAC system timestep output) as a uniform series by linear interpolation.
+ * Only the source samples are stored; grid values are computed for whatever
+ * range is requested, so memory grows with the samples and not the grid.
+ * Sample k lies on grid point gridIndex[k]; the grid starts at the first
+ * sample and ends just before the last one.  Modifying the data set
+ * materializes the grid into an ordinary array first.
+ */
+class wxDVResampledDataSet : public wxDVArrayDataSet {
+public:
+    //gridIndex must start at 0, be nondecreasing and have one entry per value.
+    wxDVResampledDataSet(const wxString &var, const wxString &units, double offset, double timestep,
+                         const std::vector<size_t> &gridIndex, const std::vector<double> &values);
 
-    void SetTimeStep(double ts, bool recompute_x = true);
+    virtual wxRealPoint At(size_t i) const;
+
+    virtual size_t Length() const;
+
+    virtual const double *GetYSpan(size_t start, size_t end, std::vector<double> &buf) const;
+
+    virtual void Copy(const std::vector<double> &data);
+
+    virtual void Clear();
+
+    virtual void Truncate(size_t len);
+
+    virtual void Alloc(size_t n);
+
+    virtual void Append(const wxRealPoint &p);
+
+    virtual void AppendY(double y);
+
+    virtual void AppendY(const double *y, size_t n);
+
+    virtual void Set(size_t i, double x, double y);
 
-    void SetOffset(double off, bool recompute_x = true);
+    //Replaces the source samples with the interpolated grid values.
+    void Materialize();
 
-    void RecomputeXData();
+    //False once materialized; the source samples are then gone.
+    bool IsResampled() const { return !m_gridIndex.empty(); }
+
+    const std::vector<size_t> &GetGridIndex() const { return m_gridIndex; }
+
+    const std::vector<double> &GetSourceValues() const { return m_values; }
 
 private:
-    wxString m_varLabel;
-    wxString m_varUnits;
-    double m_timestep; // timestep in hours - fractional hours okay
-    double m_offset; // offset in hours from Jan1 00:00 - fractional hours okay
-    std::vector<wxRealPoint> m_pData;
+    //Index of the sample that starts the segment containing grid point i.
+    size_t FindSegment(size_t i) const;
+
+    double Interpolate(size_t segment, size_t i) const;
+
+    std::vector<size_t> m_gridIndex;
+    std::vector<double> m_values;
 };
 
 enum StatisticsType {
@@ -185,7 +569,15 @@ class wxDVStatisticsDataSet {
 public:
     wxDVStatisticsDataSet(wxDVTimeSeriesDataSet *d);
 
-    double RoundSignificant(double ValueToRound, size_t NumSignifDigits = 4);
+    //Recomputes the statistics, taking in the points appended to the source dataset since the last update.
+    //The monthly and daily figures come from the source's wxDVCalendarAggregate.
+    void Update();
+
+    //Computes the monthly and total statistics without storing them, so it can run on a worker thread
+    //as long as the source dataset is loaded and left alone meanwhile.
+    void Compute(std::vector<StatisticsPoint> &points) const;
+
+    double RoundSignificant(double ValueToRound, size_t NumSignifDigits = 4) const;
 
     StatisticsPoint At(size_t i) const;
 
@@ -199,6 +591,8 @@ public:
 
     bool IsSourceDataset(wxDVTimeSeriesDataSet *d);
 
+    bool IsSourceLoaded() const { return baseDataset->IsLoaded(); }
+
     //We need the methods below because we can't return a reference to baseDataset itself because of its pure virtual methods
     double GetTimeStep() const;
 
@@ -219,6 +613,7 @@ public:
 private:
     std::vector<StatisticsPoint> m_sData;
     wxDVTimeSeriesDataSet *baseDataset;
+    std::shared_ptr<wxDVCalendarAggregate> m_aggregate; // shared with the other views of baseDataset
 };
 
 #endif
@@ -0,0 +1,81 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __DVWorkerPool_h
+#define __DVWorkerPool_h
+
+/*
+ * wxDVWorkerPool runs queued tasks on a few background threads.  The
+ * threads are started with the first task and stopped when the pool is
+ * destroyed, after the queued tasks have run.  Tasks must not touch the
+ * user interface; they hand their results back with wxEvtHandler::CallAfter
+ * or wxQueueEvent.
+ */
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class wxDVWorkerPool {
+public:
+    //nthreads 0 uses one thread per processor.
+    explicit wxDVWorkerPool(size_t nthreads = 0);
+
+    ~wxDVWorkerPool();
+
+    void Queue(const std::function<void()> &task);
+
+    //Blocks until every queued task has run.
+    void Wait();
+
+    //true if tasks are queued or running.
+    bool IsBusy() const;
+
+private:
+    void Run();
+
+    size_t m_maxThreads;
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()> > m_tasks;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake; // a task was queued or the pool is stopping
+    std::condition_variable m_idle; // the last task finished
+    size_t m_running;
+    bool m_stop;
+};
+
+#endif
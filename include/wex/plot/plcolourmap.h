@@ -80,6 +80,9 @@ public:
 
     virtual wxColour ColourForValue(double val);
 
+    // writes the colours of n values as packed RGB triplets, matching ColourForValue
+    void ColoursForValues(const double *values, size_t n, unsigned char *rgb);
+
     void SetReversed(bool r = true) { m_reversed = r; }
 
     bool IsReversed();
@@ -35,6 +35,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "wex/plot/plplot.h"
 
+//Supplies the values a wxPLHistogramPlot bins, so that they need not be copied into the plot.
+class wxPLHistogramData {
+public:
+    virtual ~wxPLHistogramData() {}
+
+    virtual size_t Length() const = 0;
+
+    //Values start to end - 1 (at most 8192 at a time): a pointer into the data if they are stored together,
+    //or else copied into buf.
+    virtual const double *GetValues(size_t start, size_t end, std::vector<double> &buf) const = 0;
+};
+
 class wxPLHistogramPlot : public wxPLPlottable {
 public:
     wxPLHistogramPlot();
@@ -42,14 +54,20 @@ public:
     wxPLHistogramPlot(const std::vector<wxRealPoint> &data,
                       const wxString &label);
 
+    virtual ~wxPLHistogramPlot();
+
     void Init();
 
     enum NormalizeType {
         NO_NORMALIZE = 0, NORMALIZE, NORMALIZE_PDF
     };
 
+    //Bins the y values of data.
     void SetData(const std::vector<wxRealPoint> &data);
 
+    //Takes ownership; the values are read again whenever the bins change.
+    void SetData(wxPLHistogramData *data);
+
     //Getters and Setters
     void SetLineStyle(const wxColour &c, double width);
 
@@ -108,15 +126,24 @@ private:
 
     size_t m_numberOfBins;
 
+    std::vector<double> m_binCounts;
+    double m_dataCount; // values in the bins
     std::vector<double> m_histData;
-    std::vector<wxRealPoint> m_histDataBinRanges;
+    mutable std::vector<wxRealPoint> m_histDataBinRanges; // found on first use
+    mutable bool m_binRangesValid;
+
+    void ReadDataRange();
 
     void RecalculateHistogram();
 
+    void NormalizeHistogram();
+
+    void CalculateBinRanges() const;
+
     double m_niceMax;
     double m_dataMin, m_dataMax;
 
-    std::vector<wxRealPoint> m_data;
+    wxPLHistogramData *m_data;
 };
 
 #endif
@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <wx/gdicmn.h>
 #include <wx/string.h>
 #include <wx/graphics.h>
+#include <wx/image.h>
 
 #include <wex/pdf/pdfdoc.h>
 #include <wex/pdf/pdfshape.h>
@@ -115,6 +116,9 @@ public:
 
     virtual void Measure(const wxString &text, double *width, double *height) = 0;
 
+    // stretches the image over the rectangle, each image pixel drawn as a solid block
+    virtual void Image(const wxImage &img, double x, double y, double width, double height) = 0;
+
     // API variants and helpers;
     virtual void NoPen() { Pen(*wxBLACK, 1.0, NONE); }
 
@@ -180,6 +184,8 @@ public:
 
     virtual void Measure(const wxString &text, double *width, double *height);
 
+    virtual void Image(const wxImage &img, double x, double y, double width, double height);
+
 private:
     int GetDrawingStyle();
 };
@@ -271,6 +277,8 @@ public:
     virtual void Text(const wxString &text, double x, double y, double angle = 0);
 
     virtual void Measure(const wxString &text, double *width, double *height);
+
+    virtual void Image(const wxImage &img, double x, double y, double width, double height);
 };
 
 #endif
@@ -33,6 +33,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __pl_scatterplot_h
 #define __pl_scatterplot_h
 
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
 #include "wex/plot/plplot.h"
 
 class wxPLColourMap;
@@ -72,7 +76,30 @@ public:
 
     void SetLineOfPerfectAgreementFlag(bool flagValue);
 
+    // with more points than this the plot shows how many points fall in each
+    // marker sized cell instead of drawing every marker. 0 never does.
+    void SetDensityThreshold(size_t npoints) { m_densityThreshold = npoints; }
+
+    size_t GetDensityThreshold() const { return m_densityThreshold; }
+
+    bool IsDensityShown() const { return m_densityThreshold > 0 && Len() > m_densityThreshold; }
+
 protected:
+    // adds the points within the world range to a width x height grid of
+    // cell x cell device units over the plot area, stored top row first
+    virtual void CountDensity(const wxPLDeviceMapping &map, double cell, int width, int height,
+                              std::vector<unsigned int> &counts);
+
+    void DrawDensity(wxPLOutputDevice &dc, const wxPLDeviceMapping &map);
+
+    // grid index of a device point inside the plot area at pos
+    static size_t DensityCellIndex(const wxRealPoint &device, const wxRealPoint &pos,
+                                   double cell, int width, int height) {
+        int col = std::min(std::max((int) floor((device.x - pos.x) / cell), 0), width - 1);
+        int row = std::min(std::max((int) floor((device.y - pos.y) / cell), 0), height - 1);
+        return (size_t) row * width + col;
+    }
+
     wxColour m_colour;
     double m_radius;
     bool m_scale;
@@ -81,6 +108,7 @@ protected:
     std::vector<wxRealPoint> m_data;
     std::vector<double> m_colours, m_sizes;
     wxPLColourMap *m_cmap;
+    size_t m_densityThreshold;
 };
 
 #endif
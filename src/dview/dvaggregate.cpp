@@ -0,0 +1,343 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+
+#include <algorithm>
+#include <map>
+
+#include "wex/dview/dvaggregate.h"
+#include "wex/dview/dvtimeseriesdataset.h"
+
+// ******** Period statistics *********** //
+
+double wxDVPeriodStats::Mean() const {
+    return count > 0.0 ? sum / count : wxDVTimeSeriesDataSet::MissingValue();
+}
+
+double wxDVPeriodStats::StDev() const {
+    return count > 0.0 ? sqrt(sqDev / count) : 0.0;
+}
+
+void wxDVPeriodStats::Add(double y) {
+    if (wxDVTimeSeriesDataSet::IsMissing(y))
+        return;
+
+    //Welford's update keeps the deviations accurate when the values are large compared to their spread.
+    double delta = (count > 0.0) ? y - sum / count : 0.0;
+    count += 1.0;
+    sum += y;
+    sqDev += delta * (y - sum / count);
+    if (count == 1.0) {
+        min = max = y;
+    } else {
+        min = (y < min) ? y : min;
+        max = (y > max) ? y : max;
+    }
+}
+
+void wxDVPeriodStats::Merge(const wxDVPeriodStats &p) {
+    if (p.count == 0.0)
+        return;
+
+    if (count == 0.0) {
+        count = p.count;
+        sum = p.sum;
+        min = p.min;
+        max = p.max;
+        sqDev = p.sqDev;
+        return;
+    }
+
+    double n = count + p.count;
+    double delta = p.sum / p.count - sum / count;
+    sqDev += p.sqDev + delta * delta * count * p.count / n;
+    count = n;
+    sum += p.sum;
+    min = (p.min < min) ? p.min : min;
+    max = (p.max > max) ? p.max : max;
+}
+
+// ******** Calendar aggregate *********** //
+
+const double wxDVCalendarAggregate::MONTH_START_HOURS[13] = {0.0, 744.0, 1416.0, 2160.0, 2880.0, 3624.0, 4344.0,
+                                                             5088.0, 5832.0, 6552.0, 7296.0, 8016.0, 8760.0};
+
+void wxDVCalendarAggregate::GetPeriod(double x, wxDVCalendarPeriod period, double *lower, double *upper) {
+    if (period == wxDV_PERIOD_HOUR) {
+        *lower = floor(x);
+        *upper = *lower + 1.0;
+    } else if (period == wxDV_PERIOD_DAY) {
+        *lower = floor(x / 24.0) * 24.0;
+        *upper = *lower + 24.0;
+    } else {
+        double year = floor(x / 8760.0) * 8760.0;
+        int m = GetMonthOfYear(x);
+        *lower = year + MONTH_START_HOURS[m];
+        *upper = year + MONTH_START_HOURS[m + 1];
+    }
+}
+
+int wxDVCalendarAggregate::GetMonthOfYear(double x) {
+    double hour = x - floor(x / 8760.0) * 8760.0;
+    int m = 0;
+    while (m < 11 && hour >= MONTH_START_HOURS[m + 1])
+        m++;
+    return m;
+}
+
+std::shared_ptr<wxDVCalendarAggregate> wxDVCalendarAggregate::Get(wxDVTimeSeriesDataSet *d) {
+    static std::mutex registryMutex;
+    static std::map<wxDVTimeSeriesDataSet *, std::weak_ptr<wxDVCalendarAggregate> > registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::shared_ptr<wxDVCalendarAggregate> a = registry[d].lock();
+    if (!a) {
+        //Forget the data sets whose views are all gone while we are at it.
+        for (auto it = registry.begin(); it != registry.end();) {
+            if (it->second.expired() && it->first != d)
+                it = registry.erase(it);
+            else
+                ++it;
+        }
+        a = std::make_shared<wxDVCalendarAggregate>(d);
+        registry[d] = a;
+    }
+    return a;
+}
+
+//An empty period of the given kind around hour x, starting at point first.
+static wxDVPeriodStats NewPeriod(double x, wxDVCalendarPeriod period, size_t first) {
+    wxDVPeriodStats p;
+    wxDVCalendarAggregate::GetPeriod(x, period, &p.lower, &p.upper);
+    p.first = first;
+    p.count = p.sum = p.sqDev = 0.0;
+    p.min = p.max = wxDVTimeSeriesDataSet::MissingValue();
+    return p;
+}
+
+wxDVCalendarAggregate::wxDVCalendarAggregate(wxDVTimeSeriesDataSet *d)
+        : m_data(d) {
+    Restart();
+}
+
+void wxDVCalendarAggregate::Restart() {
+    m_length = 0;
+    m_days.clear();
+    m_months.clear();
+    m_dayHours.clear();
+    m_hours = 0;
+    m_hourUpper = 0.0;
+    m_openMonthStart = 0;
+    m_slots = 0;
+    m_slotOffset = 0.0;
+    m_profileLower.clear();
+    m_profileSums.clear();
+    m_profileCounts.clear();
+}
+
+void wxDVCalendarAggregate::Invalidate(size_t from) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (from >= m_length)
+        return;
+
+    //Go back to the start of the month the first changed point is in, since a month's profile can only be rebuilt whole.
+    size_t m = m_months.size();
+    while (m > 0 && m_months[m - 1].first > from)
+        m--;
+    if (m <= 1) {
+        Restart();
+        return;
+    }
+
+    double lower = m_months[m - 1].lower;
+    m_length = m_months[m - 1].first;
+    m_months.resize(m - 1);
+    size_t d = m_days.size();
+    while (d > 0 && m_days[d - 1].lower >= lower)
+        d--;
+    m_hours = m_dayHours[d];
+    m_hourUpper = lower;
+    m_days.resize(d);
+    m_dayHours.resize(d);
+    while (!m_profileLower.empty() && m_profileLower.back() >= lower)
+        m_profileLower.pop_back();
+    m_profileSums.resize(m_profileLower.size() * m_slots);
+    m_profileCounts.resize(m_profileLower.size() * m_slots);
+
+    //The last month left is merged again on the next update.
+    while (d > 0 && m_days[d - 1].lower >= m_months.back().lower)
+        d--;
+    m_openMonthStart = d;
+}
+
+void wxDVCalendarAggregate::Update() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t len = m_data->Length();
+    if (len < m_length)
+        Restart();
+    if (len == m_length)
+        return;
+
+    double timestep = m_data->GetTimeStep();
+    if (m_length == 0) {
+        m_slots = (timestep > 0.0 && timestep <= 24.0) ? (size_t) (24.0 / timestep) : 0;
+        m_slotOffset = (m_slots > 0) ? fmod(m_data->At(0).x, timestep) : 0.0;
+    }
+
+    //Points go into the last day until one falls past it; that day is the only one revisited on appends.
+    std::vector<double> xbuf, ybuf;
+    for (size_t start = m_length; start < len; start += wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE) {
+        size_t end = (len - start > wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE)
+                     ? start + wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE : len;
+        const double *x = m_data->GetXSpan(start, end, xbuf);
+        const double *y = m_data->GetYSpan(start, end, ybuf);
+
+        for (size_t i = start; i < end; i++) {
+            bool newDay = m_days.empty() || x[i - start] >= m_days.back().upper;
+            if (newDay) {
+                m_dayHours.push_back(m_hours);
+                m_days.push_back(NewPeriod(x[i - start], wxDV_PERIOD_DAY, i));
+
+                //Months start on a day, so a new profile row can only begin with one.
+                double monthLower, monthUpper;
+                GetPeriod(m_days.back().lower, wxDV_PERIOD_MONTH, &monthLower, &monthUpper);
+                if (m_slots > 0 && (m_profileLower.empty() || m_profileLower.back() != monthLower)) {
+                    m_profileLower.push_back(monthLower);
+                    m_profileSums.resize(m_profileLower.size() * m_slots, 0.0);
+                    m_profileCounts.resize(m_profileLower.size() * m_slots, 0.0);
+                }
+            }
+            if (newDay || x[i - start] >= m_hourUpper) {
+                m_hours++;
+                m_hourUpper = floor(x[i - start]) + 1.0;
+            }
+            m_days.back().Add(y[i - start]);
+
+            if (m_slots > 0 && !wxDVTimeSeriesDataSet::IsMissing(y[i - start])) {
+                double tod = fmod(x[i - start] - m_slotOffset, 24.0);
+                if (tod < 0.0) tod += 24.0;
+                size_t slot = ((size_t) floor(tod / timestep + 0.5)) % m_slots;
+                size_t row = m_profileLower.size() - 1;
+                m_profileSums[row * m_slots + slot] += y[i - start];
+                m_profileCounts[row * m_slots + slot] += 1.0;
+            }
+        }
+    }
+    m_length = len;
+
+    //Merge the months from the first day of the last month on.
+    if (!m_months.empty())
+        m_months.pop_back();
+    for (size_t j = m_openMonthStart; j < m_days.size(); j++) {
+        if (m_months.empty() || m_days[j].lower >= m_months.back().upper) {
+            wxDVPeriodStats p = m_days[j];
+            GetPeriod(m_days[j].lower, wxDV_PERIOD_MONTH, &p.lower, &p.upper);
+            m_months.push_back(p);
+            m_openMonthStart = j;
+        } else {
+            m_months.back().Merge(m_days[j]);
+        }
+    }
+}
+
+size_t wxDVCalendarAggregate::GetLength() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_length;
+}
+
+size_t wxDVCalendarAggregate::GetPeriodCount(wxDVCalendarPeriod period) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (period == wxDV_PERIOD_HOUR)
+        return m_hours;
+    return (period == wxDV_PERIOD_DAY) ? m_days.size() : m_months.size();
+}
+
+void wxDVCalendarAggregate::GetPeriods(wxDVCalendarPeriod period, size_t start,
+                                       std::vector<wxDVPeriodStats> &periods) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (period != wxDV_PERIOD_HOUR) {
+        const std::vector<wxDVPeriodStats> &p = (period == wxDV_PERIOD_DAY) ? m_days : m_months;
+        periods.assign(p.begin() + std::min(start, p.size()), p.end());
+        return;
+    }
+
+    periods.clear();
+    if (start >= m_hours)
+        return;
+
+    //Read the hours again from the first point of the day hour start is in.
+    size_t d = (std::upper_bound(m_dayHours.begin(), m_dayHours.end(), start) - m_dayHours.begin()) - 1;
+    size_t hour = m_dayHours[d]; // number of the hours started so far
+    double hourUpper = m_days[d].lower;
+    size_t len = std::min(m_length, m_data->Length());
+    periods.reserve(m_hours - start);
+
+    std::vector<double> xbuf, ybuf;
+    for (size_t first = m_days[d].first; first < len; first += wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE) {
+        size_t end = (len - first > wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE)
+                     ? first + wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE : len;
+        const double *x = m_data->GetXSpan(first, end, xbuf);
+        const double *y = m_data->GetYSpan(first, end, ybuf);
+
+        for (size_t i = first; i < end; i++) {
+            if (x[i - first] >= hourUpper) {
+                if (hour >= start)
+                    periods.push_back(NewPeriod(x[i - first], wxDV_PERIOD_HOUR, i));
+                hour++;
+                hourUpper = floor(x[i - first]) + 1.0;
+            }
+            if (hour > start)
+                periods.back().Add(y[i - first]);
+        }
+    }
+}
+
+size_t wxDVCalendarAggregate::GetProfileSlots() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slots;
+}
+
+void wxDVCalendarAggregate::GetProfile(int month, std::vector<double> &sums, std::vector<double> &counts) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sums.assign(m_slots, 0.0);
+    counts.assign(m_slots, 0.0);
+    for (size_t r = 0; r < m_profileLower.size(); r++) {
+        if (GetMonthOfYear(m_profileLower[r]) != month)
+            continue;
+        for (size_t s = 0; s < m_slots; s++) {
+            sums[s] += m_profileSums[r * m_slots + s];
+            counts[s] += m_profileCounts[r * m_slots + s];
+        }
+    }
+}
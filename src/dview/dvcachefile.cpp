@@ -0,0 +1,442 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <wx/datetime.h>
+#include <wx/dir.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+#include "wex/dview/dvcachefile.h"
+#include "wex/dview/dvmappedfile.h"
+#include "wex/dview/dvtimeseriesdataset.h"
+
+/*
+ * Cache layout (native byte order, checked on read):
+ *   "DVCACHE1", uint32 byte order mark, uint32 version,
+ *   uint64 source size, int64 source modification time (ms),
+ *   string source path, string variant, uint32 number of columns,
+ *   per column: string title, string units, string group,
+ *               double offset, double timestep, uint64 length, uint64 data position,
+ *               uint64 grid position,
+ *   followed by the y columns as 8-byte aligned arrays of doubles.
+ * Strings are a uint32 byte count followed by utf-8 text.
+ *
+ * The grid position is 0 for an ordinary column.  For a resampled column the
+ * length counts its source samples, and the grid position is that of an array
+ * of length uint64 grid indexes following the samples.
+ */
+
+static const char CACHE_MAGIC[8] = {'D', 'V', 'C', 'A', 'C', 'H', 'E', '1'};
+static const wxUint32 CACHE_BYTE_ORDER = 0x01020304;
+static const wxUint32 CACHE_VERSION = 2;
+
+static wxUint64 s_minSourceSize = (wxUint64) 8 << 20;
+static wxUint64 s_maxTotalSize = (wxUint64) 2 << 30;
+
+// The resampled data set behind a column, if its source samples are still there.
+static const wxDVResampledDataSet *GetResampled(const wxDVArrayDataSet *ds) {
+    const wxDVResampledDataSet *rs = dynamic_cast<const wxDVResampledDataSet *>(ds);
+    return (rs && rs->IsResampled()) ? rs : 0;
+}
+
+// Number of values stored for a column.
+static size_t GetStoredLength(const wxDVArrayDataSet *ds) {
+    const wxDVResampledDataSet *rs = GetResampled(ds);
+    return rs ? rs->GetSourceValues().size() : ds->Length();
+}
+
+static bool GetSourceInfo(const wxString &sourceFile, wxString *path, wxUint64 *size, wxInt64 *modified) {
+    wxFileName fn(sourceFile);
+    fn.MakeAbsolute();
+    if (!fn.FileExists())
+        return false;
+
+    wxULongLong sz = fn.GetSize();
+    if (sz == wxInvalidSize)
+        return false;
+
+    wxDateTime mod = fn.GetModificationTime();
+    if (!mod.IsValid())
+        return false;
+
+    *path = fn.GetFullPath();
+    *size = sz.GetValue();
+    *modified = mod.GetValue().GetValue();
+    return true;
+}
+
+static void PutBytes(std::vector<char> &buf, const void *p, size_t n) {
+    buf.insert(buf.end(), (const char *) p, (const char *) p + n);
+}
+
+template<typename T>
+static void PutValue(std::vector<char> &buf, T value) {
+    PutBytes(buf, &value, sizeof(T));
+}
+
+static void PutString(std::vector<char> &buf, const wxString &str) {
+    wxScopedCharBuffer utf8 = str.utf8_str();
+    PutValue<wxUint32>(buf, (wxUint32) utf8.length());
+    PutBytes(buf, utf8.data(), utf8.length());
+}
+
+// Bounds checked reader over the mapped cache.
+class CacheCursor {
+    const char *m_pos, *m_end;
+    bool m_ok;
+public:
+    CacheCursor(const char *begin, const char *end) : m_pos(begin), m_end(end), m_ok(true) {}
+
+    bool IsOk() const { return m_ok; }
+
+    bool GetBytes(void *p, size_t n) {
+        if (!m_ok || (size_t) (m_end - m_pos) < n)
+            return m_ok = false;
+        memcpy(p, m_pos, n);
+        m_pos += n;
+        return true;
+    }
+
+    template<typename T>
+    T GetValue() {
+        T value = T();
+        GetBytes(&value, sizeof(T));
+        return value;
+    }
+
+    wxString GetString() {
+        wxUint32 len = GetValue<wxUint32>();
+        if (!m_ok || (size_t) (m_end - m_pos) < len) {
+            m_ok = false;
+            return wxEmptyString;
+        }
+        wxString str = wxString::FromUTF8(m_pos, len);
+        m_pos += len;
+        return str;
+    }
+};
+
+// Reads the fields that tie a cache to its source file; false if it is not a cache of this version.
+static bool ReadSourceFields(CacheCursor &cur, wxUint64 *size, wxInt64 *modified, wxString *path) {
+    char magic[sizeof(CACHE_MAGIC)];
+    if (!cur.GetBytes(magic, sizeof(magic)) || memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0)
+        return false;
+    if (cur.GetValue<wxUint32>() != CACHE_BYTE_ORDER || cur.GetValue<wxUint32>() != CACHE_VERSION)
+        return false;
+
+    *size = cur.GetValue<wxUint64>();
+    *modified = cur.GetValue<wxInt64>();
+    *path = cur.GetString();
+    return cur.IsOk();
+}
+
+// True if a cache file can't be used any more: it is unreadable, or its source is gone or has changed.
+static bool IsStale(const wxString &cachePath) {
+    wxDVMappedFile cache;
+    if (!cache.Open(cachePath))
+        return true;
+
+    CacheCursor cur(cache.GetData(), cache.GetData() + cache.GetSize());
+    wxUint64 cachedSize, size;
+    wxInt64 cachedModified, modified;
+    wxString cachedPath, path;
+    return !ReadSourceFields(cur, &cachedSize, &cachedModified, &cachedPath)
+           || !GetSourceInfo(cachedPath, &path, &size, &modified)
+           || size != cachedSize || modified != cachedModified;
+}
+
+// Deletes the stale caches, then the least recently used ones (by modification time, which Read
+// updates) while the cache directory holds more than the limit.  keep is left alone.
+static void TrimCacheDir(const wxString &keep) {
+    wxArrayString files;
+    if (!wxDirExists(wxDVCacheFile::GetCacheDir()))
+        return;
+    wxDir::GetAllFiles(wxDVCacheFile::GetCacheDir(), &files, "*.dvc", wxDIR_FILES);
+
+    std::vector<std::pair<wxInt64, size_t> > byAge;
+    std::vector<wxUint64> sizes(files.size(), 0);
+    wxUint64 total = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (files[i] != keep && IsStale(files[i])) {
+            wxRemoveFile(files[i]);
+            continue;
+        }
+
+        wxFileName fn(files[i]);
+        wxULongLong sz = fn.GetSize();
+        wxDateTime mod = fn.GetModificationTime();
+        if (sz == wxInvalidSize || !mod.IsValid())
+            continue;
+
+        sizes[i] = sz.GetValue();
+        total += sizes[i];
+        byAge.push_back(std::make_pair(mod.GetValue().GetValue(), i));
+    }
+
+    if (s_maxTotalSize == 0)
+        return;
+
+    std::sort(byAge.begin(), byAge.end());
+    for (size_t k = 0; k < byAge.size() && total > s_maxTotalSize; k++) {
+        size_t i = byAge[k].second;
+        if (files[i] != keep && wxRemoveFile(files[i]))
+            total -= sizes[i];
+    }
+}
+
+void wxDVCacheFile::SetMinSourceSize(wxUint64 bytes) {
+    s_minSourceSize = bytes;
+}
+
+wxUint64 wxDVCacheFile::GetMinSourceSize() {
+    return s_minSourceSize;
+}
+
+void wxDVCacheFile::SetMaxTotalSize(wxUint64 bytes) {
+    s_maxTotalSize = bytes;
+}
+
+wxUint64 wxDVCacheFile::GetMaxTotalSize() {
+    return s_maxTotalSize;
+}
+
+wxString wxDVCacheFile::GetCacheDir() {
+    return wxStandardPaths::Get().GetUserLocalDataDir() + wxFILE_SEP_PATH + "dvcache";
+}
+
+wxString wxDVCacheFile::GetCachePath(const wxString &sourceFile, const wxString &variant) {
+    wxFileName fn(sourceFile);
+    fn.MakeAbsolute();
+
+    // FNV-1a hash of the full path and variant keeps caches for same-named files apart
+    wxScopedCharBuffer key = (fn.GetFullPath() + "|" + variant).utf8_str();
+    wxUint64 hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < key.length(); i++) {
+        hash ^= (unsigned char) key.data()[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return GetCacheDir() + wxFILE_SEP_PATH + fn.GetName()
+           + wxString::Format("-%08x%08x.dvc", (unsigned) (hash >> 32), (unsigned) (hash & 0xffffffff));
+}
+
+bool wxDVCacheFile::Write(const wxString &sourceFile, const std::vector<wxDVArrayDataSet *> &dataSets,
+                          const wxString &variant) {
+    wxString path;
+    wxUint64 size;
+    wxInt64 modified;
+    if (dataSets.size() == 0 || !GetSourceInfo(sourceFile, &path, &size, &modified))
+        return false;
+    if (size < s_minSourceSize)
+        return false; // parsing it is quick enough
+
+    wxString dir = GetCacheDir();
+    if (!wxDirExists(dir) && !wxFileName::Mkdir(dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL))
+        return false;
+
+    std::vector<char> header;
+    PutBytes(header, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    PutValue<wxUint32>(header, CACHE_BYTE_ORDER);
+    PutValue<wxUint32>(header, CACHE_VERSION);
+    PutValue<wxUint64>(header, size);
+    PutValue<wxInt64>(header, modified);
+    PutString(header, path);
+    PutString(header, variant);
+    PutValue<wxUint32>(header, (wxUint32) dataSets.size());
+
+    std::vector<size_t> positionFields;
+    for (size_t i = 0; i < dataSets.size(); i++) {
+        PutString(header, dataSets[i]->GetSeriesTitle());
+        PutString(header, dataSets[i]->GetUnits());
+        PutString(header, dataSets[i]->GetGroupName());
+        PutValue<double>(header, dataSets[i]->GetOffset());
+        PutValue<double>(header, dataSets[i]->GetTimeStep());
+        PutValue<wxUint64>(header, (wxUint64) GetStoredLength(dataSets[i]));
+        positionFields.push_back(header.size());
+        PutValue<wxUint64>(header, 0);
+        PutValue<wxUint64>(header, 0);
+    }
+
+    while (header.size() % sizeof(double) != 0)
+        header.push_back(0);
+
+    wxUint64 position = header.size();
+    for (size_t i = 0; i < dataSets.size(); i++) {
+        memcpy(&header[positionFields[i]], &position, sizeof(position));
+        position += (wxUint64) GetStoredLength(dataSets[i]) * sizeof(double);
+        if (GetResampled(dataSets[i])) {
+            memcpy(&header[positionFields[i] + sizeof(wxUint64)], &position, sizeof(position));
+            position += (wxUint64) GetStoredLength(dataSets[i]) * sizeof(wxUint64);
+        }
+    }
+
+    // a cache that could never fit would only push out all the others
+    if (s_maxTotalSize > 0 && position > s_maxTotalSize)
+        return false;
+
+    // write to a temporary file first so an interrupted write never leaves a truncated cache behind
+    wxString cachePath = GetCachePath(sourceFile, variant);
+    wxString tempPath = cachePath + ".tmp";
+    FILE *fp = fopen(tempPath.c_str(), "wb");
+    if (!fp)
+        return false;
+
+    bool ok = fwrite(&header[0], 1, header.size(), fp) == header.size();
+
+    std::vector<double> buf;
+    for (size_t i = 0; ok && i < dataSets.size(); i++) {
+        if (const wxDVResampledDataSet *rs = GetResampled(dataSets[i])) {
+            const std::vector<double> &values = rs->GetSourceValues();
+            std::vector<wxUint64> grid(rs->GetGridIndex().begin(), rs->GetGridIndex().end());
+            ok = fwrite(&values[0], sizeof(double), values.size(), fp) == values.size()
+                 && fwrite(&grid[0], sizeof(wxUint64), grid.size(), fp) == grid.size();
+            continue;
+        }
+
+        size_t len = dataSets[i]->Length();
+        for (size_t start = 0; ok && start < len; start += wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE) {
+            size_t end = (len - start > wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE)
+                         ? start + wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE : len;
+            const double *y = dataSets[i]->GetYSpan(start, end, buf);
+            ok = fwrite(y, sizeof(double), end - start, fp) == end - start;
+        }
+    }
+
+    if (fclose(fp) != 0)
+        ok = false;
+
+    if (!ok || !wxRenameFile(tempPath, cachePath, true)) {
+        wxRemoveFile(tempPath);
+        return false;
+    }
+
+    TrimCacheDir(cachePath);
+    return true;
+}
+
+bool wxDVCacheFile::Read(const wxString &sourceFile, std::vector<wxDVArrayDataSet *> &dataSets,
+                         const wxString &variant) {
+    wxString path;
+    wxUint64 size;
+    wxInt64 modified;
+    if (!GetSourceInfo(sourceFile, &path, &size, &modified))
+        return false;
+
+    wxString cachePath = GetCachePath(sourceFile, variant);
+    if (!wxFileExists(cachePath))
+        return false;
+
+    wxDVMappedFile cache;
+    if (!cache.Open(cachePath))
+        return false;
+
+    CacheCursor cur(cache.GetData(), cache.GetData() + cache.GetSize());
+
+    // an outdated cache would never be used again; a different path or variant is another file's cache
+    wxUint64 cachedSize;
+    wxInt64 cachedModified;
+    wxString cachedPath;
+    if (!ReadSourceFields(cur, &cachedSize, &cachedModified, &cachedPath)
+        || cachedSize != size || cachedModified != modified) {
+        cache.Close();
+        Remove(sourceFile, variant);
+        return false;
+    }
+    if (cachedPath != path || cur.GetString() != variant || !cur.IsOk())
+        return false;
+
+    wxUint32 ncols = cur.GetValue<wxUint32>();
+    std::vector<wxDVArrayDataSet *> result;
+    for (wxUint32 i = 0; i < ncols && cur.IsOk(); i++) {
+        wxString title = cur.GetString();
+        wxString units = cur.GetString();
+        wxString group = cur.GetString();
+        double offset = cur.GetValue<double>();
+        double timestep = cur.GetValue<double>();
+        wxUint64 len = cur.GetValue<wxUint64>();
+        wxUint64 position = cur.GetValue<wxUint64>();
+        wxUint64 gridPosition = cur.GetValue<wxUint64>();
+
+        if (!cur.IsOk()
+            || position % sizeof(double) != 0
+            || position > cache.GetSize()
+            || len > (cache.GetSize() - position) / sizeof(double))
+            break;
+
+        const double *values = (const double *) (cache.GetData() + position);
+        wxDVArrayDataSet *ds;
+        if (gridPosition != 0) {
+            if (gridPosition % sizeof(wxUint64) != 0
+                || gridPosition > cache.GetSize()
+                || len > (cache.GetSize() - gridPosition) / sizeof(wxUint64))
+                break;
+
+            // the grid must start at 0 and never go back, as wxDVResampledDataSet expects
+            const wxUint64 *grid = (const wxUint64 *) (cache.GetData() + gridPosition);
+            std::vector<size_t> gridIndex(grid, grid + len);
+            if (len < 2 || gridIndex[0] != 0 || !std::is_sorted(gridIndex.begin(), gridIndex.end()))
+                break;
+
+            ds = new wxDVResampledDataSet(title, units, offset, timestep, gridIndex,
+                                          std::vector<double>(values, values + len));
+        } else {
+            ds = new wxDVArrayDataSet(title, units, offset, timestep, std::vector<double>());
+            if (len > 0)
+                ds->AppendY(values, (size_t) len);
+        }
+        ds->SetGroupName(group);
+        result.push_back(ds);
+    }
+
+    cache.Close();
+    if (result.size() != ncols) {
+        for (size_t i = 0; i < result.size(); i++)
+            delete result[i];
+        Remove(sourceFile, variant); // damaged
+        return false;
+    }
+
+    wxFileName(cachePath).Touch(); // recently used, as far as TrimCacheDir is concerned
+    dataSets.insert(dataSets.end(), result.begin(), result.end());
+    return true;
+}
+
+bool wxDVCacheFile::Remove(const wxString &sourceFile, const wxString &variant) {
+    wxString cachePath = GetCachePath(sourceFile, variant);
+    return wxFileExists(cachePath) && wxRemoveFile(cachePath);
+}
@@ -45,6 +45,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "wex/plot/pllineplot.h"
 #include "wex/dview/dvdcctrl.h"
 #include "wex/dview/dvselectionlist.h"
+#include "wex/dview/dvsortedvalues.h"
 #include "wex/dview/dvtimeseriesdataset.h"
 
 static const wxString NO_UNITS("ThereAreNoUnitsForThisAxis.");
@@ -139,7 +140,7 @@ END_EVENT_TABLE()
 // *** DATA SET FUNCTIONS ***
 void wxDVDCCtrl::AddDataSet(wxDVTimeSeriesDataSet *d, bool update_ui) {
     m_dataSelector->Append(d->GetTitleWithUnits(), d->GetGroupName());
-    m_plots.push_back(new PlotSet(d));
+    m_plots.push_back(new PlotSet(d, m_plotSurface));
 
     if (update_ui)
         Layout();
@@ -167,6 +168,22 @@ void wxDVDCCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
     Refresh();
 }
 
+void wxDVDCCtrl::UpdateDataSet(wxDVTimeSeriesDataSet *d) {
+    for (size_t i = 0; i < m_plots.size(); i++) {
+        if (m_plots[i]->dataset != d)
+            continue;
+
+        //A hidden curve is recalculated when it is shown again.
+        if (m_plots[i]->plot && m_plotSurface->ContainsPlot(m_plots[i]->plot)) {
+            CalculateDCPlotData(m_plots[i]);
+            wxDVMemoryBudget::Get().Touch(m_plots[i]);
+            m_plotSurface->Invalidate();
+            m_plotSurface->Refresh();
+        }
+        break;
+    }
+}
+
 void wxDVDCCtrl::RemoveAllDataSets() {
     m_dataSelector->RemoveAll();
 
@@ -187,29 +204,31 @@ void wxDVDCCtrl::RemoveAllDataSets() {
 void wxDVDCCtrl::CalculateDCPlotData(PlotSet *p) {
     //This method assumes uniform time step for simplicity.
     wxDVTimeSeriesDataSet *d = p->dataset;
-    if (p->plot != 0)
+    if (p->plot != 0 && p->version == d->GetVersion())
         return;
 
     wxBeginBusyCursor();
     wxBusyInfo("Please wait, calculating duration curve for " + d->GetSeriesTitle() + "...");
 
-    std::vector<double> sortedData;
-
-    int len = d->Length();
-    sortedData.resize(len, 0.0);
-    for (int i = 0; i < len; i++)
-        sortedData[i] = d->At(i).y;
-
-    std::sort(sortedData.begin(), sortedData.end());
+    // missing values are not part of the duration; the cdf of d may have sorted them already
+    std::shared_ptr<const wxDVSortedValues> sorted = wxDVSortedValues::Get(d, false);
+    p->version = sorted->GetDataVersion();
+    const std::vector<double> &sortedData = sorted->GetValues();
+    size_t len = sortedData.size();
 
     std::vector<wxRealPoint> pd;
     pd.reserve(len);
-    for (int i = 0; i < len; i++)
+    for (size_t i = 0; i < len; i++)
         pd.push_back(wxRealPoint(i * d->GetTimeStep(), sortedData[len - i - 1]));
 
-    p->plot = new wxPLLinePlot(pd, d->GetSeriesTitle() + " (" + d->GetUnits() + ")");
-    p->plot->SetXDataLabel(_("Hours equaled or exceeded"));
-    p->plot->SetYDataLabel(p->plot->GetLabel());
+    //A curve that is shown is updated in place.
+    if (p->plot != 0) {
+        p->plot->SetData(pd);
+    } else {
+        p->plot = new wxPLLinePlot(pd, d->GetSeriesTitle() + " (" + d->GetUnits() + ")");
+        p->plot->SetXDataLabel(_("Hours equaled or exceeded"));
+        p->plot->SetYDataLabel(p->plot->GetLabel());
+    }
 
     wxEndBusyCursor();
 }
@@ -244,6 +263,7 @@ void wxDVDCCtrl::ShowPlotAtIndex(int index) {
 
         m_plotSurface->AddPlot(m_plots[index]->plot, wxPLPlotCtrl::X_BOTTOM, yap);
         m_plotSurface->GetAxis(yap)->SetUnits(units);
+        wxDVMemoryBudget::Get().Touch(m_plots[index]);
 
         YLabelText = units;
         for (int i = 0; i < m_dataSelector->Length(); i++) {
@@ -433,12 +453,27 @@ void wxDVDCCtrl::OnSearch(wxCommandEvent &) {
     m_dataSelector->Filter(m_srchCtrl->GetValue().Lower());
 }
 
-wxDVDCCtrl::PlotSet::PlotSet(wxDVTimeSeriesDataSet *ds) {
+wxDVDCCtrl::PlotSet::PlotSet(wxDVTimeSeriesDataSet *ds, wxPLPlotCtrl *plotSurface) {
     dataset = ds;
+    surface = plotSurface;
     plot = 0;
+    version = 0;
 }
 
 wxDVDCCtrl::PlotSet::~PlotSet() {
     if (plot != 0)
         delete plot;
 }
+
+size_t wxDVDCCtrl::PlotSet::GetMemorySize() const {
+    return plot ? plot->Len() * sizeof(wxRealPoint) : 0;
+}
+
+bool wxDVDCCtrl::PlotSet::Evict() {
+    if (plot == 0 || surface->ContainsPlot(plot))
+        return false;
+
+    delete plot;
+    plot = 0;
+    return true;
+}
@@ -31,6 +31,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <sstream>
 #include <string>
 
@@ -60,17 +62,57 @@ class wxDVDMapPlot : public wxPLPlottable {
 private:
     wxDVTimeSeriesDataSet *m_data;
     wxPLColourMap *m_colourMap;
+    int m_aggregateMode;
+
+    //Day x slot grid of the data, one cell per time step, days stored contiguously.
+    //Cells outside [m_gridFirstCell, m_gridLastCell] hold no sample.
+    wxDVTimeSeriesDataSet *m_gridData;
+    size_t m_gridLength;
+    size_t m_gridValid; // leading samples whose cells are still up to date
+    double m_gridTimeStep;
+    int m_gridFirstDay;
+    int m_gridDays;
+    int m_gridSlots;
+    size_t m_gridFirstCell, m_gridLastCell;
+    double m_gridMin, m_gridMax;
+    std::vector<double> m_grid;
+
 public:
     wxDVDMapPlot() : wxPLPlottable() {
         m_antiAliasing = false; // turn off AA for this plottable
         m_data = 0;
         m_colourMap = 0;
+        m_aggregateMode = wxDVDMapCtrl::AGGREGATE_MEAN;
+
+        m_gridData = 0;
+        m_gridLength = m_gridValid = 0;
+        m_gridTimeStep = 0;
+        m_gridFirstDay = m_gridDays = m_gridSlots = 0;
+        m_gridFirstCell = m_gridLastCell = 0;
+        m_gridMin = m_gridMax = 0;
     }
 
     void SetData(wxDVTimeSeriesDataSet *d) { m_data = d; }
 
     void SetColourMap(wxPLColourMap *c) { m_colourMap = c; }
 
+    void SetAggregateMode(int mode) { m_aggregateMode = mode; }
+
+    int GetAggregateMode() const { return m_aggregateMode; }
+
+    //The samples from index from on were changed or replaced, not just appended to.
+    void Invalidate(size_t from) { m_gridValid = std::min(m_gridValid, from); }
+
+    //Range of the sampled values, without rescanning the data set.
+    bool GetValueRange(double *min, double *max) {
+        UpdateGrid();
+        if (m_grid.empty()) return false;
+
+        *min = m_gridMin;
+        *max = m_gridMax;
+        return true;
+    }
+
     virtual wxString GetXDataLabel(wxPLPlot *) const {
         return _("Hours since 00:00 Jan 1");
     }
@@ -102,51 +144,223 @@ public:
         dc.Brush(*wxRED, wxPLOutputDevice::HATCH);
         dc.Brush(m_colourMap->ColourForValue(m_data->At(0).y));
         dc.Rect(pos.x, pos.y, size.x + 1, size.y + 1);
-        
+
+        UpdateGrid();
+        if (m_grid.empty()) return;
+
         wxRealPoint wmin = map.GetWorldMinimum();
         wxRealPoint wmax = map.GetWorldMaximum();
         double xlen = wmax.x - wmin.x;
         double ylen = wmax.y - wmin.y;
+        double timestep = m_gridTimeStep;
+        if (xlen <= 0 || ylen <= 0) return;
+
+        //Each cell covers a day horizontally and a time step vertically.
+        int firstDay = (int) floor(wmin.x / 24);
+        int lastDay = (int) ceil(wmax.x / 24) - 1;
+        int firstSlot = std::max(0, (int) ceil(wmin.y / timestep - 1e-9));
+        int lastSlot = std::min(m_gridSlots - 1, (int) ceil(wmax.y / timestep - 1e-9) - 1);
+        if (lastDay < firstDay || lastSlot < firstSlot) return;
+
+        int ncols = lastDay - firstDay + 1;
+        int nrows = lastSlot - firstSlot + 1;
+
+        //One image pixel per cell, unless there are more cells than device pixels.
+        //Then the cells sharing a pixel are combined so no sample is dropped.
+        int width = std::min(ncols, std::max(1, (int) ceil(size.x)));
+        int height = std::min(nrows, std::max(1, (int) ceil(size.y)));
+
+        std::vector<double> values((size_t) width * height);
+        std::vector<bool> empty((size_t) width * height);
+        Aggregate(firstDay, ncols, firstSlot, nrows, width, height, &values[0], empty);
+
+        wxImage img(width, height, false);
+        unsigned char *pixels = img.GetData();
+        m_colourMap->ColoursForValues(&values[0], values.size(), pixels);
+
+        unsigned char bg[3];
+        double first = m_data->At(0).y;
+        m_colourMap->ColoursForValues(&first, 1, bg);
+        for (size_t i = 0; i < empty.size(); i++)
+            if (empty[i]) memcpy(pixels + 3 * i, bg, 3);
+
+        double cellWidth = size.x / (xlen / 24);
+        double cellHeight = size.y / ylen * timestep;
+        double x = pos.x + (firstDay - wmin.x / 24) * cellWidth;
+        double y = pos.y + size.y - cellHeight * ((lastSlot * timestep - wmin.y) / timestep + 1);
+        dc.Image(img, x, y, ncols * cellWidth, nrows * cellHeight);
+    }
 
-        //Right now we iterate through points in data set.
-        //Alternatively we could iterate through days and hours with nested loops.
-        //That would give us the ability to average data points into boxes if we wanted.
-        //But would lower the resolution (for high res data sets).
+    virtual void DrawInLegend(wxPLOutputDevice &, const wxPLRealRect &) {
+        // nothing to do: won't be showing legends
+    }
 
-        double dRectWidth = size.x / (xlen / 24); //Rect width does not depend on data.
-        double dRectHeight = size.y / ylen * m_data->GetTimeStep();
+private:
+    //Grid cell of hour x, or -1 if it falls before the first day.
+    long CellIndex(double x) const {
+        int day = int(x) / 24 - m_gridFirstDay; //x-res does not change with higher res data.
+        if (day < 0) return -1;
+
+        double hour = fmod(x, 24.0);
+        hour -= fmod(hour, m_gridTimeStep); // This makes sure the entire plot doesn't shift up for something like 1/2 hour data.
+        int slot = std::min(m_gridSlots - 1, (int) floor(hour / m_gridTimeStep + 0.5));
+        return (long) day * m_gridSlots + slot;
+    }
 
-        for (size_t i = 0; i < m_data->Length(); i++) {
-            if (m_data->At(i).x < wmin.x)
-                continue;
-            if (m_data->At(i).x >=
-                wmax.x)  //We include the = case because we draw the box to the right of the data point.
-                break;
+    //Brings the grid up to date with the data set. Appended or replaced
+    //points at the end are redone in place, anything else rebuilds it.
+    void UpdateGrid() {
+        size_t len = m_data ? m_data->Length() : 0;
+        double timestep = m_data ? m_data->GetTimeStep() : 0;
+        size_t valid = std::min(std::min(m_gridValid, m_gridLength), len);
+        if (m_gridData == m_data && m_gridTimeStep == timestep && valid == m_gridLength && len == m_gridLength)
+            return;
+
+        if (m_gridData != m_data || m_gridTimeStep != timestep || m_grid.empty())
+            valid = 0;
+
+        //Redo the last good sample too: a replaced one may have shared its cell.
+        size_t start = valid;
+        if (valid > 0 && valid < m_gridLength) {
+            start = valid - 1;
+            long keep = CellIndex(m_data->At(start).x);
+            if (keep < 0)
+                start = 0;
+            else
+                ClearCellsFrom((size_t) keep);
+        }
+        if (start == 0)
+            m_grid.clear();
+
+        m_gridData = m_data;
+        m_gridLength = m_gridValid = len;
+        m_gridTimeStep = timestep;
+        if (len == 0 || timestep <= 0) {
+            m_grid.clear();
+            return;
+        }
 
-            int worldXDay = int(m_data->At(i).x) / 24; //x-res does not change with higher res data.
+        if (start == 0) {
+            m_gridSlots = std::max(1, (int) ceil(24 / timestep - 1e-9));
+            m_gridFirstDay = int(m_data->At(0).x) / 24;
+            m_gridDays = 0;
+            m_gridFirstCell = std::numeric_limits<size_t>::max();
+            m_gridLastCell = 0;
+            m_gridMin = std::numeric_limits<double>::infinity();
+            m_gridMax = -std::numeric_limits<double>::infinity();
+        }
 
-            double worldY = fmod(m_data->At(i).x, 24.0);
-            worldY -= fmod(worldY, m_data->GetTimeStep()); // This makes sure the entire plot doesn't shift up for something like 1/2 hour data.
-            if (worldY < wmin.y)
-                continue;
-            if (worldY >= wmax.y)
-                continue;
-            worldY -= wmin.y;
+        std::vector<double> xbuf, ybuf;
+        for (size_t begin = start; begin < len; begin += wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE) {
+            size_t end = (len - begin > wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE)
+                         ? begin + wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE : len;
+            const double *xs = m_data->GetXSpan(begin, end, xbuf);
+            const double *ys = m_data->GetYSpan(begin, end, ybuf);
+
+            for (size_t i = 0; i < end - begin; i++) {
+                long index = CellIndex(xs[i]);
+                if (index < 0) continue;
+
+                size_t cell = (size_t) index;
+                int day = (int) (cell / m_gridSlots);
+                if (day >= m_gridDays) {
+                    m_gridDays = day + 1;
+                    m_grid.resize((size_t) m_gridDays * m_gridSlots, std::numeric_limits<double>::quiet_NaN());
+                }
+
+                m_grid[cell] = ys[i];
+                m_gridFirstCell = std::min(m_gridFirstCell, cell);
+                m_gridLastCell = std::max(m_gridLastCell, cell);
+
+                //Comparisons with a missing value are false, so these skip them.
+                if (ys[i] < m_gridMin) m_gridMin = ys[i];
+                if (ys[i] > m_gridMax) m_gridMax = ys[i];
+            }
+        }
 
-            double x = pos.x + (worldXDay - wmin.x / 24) * dRectWidth;
-            double y = pos.y + size.y - dRectHeight * (worldY / m_data->GetTimeStep() + 1); //+1 is because we have top corner, not bottom.
+        if (m_gridMin > m_gridMax) //nothing but missing values
+            m_gridMin = m_gridMax = 0.0;
+    }
 
-            dc.Brush(m_colourMap->ColourForValue(m_data->At(i).y));
+    //Drops the cells from cell on, to be filled again from the data set. The value range is
+    //rescanned from the cells left if a dropped one held its minimum or maximum.
+    void ClearCellsFrom(size_t cell) {
+        bool extreme = false;
+        for (size_t c = cell; c < m_grid.size(); c++) {
+            if (m_grid[c] == m_gridMin || m_grid[c] == m_gridMax)
+                extreme = true;
+        }
 
-            // increase rect dimensions by about 0.5 point to
-            // make sure they render overlapped without white space
-            // showing in between
-            dc.Rect(x, y, ceil(dRectWidth + 1.0 / m_data->GetTimeStep()), ceil(dRectHeight + 1.0 / m_data->GetTimeStep())); // +- 1/timesteps to cover empty spaces between rects.
+        m_gridDays = (int) (cell / m_gridSlots) + 1;
+        m_grid.resize((size_t) m_gridDays * m_gridSlots);
+        std::fill(m_grid.begin() + cell, m_grid.end(), std::numeric_limits<double>::quiet_NaN());
+        m_gridLastCell = (cell > m_gridFirstCell) ? cell - 1 : m_gridFirstCell;
+
+        if (extreme) {
+            m_gridMin = std::numeric_limits<double>::infinity();
+            m_gridMax = -std::numeric_limits<double>::infinity();
+            for (size_t c = m_gridFirstCell; c < cell; c++) {
+                if (m_grid[c] < m_gridMin) m_gridMin = m_grid[c];
+                if (m_grid[c] > m_gridMax) m_gridMax = m_grid[c];
+            }
         }
     }
 
-    virtual void DrawInLegend(wxPLOutputDevice &, const wxPLRealRect &) {
-        // nothing to do: won't be showing legends
+    //Combines the ncols x nrows cells starting at (firstDay, firstSlot) into
+    //width x height buckets, written top row first. Buckets with no samples are
+    //flagged empty; buckets with only missing samples are NaN.
+    void Aggregate(int firstDay, int ncols, int firstSlot, int nrows, int width, int height,
+                   double *values, std::vector<bool> &empty) {
+        std::vector<int> rowStart(height + 1);
+        for (int r = 0; r <= height; r++)
+            rowStart[r] = firstSlot + (int) ((long long) r * nrows / height);
+
+        std::vector<double> sum(height), lo(height), hi(height);
+        std::vector<size_t> count(height), cells(height);
+
+        for (int c = 0; c < width; c++) {
+            std::fill(sum.begin(), sum.end(), 0.0);
+            std::fill(lo.begin(), lo.end(), std::numeric_limits<double>::infinity());
+            std::fill(hi.begin(), hi.end(), -std::numeric_limits<double>::infinity());
+            std::fill(count.begin(), count.end(), 0);
+            std::fill(cells.begin(), cells.end(), 0);
+
+            int dayEnd = firstDay + (int) ((long long) (c + 1) * ncols / width);
+            for (int day = firstDay + (int) ((long long) c * ncols / width); day < dayEnd; day++) {
+                int gday = day - m_gridFirstDay;
+                if (gday < 0 || gday >= m_gridDays) continue;
+
+                size_t base = (size_t) gday * m_gridSlots;
+                for (int r = 0; r < height; r++) {
+                    for (int s = rowStart[r]; s < rowStart[r + 1]; s++) {
+                        size_t cell = base + s;
+                        if (cell < m_gridFirstCell || cell > m_gridLastCell) continue;
+
+                        cells[r]++;
+                        double v = m_grid[cell];
+                        if (wxDVTimeSeriesDataSet::IsMissing(v)) continue;
+
+                        sum[r] += v;
+                        count[r]++;
+                        lo[r] = std::min(lo[r], v);
+                        hi[r] = std::max(hi[r], v);
+                    }
+                }
+            }
+
+            for (int r = 0; r < height; r++) {
+                size_t index = (size_t) (height - 1 - r) * width + c; // time of day runs bottom up
+                empty[index] = (cells[r] == 0);
+                if (count[r] == 0)
+                    values[index] = std::numeric_limits<double>::quiet_NaN();
+                else if (m_aggregateMode == wxDVDMapCtrl::AGGREGATE_MIN)
+                    values[index] = lo[r];
+                else if (m_aggregateMode == wxDVDMapCtrl::AGGREGATE_MAX)
+                    values[index] = hi[r];
+                else
+                    values[index] = sum[r] / count[r];
+            }
+        }
     }
 };
 
@@ -154,6 +368,7 @@ enum {
     ID_DATA_SELECTOR = wxID_HIGHEST + 1,
     ID_COLOURMAP_SELECTOR_CHOICE, ID_GRAPH_SCROLLBAR, ID_GRAPH_Y_SCROLLBAR,
     ID_MIN_Z_INPUT, ID_MAX_Z_INPUT, ID_DMAP_SURFACE, ID_RESET_MIN_MAX, ID_REVERSE_COLOURS,
+    ID_AGGREGATE_CHOICE,
     ID_Timer
 };
 
@@ -164,6 +379,7 @@ BEGIN_EVENT_TABLE(wxDVDMapCtrl, wxPanel)
                 EVT_DVSELECTIONLIST(ID_DATA_SELECTOR, wxDVDMapCtrl::OnDataChannelSelection)
                 EVT_CHOICE(ID_COLOURMAP_SELECTOR_CHOICE, wxDVDMapCtrl::OnColourMapSelection)
                 EVT_CHECKBOX(ID_REVERSE_COLOURS, wxDVDMapCtrl::OnReverseColours)
+                EVT_CHOICE(ID_AGGREGATE_CHOICE, wxDVDMapCtrl::OnAggregateSelection)
 
                 EVT_TEXT_ENTER(ID_MIN_Z_INPUT, wxDVDMapCtrl::OnColourMapMinChanged)
                 EVT_TEXT_ENTER(ID_MAX_Z_INPUT, wxDVDMapCtrl::OnColourMapMaxChanged)
@@ -244,6 +460,11 @@ wxDVDMapCtrl::wxDVDMapCtrl(wxWindow *parent,
 
     m_reverseColours = new wxCheckBox(this, ID_REVERSE_COLOURS, "Reverse colors");
 
+    wxString aggregates[3] = {"Mean", "Minimum", "Maximum"};
+    m_aggregateSelector = new wxChoice(this, ID_AGGREGATE_CHOICE, wxDefaultPosition, wxDefaultSize, 3, aggregates);
+    m_aggregateSelector->SetSelection(AGGREGATE_MEAN);
+    m_aggregateSelector->SetToolTip("How values are combined when there are more days or hours than pixels");
+
     m_yGraphScroller = new wxScrollBar(this, ID_GRAPH_Y_SCROLLBAR, wxDefaultPosition, wxDefaultSize, wxSB_VERTICAL);
     m_xGraphScroller = new wxScrollBar(this, ID_GRAPH_SCROLLBAR, wxDefaultPosition, wxDefaultSize, wxSB_HORIZONTAL);
 
@@ -278,6 +499,7 @@ wxDVDMapCtrl::wxDVDMapCtrl(wxWindow *parent,
     //	optionsSizer->Add(m_colourMapSelector, 0, wxALL | wxALIGN_CENTER_VERTICAL | wxEXPAND | wxALIGN_RIGHT, 3);
     optionsSizer->Add(m_colourMapSelector, 0, wxALL | wxEXPAND, 3);
     optionsSizer->Add(m_reverseColours, 0, wxLEFT | wxRIGHT | wxALIGN_CENTER_VERTICAL, 5);
+    optionsSizer->Add(m_aggregateSelector, 0, wxALL | wxEXPAND, 3);
     optionsSizer->AddStretchSpacer();
     optionsSizer->Add(new wxStaticText(this, wxID_ANY, "Min:"), 0, wxALIGN_CENTER | wxALIGN_CENTER_VERTICAL, 4);
     optionsSizer->Add(m_minTextBox, 0, wxALL | wxALIGN_CENTER_VERTICAL, 3);
@@ -338,6 +560,12 @@ void wxDVDMapCtrl::ReadState(std::string filename) {
     m_reverseColours->SetValue((s == "false") ? false : true);
     ReverseColours();
 
+    key = prefix + "Aggregate";
+    long aggregate;
+    cfg.Read(key, &aggregate, (long) AGGREGATE_MEAN);
+    if (aggregate >= AGGREGATE_MEAN && aggregate <= AGGREGATE_MAX)
+        SetAggregateMode((AggregateMode) aggregate);
+
     key = prefix + "Selections";
     success = cfg.Read(key, &s);
     if (debugging) assert(success);
@@ -415,6 +643,11 @@ void wxDVDMapCtrl::WriteState(std::string filename) {
     success = cfg.Write(key, s.c_str());
     if (debugging) assert(success);
 
+    key = prefix + "Aggregate";
+    s = wxString::Format(wxT("%d"), (int) GetAggregateMode());
+    success = cfg.Write(key, s.c_str());
+    if (debugging) assert(success);
+
     key = prefix + "Min";
     s = m_minTextBox->GetValue();
     success = cfg.Write(key, s.c_str());
@@ -456,6 +689,31 @@ void wxDVDMapCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
         ChangePlotDataTo(NULL);
 }
 
+void wxDVDMapCtrl::UpdateDataSet(wxDVTimeSeriesDataSet *d, size_t prevLength) {
+    if (m_currentlyShownDataSet != d)
+        return;
+
+    m_dmap->Invalidate(prevLength);
+    if (d->Length() <= prevLength) {
+        Invalidate();
+        return;
+    }
+
+    //Only widen the colour scale when the new points fall outside it, so user set limits stick.
+    double min, max;
+    d->GetMinAndMaxInRange(&min, &max, prevLength, d->Length());
+    if (min < m_colourMap->GetScaleMin() || max > m_colourMap->GetScaleMax()) {
+        m_colourMap->SetScaleMinMax(std::min(min, m_colourMap->GetScaleMin()),
+                                    std::max(max, m_colourMap->GetScaleMax()));
+        m_colourMap->ExtendScaleToNiceNumbers();
+        m_minTextBox->ChangeValue(wxString::Format("%lg", m_colourMap->GetScaleMin()));
+        m_maxTextBox->ChangeValue(wxString::Format("%lg", m_colourMap->GetScaleMax()));
+    }
+
+    UpdateXScrollbarPosition();
+    Invalidate();
+}
+
 void wxDVDMapCtrl::RemoveAllDataSets() {
     ChangePlotDataTo(NULL);
 
@@ -738,6 +996,16 @@ bool wxDVDMapCtrl::IsReversedColours() {
     return m_reverseColours->GetValue();
 }
 
+void wxDVDMapCtrl::SetAggregateMode(AggregateMode mode) {
+    m_aggregateSelector->SetSelection(mode);
+    m_dmap->SetAggregateMode(mode);
+    Invalidate();
+}
+
+wxDVDMapCtrl::AggregateMode wxDVDMapCtrl::GetAggregateMode() {
+    return (AggregateMode) m_dmap->GetAggregateMode();
+}
+
 void wxDVDMapCtrl::Invalidate() {
     m_plotSurface->Invalidate();
     m_plotSurface->Refresh();
@@ -749,8 +1017,7 @@ void wxDVDMapCtrl::ChangePlotDataTo(wxDVTimeSeriesDataSet *d) {
     m_dmap->SetData(d);
 
     double min, max;
-    if (d) {
-        d->GetDataMinAndMax(&min, &max);
+    if (d && m_dmap->GetValueRange(&min, &max)) {
         m_colourMap->SetScaleMinMax(min, max);
         m_colourMap->ExtendScaleToNiceNumbers();
         m_dmap->SetColourMap(m_colourMap);
@@ -792,6 +1059,10 @@ void wxDVDMapCtrl::OnReverseColours(wxCommandEvent &) {
     ReverseColours();
 }
 
+void wxDVDMapCtrl::OnAggregateSelection(wxCommandEvent &) {
+    SetAggregateMode((AggregateMode) m_aggregateSelector->GetSelection());
+}
+
 void wxDVDMapCtrl::ReverseColours() {
     m_colourMap->SetReversed(m_reverseColours->GetValue());
     m_plotSurface->Refresh();
@@ -975,7 +1246,7 @@ void wxDVDMapCtrl::OnResetColourMapMinMax(wxCommandEvent &) {
     if (!m_currentlyShownDataSet) return;
 
     double dataMin, dataMax;
-    m_currentlyShownDataSet->GetDataMinAndMax(&dataMin, &dataMax);
+    if (!m_dmap->GetValueRange(&dataMin, &dataMax)) return;
 
     m_colourMap->SetScaleMinMax(dataMin, dataMax);
     m_colourMap->ExtendScaleToNiceNumbers();
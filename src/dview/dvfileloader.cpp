@@ -0,0 +1,238 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+
+#include "wex/dview/dvaggregate.h"
+#include "wex/dview/dvfileloader.h"
+#include "wex/dview/dvfilereader.h"
+#include "wex/dview/dvplotctrl.h"
+#include "wex/dview/dvtimeseriesdataset.h"
+
+DEFINE_EVENT_TYPE(wxEVT_DVFILELOADER)
+
+// Data sets are added to the plot in batches of about this many points, so the first ones show up quickly.
+static const size_t PUBLISH_POINTS = 1 << 22;
+
+wxDVFileLoader::wxDVFileLoader(wxDVPlotCtrl *plotWin, wxEvtHandler *handler, int id)
+        : m_plotWin(plotWin), m_handler(handler), m_id(id), m_cancel(new std::atomic<bool>(false)),
+          m_filesQueued(0), m_dataSetsAdded(0), m_worker(1) {
+}
+
+wxDVFileLoader::~wxDVFileLoader() {
+    *m_cancel = true;
+    m_worker.Wait();
+
+    for (size_t k = 0; k < m_ready.size(); k++) {
+        m_ready[k].aggregates.clear();
+        for (size_t i = 0; i < m_ready[k].dataSets.size(); i++)
+            delete m_ready[k].dataSets[i];
+    }
+}
+
+void wxDVFileLoader::Load(const wxString &fileName) {
+    m_files.Add(fileName);
+    m_filesQueued++;
+
+    std::shared_ptr<std::atomic<bool> > cancel = m_cancel;
+    m_worker.Queue([this, fileName, cancel]() { ReadFile(fileName, cancel); });
+}
+
+bool wxDVFileLoader::IsLoading(const wxString &fileName) const {
+    return m_files.Index(fileName) != wxNOT_FOUND;
+}
+
+void wxDVFileLoader::Cancel() {
+    //The files queued so far see the old flag; the ones queued from now on get a fresh one.
+    *m_cancel = true;
+    m_cancel = std::make_shared<std::atomic<bool> >(false);
+    m_files.Clear();
+}
+
+void wxDVFileLoader::ReadFile(const wxString &fileName, std::shared_ptr<std::atomic<bool> > cancel) {
+    m_filesQueued--;
+
+    Batch batch;
+    batch.fileName = fileName;
+    batch.cancel = cancel;
+    batch.code = wxDVFileLoaderEvent::PROGRESS;
+
+    //Parsing is the first half of the progress, deriving the second.  The parsing threads each report,
+    //so only a percentage that is higher than the last one posted is posted.
+    std::atomic<int> parsePercent(0);
+    wxDVFileReader::ProgressFunc progress = [this, &fileName, &parsePercent](size_t parsed, size_t total) {
+        int percent = (total > 0) ? (int) (50.0 * std::min(parsed, total) / total) : 0;
+        int last = parsePercent.load();
+        while (percent > last) {
+            if (parsePercent.compare_exchange_weak(last, percent)) {
+                Post(wxDVFileLoaderEvent::PROGRESS, fileName, percent);
+                break;
+            }
+        }
+    };
+
+    std::vector<wxDVArrayDataSet *> dataSets;
+    std::vector<size_t> missing;
+    if (!*cancel)
+        Post(wxDVFileLoaderEvent::PROGRESS, fileName, 0);
+    if (*cancel || !wxDVFileReader::ReadDataSets(fileName, dataSets, missing, cancel.get(), progress)) {
+        batch.code = *cancel ? wxDVFileLoaderEvent::CANCELED : wxDVFileLoaderEvent::FAILED;
+        Hand(batch);
+        return;
+    }
+
+    size_t points = 0;
+    for (size_t i = 0; i < dataSets.size(); i++) {
+        if (*cancel) {
+            batch.aggregates.clear();
+            for (size_t k = 0; k < batch.dataSets.size(); k++)
+                delete batch.dataSets[k];
+            for (size_t k = i; k < dataSets.size(); k++)
+                delete dataSets[k];
+
+            batch.dataSets.clear();
+            batch.missing.clear();
+            batch.code = wxDVFileLoaderEvent::CANCELED;
+            Hand(batch);
+            return;
+        }
+
+        //Build what the tabs would otherwise compute on the UI thread when they first show the data set.
+        wxDVArrayDataSet *ds = dataSets[i];
+        if (ds->IsLoaded()) { // lazily read columns are left until they are viewed
+            std::shared_ptr<wxDVCalendarAggregate> aggregate = wxDVCalendarAggregate::Get(ds);
+            aggregate->Update();
+            batch.aggregates.push_back(aggregate);
+
+            double min, max;
+            ds->GetDataMinAndMax(&min, &max); // builds the min/max index
+            points += ds->Length();
+        }
+        batch.dataSets.push_back(ds);
+        batch.missing.push_back(i < missing.size() ? missing[i] : 0);
+
+        bool last = (i + 1 == dataSets.size());
+        if (last || points >= PUBLISH_POINTS) {
+            if (last)
+                batch.code = wxDVFileLoaderEvent::LOADED;
+            Hand(batch);
+
+            batch = Batch();
+            batch.fileName = fileName;
+            batch.cancel = cancel;
+            batch.code = wxDVFileLoaderEvent::PROGRESS;
+            points = 0;
+            if (!last)
+                Post(wxDVFileLoaderEvent::PROGRESS, fileName, (int) (50 + 50 * (i + 1) / dataSets.size()));
+        }
+    }
+
+    if (dataSets.size() == 0) {
+        batch.code = wxDVFileLoaderEvent::FAILED;
+        Hand(batch);
+    }
+}
+
+void wxDVFileLoader::Hand(Batch &batch) {
+    {
+        std::lock_guard<std::mutex> lock(m_readyMutex);
+        m_ready.push_back(batch);
+    }
+    CallAfter(&wxDVFileLoader::OnBatchesReady);
+}
+
+void wxDVFileLoader::OnBatchesReady() {
+    for (;;) {
+        Batch batch;
+        {
+            std::lock_guard<std::mutex> lock(m_readyMutex);
+            if (m_ready.empty())
+                break;
+            batch = m_ready.front();
+            m_ready.pop_front();
+        }
+
+        //Batches of a file that was canceled after they were read are dropped.
+        if (*batch.cancel) {
+            batch.aggregates.clear();
+            for (size_t i = 0; i < batch.dataSets.size(); i++)
+                delete batch.dataSets[i];
+            batch.dataSets.clear();
+            batch.code = wxDVFileLoaderEvent::CANCELED;
+        }
+
+        if (batch.dataSets.size() > 0) {
+            m_plotWin->Freeze();
+            m_plotWin->AddDataSets(std::vector<wxDVTimeSeriesDataSet *>(batch.dataSets.begin(), batch.dataSets.end()));
+            m_plotWin->GetStatisticsTable()->RebuildDataViewCtrl();
+            m_plotWin->Thaw();
+            m_plotWin->DisplayTabs();
+            m_dataSetsAdded += (int) batch.dataSets.size();
+
+            for (size_t i = 0; i < batch.dataSets.size(); i++) {
+                if (batch.missing[i] > 0) {
+                    m_missingDataSets.push_back(batch.dataSets[i]);
+                    m_missing.push_back(batch.missing[i]);
+                }
+            }
+        }
+
+        if (batch.code == wxDVFileLoaderEvent::PROGRESS)
+            continue;
+
+        //The file is done.  Take the report along, as showing it lets the next batches in.
+        std::vector<wxDVArrayDataSet *> missingDataSets;
+        std::vector<size_t> missing;
+        missingDataSets.swap(m_missingDataSets);
+        missing.swap(m_missing);
+        int dataSetsAdded = m_dataSetsAdded;
+        m_dataSetsAdded = 0;
+
+        //Cancel has already forgotten about canceled files, which may have been queued again since.
+        int index = m_files.Index(batch.fileName);
+        if (!*batch.cancel && index != wxNOT_FOUND)
+            m_files.RemoveAt(index);
+
+        if (batch.code == wxDVFileLoaderEvent::LOADED) {
+            m_plotWin->ReadState(batch.fileName.ToStdString());
+            Post(batch.code, batch.fileName, 100, dataSetsAdded);
+            wxDVFileReader::ReportMissingData(m_plotWin, missingDataSets, missing);
+        } else
+            Post(batch.code, batch.fileName, 100, dataSetsAdded);
+    }
+}
+
+void wxDVFileLoader::Post(int code, const wxString &fileName, int percent, int dataSetsAdded) {
+    if (m_handler)
+        wxQueueEvent(m_handler, new wxDVFileLoaderEvent(m_id, wxEVT_DVFILELOADER, code, fileName, percent,
+                                                        m_filesQueued, dataSetsAdded));
+}
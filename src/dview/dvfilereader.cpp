@@ -31,11 +31,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <locale.h>
 #include <map>
+#include <math.h>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -50,10 +57,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <wx/txtstrm.h>
 #include <wx/wfstream.h>
 #include <wx/dialog.h>
+#include <wx/file.h>
+#include <wx/log.h>
+#include <wx/thread.h>
+#include <wx/utils.h>
 
 #include <lk/sqlite3.h>
 
+#include "wex/dview/dvcachefile.h"
 #include "wex/dview/dvfilereader.h"
+#include "wex/dview/dvmappedfile.h"
 #include "wex/dview/dvplotctrl.h"
 #include "wex/dview/dvtimeseriesdataset.h"
 #include "wex/utils.h"
@@ -461,8 +474,519 @@ static bool ReadWeatherFileLine(FILE *fp, int type,
         return false;
 }
 
+// The variables ReadWeatherFile shows, in data set order: gh, dn, df, wind, drytemp, dewtemp,
+// relhum, pressure, winddir, snowdepth. Columns of the comma separated formats (-1: not in the file),
+// [start, end) character positions of the fixed width TM2 fields, and the scale of each value.
+#define WF_VARIABLES 10
+static const int WF_EPW_COLUMNS[WF_VARIABLES] = {13, 14, 15, 21, 6, 7, 8, 9, 20, 30};
+static const double WF_EPW_SCALE[WF_VARIABLES] = {1, 1, 1, 1, 1, 1, 1, 0.01, 1, 1}; // Pa to mbar
+static const int WF_TM3_COLUMNS[WF_VARIABLES] = {4, 7, 10, 46, 31, 34, 37, 40, 43, -1};
+static const int WF_TM2_FIELDS[WF_VARIABLES][2] = {{17, 21}, {23, 27}, {29, 33}, {95, 98}, {67, 71},
+                                                   {73, 77}, {79, 82}, {84, 88}, {90, 93}, {133, 136}};
+static const double WF_TM2_SCALE[WF_VARIABLES] = {1, 1, 1, 0.1, 0.1, 0.1, 1, 1, 1, 1};
+
+// Returns the start of the line after the one at p, or end.
+static const char *NextLine(const char *p, const char *end) {
+    const char *eol = (const char *) memchr(p, '\n', end - p);
+    return eol ? eol + 1 : end;
+}
+
+// Reads the data records of a TM2, TM3 or EPW weather file straight out of a mapping of the file.
+// One pass finds each record and the fields of the variables, then each variable is converted in turn.
+// Touches no UI, so several files can be read at once. Returns false if there are fewer records than a year.
+static bool ReadWeatherRecords(const wxDVMappedFile &map, int wfType, std::vector<wxDVArrayDataSet *> &dataSets) {
+    const char *p = map.GetData();
+    const char *end = p + map.GetSize();
+
+    int headerLines = (wfType == WF_EPW) ? 8 : ((wfType == WF_TM3) ? 2 : 1);
+    int recordsPerHour = 1;
+    for (int i = 0; i < headerLines && p < end; i++) {
+        const char *next = NextLine(p, end);
+        //DATA PERIODS,N periods, N records/hr, A period 1 name, A start day of week, start date, end date
+        if (wfType == WF_EPW && i == headerLines - 1 && next - p > 13 && strncmp(p, "DATA PERIODS,", 13) == 0) {
+            const char *q = (const char *) memchr(p + 13, ',', next - p - 13);
+            if (q) recordsPerHour = (int) wxDVFileReader::ParseDouble(q + 1, next);
+            if (recordsPerHour < 1 || recordsPerHour > 60) recordsPerHour = 1;
+        }
+        p = next;
+    }
+
+    size_t nrec = 8760 * recordsPerHour;
+    std::vector<const char *> fields(nrec * WF_VARIABLES);
+    std::vector<const char *> fieldEnds(nrec * WF_VARIABLES);
+
+    for (size_t r = 0; r < nrec; r++) {
+        if (p >= end)
+            return false;
+        const char *next = NextLine(p, end);
+        const char *lineEnd = next;
+        while (lineEnd > p && (lineEnd[-1] == '\n' || lineEnd[-1] == '\r')) lineEnd--;
+
+        const char **f = &fields[r * WF_VARIABLES];
+        const char **fe = &fieldEnds[r * WF_VARIABLES];
+        if (wfType == WF_TM2) {
+            if (lineEnd - p < 142)
+                return false;
+            for (int k = 0; k < WF_VARIABLES; k++) {
+                f[k] = p + WF_TM2_FIELDS[k][0];
+                fe[k] = p + WF_TM2_FIELDS[k][1];
+            }
+        } else {
+            const int *columns = (wfType == WF_EPW) ? WF_EPW_COLUMNS : WF_TM3_COLUMNS;
+            int minColumns = (wfType == WF_EPW) ? 32 : 68;
+
+            // field starts of the line, as far as needed
+            const char *starts[68];
+            int ncols = 0;
+            const char *q = p;
+            while (ncols < minColumns) {
+                starts[ncols++] = q;
+                q = (const char *) memchr(q, ',', lineEnd - q);
+                if (!q) break;
+                q++;
+            }
+            if (ncols < minColumns)
+                return false;
+
+            for (int k = 0; k < WF_VARIABLES; k++) {
+                f[k] = (columns[k] < 0) ? 0 : starts[columns[k]];
+                fe[k] = lineEnd;
+            }
+        }
+
+        p = next;
+    }
+
+    double timeStep = 1.0 / recordsPerHour;
+    for (int k = 0; k < WF_VARIABLES; k++) {
+        double scale = (wfType == WF_TM2) ? WF_TM2_SCALE[k] : ((wfType == WF_EPW) ? WF_EPW_SCALE[k] : 1.0);
+        std::vector<double> values(nrec);
+        for (size_t r = 0; r < nrec; r++) {
+            const char *field = fields[r * WF_VARIABLES + k];
+            values[r] = field ? wxDVFileReader::ParseDouble(field, fieldEnds[r * WF_VARIABLES + k]) * scale : 999;
+        }
+
+        dataSets[k]->Copy(values);
+        dataSets[k]->SetTimeStep(timeStep);
+        dataSets[k]->SetOffset(timeStep / 2); //Values are plotted at the middle of the interval.
+    }
+
+    return true;
+}
+
+// Bytes of a file parsed so far, shared by the threads parsing it.
+struct ParseProgress {
+    std::atomic<size_t> parsed;
+    size_t total;
+    const wxDVFileReader::ProgressFunc *report;
+
+    ParseProgress(size_t start, size_t size, const wxDVFileReader::ProgressFunc &func)
+            : parsed(start), total(size), report(&func) {}
+
+    void Add(size_t n) {
+        size_t done = parsed += n;
+        if (*report)
+            (*report)(done, total);
+    }
+};
+
+// Tokenizes data rows straight out of memory using the same rules as the fgets() loop in FastRead:
+// each line is read up to and including its newline, which is not part of the last cell, and a cell
+// that is empty (including a last one holding only the line ending) or missing from a short line is
+// counted in missing[] and stored as a missing value, as ParseColumnRows does.
+// Stops at the end of the range, at a line starting with "EOF" or once cancel is set, and returns where it stopped.
+// The bytes parsed are added to progress every few thousand lines.
+static const char *ParseDataRows(const char *p, const char *end, int columns, bool commaDelimiters,
+                                 std::vector<std::vector<double> > &values, std::vector<size_t> &missing,
+                                 int *lines, bool *eofMarker, const std::atomic<bool> *cancel = 0,
+                                 ParseProgress *progress = 0) {
+    const char *reported = p;
+    while (p < end) {
+        if ((*lines & 4095) == 0) {
+            if (cancel && *cancel)
+                break;
+            if (progress && p > reported) {
+                progress->Add(p - reported);
+                reported = p;
+            }
+        }
+
+        const char *eol = (const char *) memchr(p, '\n', end - p);
+        const char *lineEnd = eol ? eol + 1 : end;
+
+        if (lineEnd - p >= 3 && p[0] == 'E' && p[1] == 'O' && p[2] == 'F') {
+            if (eofMarker) *eofMarker = true;
+            break;
+        }
+
+        const char *q = p;
+        int ncol = 0;
+        while (q < lineEnd && ncol < columns) {
+            while (q < lineEnd && (*q == ' ' || *q == '\t')) q++; // skip white space
+            const char *token = q;
+            while (q < lineEnd && *q != ',' && (commaDelimiters || (*q != '\t' && *q != ' ')))
+                q++;
+            const char *tokenEnd = q;
+            while (tokenEnd > token && (tokenEnd[-1] == '\r' || tokenEnd[-1] == '\n'))
+                tokenEnd--;
+
+            if (tokenEnd > token) {
+                values[ncol].push_back(wxDVFileReader::ParseDouble(token, tokenEnd));
+            } else {
+                values[ncol].push_back(wxDVTimeSeriesDataSet::MissingValue());
+                missing[ncol]++;
+            }
+
+            if (q < lineEnd) q++; // skip the comma or delimiter
+            ncol++;
+        }
+        for (; ncol < columns; ncol++) {
+            values[ncol].push_back(wxDVTimeSeriesDataSet::MissingValue());
+            missing[ncol]++;
+        }
+
+        (*lines)++;
+        p = lineEnd;
+    }
+
+    if (progress && p > reported)
+        progress->Add(p - reported);
+    return p;
+}
+
+void wxDVFileReader::ReportMissingData(wxWindow *parent, const std::vector<wxDVArrayDataSet *> &dataSets,
+                                       const std::vector<size_t> &missing) {
+    wxString list;
+    for (size_t i = 0; i < dataSets.size() && i < missing.size(); i++) {
+        if (missing[i] > 0)
+            list += wxString::Format(wxT("'%s': %d\n"), dataSets[i]->GetSeriesTitle(), (int) missing[i]);
+    }
+    if (list.IsEmpty())
+        return;
+
+    wxString message(wxT("These columns contain missing data (number of empty cells). Missing values are left out "
+                         "of statistics and shown as gaps, please correct your file.\n\n"));
+    wxShowTextMessageDialog(message + list, wxEmptyString, parent, wxSize(400, 250));
+}
+
+// Data rows parsed by one worker in FastRead; chunks are merged back in file order.
+struct DataRowsChunk {
+    const char *begin, *end;
+    std::vector<std::vector<double> > values;
+    std::vector<size_t> missing;
+    int lines;
+    bool eofMarker;
+};
+
+static void ParseDataRowsChunk(DataRowsChunk *chunk, int columns, bool commaDelimiters,
+                               const std::atomic<bool> *cancel, ParseProgress *progress) {
+    chunk->values.resize(columns);
+    chunk->missing.assign(columns, 0);
+    chunk->lines = 0;
+    chunk->eofMarker = false;
+    ParseDataRows(chunk->begin, chunk->end, columns, commaDelimiters, chunk->values, chunk->missing,
+                  &chunk->lines, &chunk->eofMarker, cancel, progress);
+}
+
+// Splits [begin, end) into at most nchunks pieces that each start at the beginning of a line.
+static std::vector<DataRowsChunk> SplitDataRows(const char *begin, const char *end, size_t nchunks) {
+    std::vector<DataRowsChunk> chunks;
+    size_t len = end - begin;
+    const char *start = begin;
+    for (size_t k = 1; k <= nchunks && start < end; k++) {
+        const char *stop = end;
+        if (k < nchunks) {
+            stop = begin + (len / nchunks) * k;
+            if (stop < start) stop = start;
+            const char *eol = (const char *) memchr(stop, '\n', end - stop);
+            stop = eol ? eol + 1 : end;
+        }
+
+        DataRowsChunk c;
+        c.begin = start;
+        c.end = stop;
+        chunks.push_back(c);
+        start = stop;
+    }
+    return chunks;
+}
+
+// Parses data rows in [begin, end) and appends them to dataSets, one per column; returns the number of rows.
+static int AppendDataRows(const char *begin, const char *end, bool commaDelimiters,
+                          const std::vector<wxDVArrayDataSet *> &dataSets, bool *eofMarker) {
+    int columns = (int) dataSets.size();
+    std::vector<std::vector<double> > values(columns);
+    std::vector<size_t> missing(columns, 0);
+    int lines = 0;
+    ParseDataRows(begin, end, columns, commaDelimiters, values, missing, &lines, eofMarker);
+
+    for (int i = 0; i < columns; i++) {
+        if (values[i].size() > 0)
+            dataSets[i]->AppendY(&values[i][0], values[i].size());
+    }
+    return lines;
+}
+
+wxDVFileFollower::wxDVFileFollower()
+        : m_offset(0), m_commaDelimiters(false), m_ended(false) {
+}
+
+int wxDVFileFollower::ReadAppendedRows(std::vector<size_t> &prevLengths) {
+    if (!IsOk() || m_ended)
+        return -1;
+
+    wxLogNull noLog; // a missing or locked file just stops following
+    wxFile file;
+    if (!wxFileExists(m_fileName) || !file.Open(m_fileName))
+        return -1;
+
+    wxFileOffset size = file.Length();
+    if (size == wxInvalidOffset || size < m_offset)
+        return -1; // truncated or rewritten
+    if (size == m_offset || file.Seek(m_offset) == wxInvalidOffset)
+        return 0;
+
+    std::vector<char> buf((size_t) (size - m_offset));
+    ssize_t nread = file.Read(&buf[0], buf.size());
+    if (nread == wxInvalidOffset)
+        return -1;
+    if (nread == 0)
+        return 0;
+
+    const char *begin = &buf[0];
+    const char *end = begin + nread;
+    const char *lineEnd = end;
+    while (lineEnd > begin && lineEnd[-1] != '\n')
+        lineEnd--;
+
+    // nothing new unless a line was completed
+    if (lineEnd == begin)
+        return 0;
+
+    if (m_partialRowLengths.size() == m_dataSets.size()) {
+        for (size_t i = 0; i < m_dataSets.size(); i++)
+            m_dataSets[i]->Truncate(m_partialRowLengths[i]);
+    }
+    m_partialRowLengths.clear();
+
+    prevLengths.resize(m_dataSets.size());
+    for (size_t i = 0; i < m_dataSets.size(); i++)
+        prevLengths[i] = m_dataSets[i]->Length();
+
+    // missing values are stored as in FastRead, without reporting them on every update
+    bool eofMarker = false;
+    int lines = AppendDataRows(begin, lineEnd, m_commaDelimiters, m_dataSets, &eofMarker);
+    m_offset += lineEnd - begin;
+
+    // show an incomplete last line too, but read it again once it is complete
+    if (!eofMarker && lineEnd < end) {
+        for (size_t i = 0; i < m_dataSets.size(); i++)
+            m_partialRowLengths.push_back(m_dataSets[i]->Length());
+        lines += AppendDataRows(lineEnd, end, m_commaDelimiters, m_dataSets, &eofMarker);
+    }
+
+    m_ended = eofMarker;
+    return lines;
+}
+
+void wxDVFileFollower::Stop() {
+    m_fileName.Clear();
+    m_dataSets.clear();
+    m_partialRowLengths.clear();
+    m_offset = 0;
+    m_ended = false;
+}
+
+// Rows per entry of the row index built for lazily read files.
+static const size_t LAZY_ROW_BLOCK = 4096;
+
+// Finds where every LAZY_ROW_BLOCK-th data row in [begin, end) starts, as an offset from base, followed by
+// where the data rows end. Stops at a line starting with "EOF" like ParseDataRows, and returns the row count.
+static size_t IndexDataRows(const char *base, const char *begin, const char *end, std::vector<size_t> &blockStarts) {
+    size_t rows = 0;
+    const char *p = begin;
+    while (p < end) {
+        const char *eol = (const char *) memchr(p, '\n', end - p);
+        const char *lineEnd = eol ? eol + 1 : end;
+
+        if (lineEnd - p >= 3 && p[0] == 'E' && p[1] == 'O' && p[2] == 'F')
+            break;
+
+        if (rows % LAZY_ROW_BLOCK == 0)
+            blockStarts.push_back(p - base);
+        rows++;
+        p = lineEnd;
+    }
+    blockStarts.push_back(p - base);
+    return rows;
+}
+
+// Reads one column of the data rows in [p, end) into y, tokenizing each line like ParseDataRows.
+// Cells that are empty or missing from a short line read as missing values and are counted in *missing.
+static void ParseColumnRows(const char *p, const char *end, int column, bool commaDelimiters,
+                            double *y, size_t *missing) {
+    while (p < end) {
+        const char *eol = (const char *) memchr(p, '\n', end - p);
+        const char *lineEnd = eol ? eol + 1 : end;
+
+        const char *q = p;
+        for (int ncol = 0; ncol < column && q < lineEnd; ncol++) {
+            while (q < lineEnd && (*q == ' ' || *q == '\t')) q++;
+            while (q < lineEnd && *q != ',' && (commaDelimiters || (*q != '\t' && *q != ' ')))
+                q++;
+            if (q < lineEnd) q++;
+        }
+
+        while (q < lineEnd && (*q == ' ' || *q == '\t')) q++;
+        const char *token = q;
+        while (q < lineEnd && *q != ',' && (commaDelimiters || (*q != '\t' && *q != ' ')))
+            q++;
+        while (q > token && (q[-1] == '\r' || q[-1] == '\n'))
+            q--;
+
+        if (q > token) {
+            *y = wxDVFileReader::ParseDouble(token, q);
+        } else {
+            *y = wxDVTimeSeriesDataSet::MissingValue();
+            (*missing)++;
+        }
+
+        y++;
+        p = lineEnd;
+    }
+}
+
+// Reads the columns of a csv/txt file that FastRead opened lazily, using the row index it built.
+class wxDVTextColumnLoader : public wxDVColumnLoader {
+public:
+    wxDVTextColumnLoader(const wxString &fileName, size_t fileSize, bool commaDelimiters,
+                         const std::vector<size_t> &blockStarts, size_t rows)
+            : m_fileName(fileName), m_fileSize(fileSize), m_commaDelimiters(commaDelimiters),
+              m_blockStarts(blockStarts), m_rows(rows) {
+        m_modTime = wxFileName(fileName).GetModificationTime();
+    }
+
+    virtual bool LoadColumn(size_t column, std::vector<double> &y) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_ptr<wxBusyCursor> busy(wxIsMainThread() ? new wxBusyCursor : 0);
+
+        wxFileName fn(m_fileName);
+        wxDVMappedFile mappedFile;
+        if (!fn.FileExists() || fn.GetModificationTime() != m_modTime
+            || !mappedFile.Open(m_fileName) || mappedFile.GetSize() != m_fileSize) {
+            wxLogError("%s has changed or can no longer be read since it was opened; reopen it to view more columns.",
+                       m_fileName.c_str());
+            return false;
+        }
+
+        // Rows are independent, so blocks of them are parsed in parallel straight into place.
+        size_t nheader = y.size();
+        y.resize(nheader + m_rows);
+        size_t nblocks = m_blockStarts.size() - 1;
+        size_t nthreads = std::thread::hardware_concurrency();
+        if (nthreads < 1) nthreads = 1;
+        nthreads = std::min(nthreads, nblocks / 16 + 1);
+
+        std::vector<size_t> missing(nthreads, 0);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < nthreads; t++) {
+            size_t first = nblocks * t / nthreads;
+            size_t last = nblocks * (t + 1) / nthreads;
+            if (first == last) continue;
+            const char *begin = mappedFile.GetData() + m_blockStarts[first];
+            const char *end = mappedFile.GetData() + m_blockStarts[last];
+            double *dest = &y[nheader + first * LAZY_ROW_BLOCK];
+            if (t + 1 < nthreads)
+                workers.push_back(std::thread(ParseColumnRows, begin, end, (int) column, m_commaDelimiters,
+                                              dest, &missing[t]));
+            else
+                ParseColumnRows(begin, end, (int) column, m_commaDelimiters, dest, &missing[t]);
+        }
+        for (size_t k = 0; k < workers.size(); k++)
+            workers[k].join();
+
+        size_t nmissing = 0;
+        for (size_t t = 0; t < nthreads; t++)
+            nmissing += missing[t];
+        if (nmissing > 0)
+            wxLogWarning("Column %d of %s contains %d empty cells, which are left out of statistics and plots.",
+                         (int) column + 1, m_fileName.c_str(), (int) nmissing);
+        return true;
+    }
+
+private:
+    wxString m_fileName;
+    size_t m_fileSize;
+    wxDateTime m_modTime;
+    bool m_commaDelimiters;
+    std::vector<size_t> m_blockStarts;
+    size_t m_rows;
+    std::mutex m_mutex;
+};
+
+static int s_lazyColumns = 256;
+
+void wxDVFileReader::SetLazyColumns(int minColumns) {
+    s_lazyColumns = minColumns;
+}
+
+int wxDVFileReader::GetLazyColumns() {
+    return s_lazyColumns;
+}
+
+static bool s_useCache = true;
+
+void wxDVFileReader::SetUseCache(bool b) {
+    s_useCache = b;
+}
+
+bool wxDVFileReader::GetUseCache() {
+    return s_useCache;
+}
+
+bool wxDVFileReader::AddCachedDataSets(wxDVPlotCtrl *plotWin, const wxString &filename, const wxString &variant) {
+    if (!s_useCache)
+        return false;
+
+    wxStopWatch sw;
+    sw.Start();
+
+    std::vector<wxDVArrayDataSet *> dataSets;
+    if (!wxDVCacheFile::Read(filename, dataSets, variant) || dataSets.size() == 0)
+        return false;
+
+    plotWin->Freeze();
+    plotWin->AddDataSets(std::vector<wxDVTimeSeriesDataSet *>(dataSets.begin(), dataSets.end()));
+    plotWin->GetStatisticsTable()->RebuildDataViewCtrl();    //We must do this only after all datasets have been added
+    plotWin->Thaw();
+
+    plotWin->ReadState(filename.ToStdString());
+
+    wxLogDebug("wxDVFileReader::AddCachedDataSets [ncol=%d] = %d msec\n", (int) dataSets.size(), (int) sw.Time());
+    return true;
+}
+
+// Data sets without a group in their column title are grouped by the name of the file.
+static void SetGroupNames(const std::vector<wxDVArrayDataSet *> &dataSets, const std::vector<wxString> &groupNames,
+                          const wxString &filename) {
+    for (size_t i = 0; i < dataSets.size(); i++)
+        dataSets[i]->SetGroupName(groupNames[i].size() > 1 ? groupNames[i] : wxFileNameFromPath(filename));
+}
+
+// What ReadTextDataSets found in a csv/txt file besides its data sets.
+struct wxDVFileReader::TextFileInfo {
+    std::vector<size_t> missing; // empty cells per column
+    int lines;
+    int nthreads;
+    bool weatherFile; // a tmy3 file with a csv extension, to be read as a weather file instead
+    bool writeCache;
+
+    TextFileInfo() : lines(0), nthreads(1), weatherFile(false), writeCache(false) {}
+};
+
 bool
-wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int prealloc_data, int prealloc_lnchars) {
+wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int prealloc_data, int prealloc_lnchars,
+                         bool memory_map, wxDVFileFollower *follower) {
     wxString fExtension = filename.Right(3);
     if (fExtension.CmpNoCase("tm2") == 0 ||
         fExtension.CmpNoCase("epw") == 0 ||
@@ -472,19 +996,87 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
         return ReadSQLFile(plotWin, filename);
     }
 
+    if (!follower && AddCachedDataSets(plotWin, filename))
+        return true;
+
     wxStopWatch sw;
     sw.Start();
 
-    FILE *inFile = fopen(filename.c_str(), "r"); //r is for read mode.
-    if (!inFile)
-        return false;
-
     unsigned lnchars = prealloc_lnchars > 0 ? prealloc_lnchars : 1024;
     lnchars *= 2;  //Give ourselves extra room
 
     std::vector<wxDVArrayDataSet *> dataSets;
+    TextFileInfo info;
+    if (!ReadTextDataSets(filename, prealloc_data, lnchars, memory_map, follower, dataSets, info, 0, ProgressFunc())) {
+        if (info.weatherFile)
+            return ReadWeatherFile(plotWin, filename);
+        return false;
+    }
+
+    ReportMissingData(plotWin, dataSets, info.missing);
+
+    return AddFastReadDataSets(plotWin, filename, dataSets, info.lines, (int) dataSets.size(), prealloc_data, lnchars,
+                               info.nthreads, sw, info.writeCache);
+}
+
+bool wxDVFileReader::ReadDataSets(const wxString &filename, std::vector<wxDVArrayDataSet *> &dataSets,
+                                  std::vector<size_t> &missing, const std::atomic<bool> *cancel,
+                                  const ProgressFunc &progress) {
+    missing.clear();
+    wxString fExtension = filename.Right(3);
+    if (fExtension.CmpNoCase("sql") == 0)
+        return false;
+
+    if (s_useCache && wxDVCacheFile::Read(filename, dataSets) && dataSets.size() > 0) {
+        missing.assign(dataSets.size(), 0);
+        return true;
+    }
+
+    bool weatherFile = IsWeatherFile(filename) || fExtension.CmpNoCase("smw") == 0;
+    bool writeCache = true;
+    if (!weatherFile) {
+        unsigned lnchars = 2048;
+        TextFileInfo info;
+        if (ReadTextDataSets(filename, 8760, lnchars, true, 0, dataSets, info, cancel, progress)) {
+            missing = info.missing;
+            writeCache = info.writeCache;
+        } else if (!info.weatherFile)
+            return false;
+        else
+            weatherFile = true;
+    }
+
+    if (weatherFile) {
+        if (!ReadWeatherDataSets(filename, dataSets))
+            return false;
+        for (size_t i = 0; i < dataSets.size(); i++)
+            dataSets[i]->SetGroupName(wxFileNameFromPath(filename));
+        missing.assign(dataSets.size(), 0);
+    }
+
+    if (cancel && *cancel) {
+        for (size_t i = 0; i < dataSets.size(); i++)
+            delete dataSets[i];
+        dataSets.clear();
+        return false;
+    }
+
+    if (s_useCache && writeCache)
+        wxDVCacheFile::Write(filename, dataSets);
+    return true;
+}
+
+bool wxDVFileReader::ReadTextDataSets(const wxString &filename, int prealloc_data, unsigned &lnchars,
+                                      bool memory_map, wxDVFileFollower *follower,
+                                      std::vector<wxDVArrayDataSet *> &dataSets, TextFileInfo &info,
+                                      const std::atomic<bool> *cancel, const ProgressFunc &progress) {
+    wxString fExtension = filename.Right(3);
+
+    FILE *inFile = fopen(filename.c_str(), "rb"); //binary, so ftell gives the byte offset of the data rows.
+    if (!inFile)
+        return false;
+
     std::vector<wxString> groupNames;
-    std::vector<double> timeCounters;
     int columns = 0;
     bool CommaDelimiters = false;
 
@@ -520,7 +1112,7 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
             wxString titleToken = tkz_titles.GetNextToken();
             ds->SetSeriesTitle(titleToken.AfterLast('|'));
             tkz_offsets.GetNextToken().ToDouble(&entry);
-            timeCounters.push_back(entry);
+            ds->SetOffset(entry);
             tkz_tStep.GetNextToken().ToDouble(&entry);
             ds->SetTimeStep(entry);
             ds->SetUnits(tkz_units.GetNextToken());
@@ -555,7 +1147,8 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
             if (count_names == 7 && count_units == 68 && fExtension.CmpNoCase("csv") == 0) //Its a tmy3.
             {
                 fclose(inFile);
-                return ReadWeatherFile(plotWin, filename);
+                info.weatherFile = true;
+                return false;
             } else {
                 fclose(inFile);
                 return false;
@@ -572,17 +1165,16 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
         double entry;
 
         wxDVArrayDataSet *ds = new wxDVArrayDataSet();
+        ds->SetOffset(0.5);
         dataSets.push_back(ds);
         wxString title = tkz_names.GetNextToken();
-        timeCounters.push_back(0.5);
         if (IsNumeric(title) || IsDate(title)) {
             firstRowContainsTitles = false;
             isEnergyPlusOutput = false;
             ds->SetSeriesTitle(wxT("-no name-"));
             groupNames.push_back("");
             title.ToDouble(&entry);
-            ds->Append(wxRealPoint(timeCounters[0], entry));
-            timeCounters[0] += 1.0;
+            ds->AppendY(entry);
         } else {
             ds->SetSeriesTitle(title.AfterLast('|'));
             groupNames.push_back(title.BeforeLast('|'));
@@ -598,20 +1190,19 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
                 secondRowContainsUnits = false;
                 ds->SetUnits(wxT("-no units-"));
                 units_tmp.ToDouble(&entry);
-                ds->Append(wxRealPoint(timeCounters[0], entry));
-                timeCounters[0] += 1.0;
+                ds->AppendY(entry);
             } else {
                 isEnergyPlusOutput = false;
                 ds->SetUnits(units_tmp);
                 //ds->SetYLabel(title + " (" + units + ")");
             }
         }
-        ds->SetTimeStep(1.0, false);
+        ds->SetTimeStep(1.0);
 
         columns = 1;
         while (columns < count_names) {
-            timeCounters.push_back(0.5);
             wxDVArrayDataSet *ds_tmp = new wxDVArrayDataSet();
+            ds_tmp->SetOffset(0.5);
             wxString titleToken = tkz_names.GetNextToken();
             if (isEnergyPlusOutput) {
                 wxString tt = titleToken.AfterLast('|');
@@ -631,8 +1222,7 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
             else {
                 titleToken.ToDouble(&entry);
                 ds_tmp->SetSeriesTitle(wxT("-no name-"));
-                ds_tmp->Append(wxRealPoint(timeCounters[columns], entry));
-                timeCounters[columns] += 1.0;
+                ds_tmp->AppendY(entry);
             }
 
             if (secondRowContainsUnits) {
@@ -644,32 +1234,174 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
             } else if (!isEnergyPlusOutput) {
                 tkz_units.GetNextToken().ToDouble(&entry);
                 ds_tmp->SetUnits(wxT("-no units-"));
-                ds_tmp->Append(wxRealPoint(timeCounters[columns], entry));
-                timeCounters[columns] += 1.0;
+                ds_tmp->AppendY(entry);
             }
-            ds_tmp->SetTimeStep(1.0, false);
+            ds_tmp->SetTimeStep(1.0);
             dataSets.push_back(ds_tmp);
             groupNames.push_back(titleToken.BeforeLast('|'));
             columns++;
         }
     }
 
-    if (prealloc_data > 0) {
+    // Wide files only get a row index now; each column is read the first time it is viewed.
+    bool lazy = memory_map && !follower && s_lazyColumns > 0 && columns >= s_lazyColumns;
+
+    if (prealloc_data > 0 && !lazy) {
         // preallocate data
         for (size_t i = 0; i < dataSets.size(); i++)
             dataSets[i]->Alloc(prealloc_data);
     }
 
     int line = 0, ncol, ndbuf;
+    long dataStart = ftell(inFile);
+    wxDVMappedFile mappedFile;
+
+    if (memory_map && dataStart >= 0 && mappedFile.Open(filename) && (size_t) dataStart <= mappedFile.GetSize()) {
+        fclose(inFile);
+
+        // Split the data rows into newline aligned chunks of at least 1 MB and parse them in parallel.
+        const char *dataBegin = mappedFile.GetData() + dataStart;
+        const char *dataEnd = mappedFile.GetData() + mappedFile.GetSize();
+
+        if (lazy) {
+            std::vector<size_t> blockStarts;
+            size_t rows = IndexDataRows(mappedFile.GetData(), dataBegin, dataEnd, blockStarts);
+            std::shared_ptr<wxDVColumnLoader> loader(new wxDVTextColumnLoader(filename, mappedFile.GetSize(),
+                                                                              CommaDelimiters, blockStarts, rows));
+            mappedFile.Close();
+
+            for (int i = 0; i < columns; i++) {
+                wxDVArrayDataSet *ds = new wxDVLazyArrayDataSet(*dataSets[i], dataSets[i]->Length() + rows, loader, i);
+                delete dataSets[i];
+                dataSets[i] = ds;
+            }
+
+            SetGroupNames(dataSets, groupNames, filename);
+            info.missing.assign(columns, 0);
+            info.lines = (int) rows;
+            return true;
+        }
+
+        // When following the file, an incomplete last line is parsed separately so it can be read again later.
+        const char *fileEnd = dataEnd;
+        if (follower) {
+            while (dataEnd > dataBegin && dataEnd[-1] != '\n')
+                dataEnd--;
+        }
+
+        size_t nthreads = std::thread::hardware_concurrency();
+        if (nthreads < 1) nthreads = 1;
+        nthreads = std::min(nthreads, (size_t) (dataEnd - dataBegin) / (1024 * 1024) + 1);
+
+        ParseProgress parseProgress(dataStart, mappedFile.GetSize(), progress);
+        std::vector<DataRowsChunk> chunks = SplitDataRows(dataBegin, dataEnd, nthreads);
+        std::vector<std::thread> workers;
+        for (size_t k = 1; k < chunks.size(); k++)
+            workers.push_back(std::thread(ParseDataRowsChunk, &chunks[k], columns, CommaDelimiters, cancel,
+                                          &parseProgress));
+        if (chunks.size() > 0)
+            ParseDataRowsChunk(&chunks[0], columns, CommaDelimiters, cancel, &parseProgress);
+        for (size_t k = 0; k < workers.size(); k++)
+            workers[k].join();
+
+        if (cancel && *cancel) {
+            for (size_t i = 0; i < dataSets.size(); i++)
+                delete dataSets[i];
+            dataSets.clear();
+            return false;
+        }
+
+        // Rows after an EOF marker are ignored, so drop every chunk past the first one that found it.
+        size_t nused = 0;
+        while (nused < chunks.size()) {
+            if (chunks[nused++].eofMarker)
+                break;
+        }
+
+        std::vector<size_t> missing(columns, 0);
+        for (int i = 0; i < columns; i++) {
+            size_t total = dataSets[i]->Length();
+            for (size_t k = 0; k < nused; k++)
+                total += chunks[k].values[i].size();
+            dataSets[i]->Alloc(total);
+
+            for (size_t k = 0; k < nused; k++) {
+                std::vector<double> &values = chunks[k].values[i];
+                if (values.size() > 0)
+                    dataSets[i]->AppendY(&values[0], values.size());
+                std::vector<double>().swap(values);
+                missing[i] += chunks[k].missing[i];
+            }
+        }
+        for (size_t k = 0; k < nused; k++)
+            line += chunks[k].lines;
+
+        if (follower && !chunks.empty() && chunks[nused - 1].eofMarker) {
+            follower->Stop(); // the file is complete
+            follower = 0;
+        } else if (follower) {
+            follower->Stop();
+            follower->m_fileName = filename;
+            follower->m_dataSets = dataSets;
+            follower->m_commaDelimiters = CommaDelimiters;
+            follower->m_offset = dataEnd - mappedFile.GetData();
+            if (dataEnd < fileEnd) {
+                for (int i = 0; i < columns; i++)
+                    follower->m_partialRowLengths.push_back(dataSets[i]->Length());
+                bool eofMarker = false;
+                line += AppendDataRows(dataEnd, fileEnd, CommaDelimiters, dataSets, &eofMarker);
+                if (eofMarker) {
+                    follower->Stop();
+                    follower = 0;
+                }
+            }
+        }
+        mappedFile.Close();
+
+        SetGroupNames(dataSets, groupNames, filename);
+        info.missing = missing;
+        info.lines = line;
+        info.nthreads = (int) chunks.size();
+        info.writeCache = (follower == 0);
+        return true;
+    }
+
     char dblbuf[128], *p, *bp; //Position, buffer position
     char *buf = new char[lnchars];
+    std::vector<size_t> missing(columns, 0);
     char *ret = NULL;
+    bool eofMarker = false;
+    long dataEnd = dataStart;
+    std::vector<size_t> partialRowLengths;
+    long fileSize = -1;
+    if (progress && dataStart >= 0 && fseek(inFile, 0, SEEK_END) == 0) {
+        fileSize = ftell(inFile);
+        fseek(inFile, dataStart, SEEK_SET);
+    }
     while (true) {
+        if ((line & 4095) == 0) {
+            if (cancel && *cancel)
+                break;
+            long pos = (fileSize > 0) ? ftell(inFile) : -1;
+            if (pos >= 0)
+                progress((size_t) pos, (size_t) fileSize);
+        }
         ret = fgets(buf, lnchars - 1, inFile);
         if (ret == NULL)
             break; //EOF
-        if (buf[0] == 'E' && buf[1] == 'O' && buf[2] == 'F')
+        if (buf[0] == 'E' && buf[1] == 'O' && buf[2] == 'F') {
+            eofMarker = true;
             break;
+        }
+
+        //Remember where the complete lines end, and the data set lengths before an incomplete last line.
+        size_t buflen = strlen(buf);
+        if (buflen > 0 && buf[buflen - 1] == '\n')
+            dataEnd = ftell(inFile);
+        else if (feof(inFile)) {
+            for (size_t i = 0; i < dataSets.size(); i++)
+                partialRowLengths.push_back(dataSets[i]->Length());
+        }
 
         p = buf;
         ncol = 0;
@@ -679,25 +1411,22 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
             while (*p && (*p == ' ' || *p == '\t')) p++; // skip white space
             while (*p && *p != ',' && (CommaDelimiters || (*p != '\t' && *p != ' ')) && ++ndbuf < 127)
                 *bp++ = *p++; // read in number
+            while (bp > dblbuf && (bp[-1] == '\r' || bp[-1] == '\n'))
+                bp--; // the line ending is not part of the last cell
             *bp = '\0'; // terminate string
             if (strlen(dblbuf) > 0) {
-                dataSets[ncol]->Append(
-                        wxRealPoint(timeCounters[ncol], atof(dblbuf))); // convert number and add data point.
-                timeCounters[ncol] += dataSets[ncol]->GetTimeStep();
-            }
-                // in event that data is missing, what to do?  For now, set to 0
-            else {
-                wxString message;
-                message.Printf(
-                        wxT("Column '%s' contains missing data!\nReplacing missing data with 0's, please correct your file"),
-                        dataSets[ncol]->GetSeriesTitle());
-                wxShowTextMessageDialog(message, wxEmptyString, plotWin, wxSize(400, 150));
-                dataSets[ncol]->Append(wxRealPoint(timeCounters[ncol], 0));
-                timeCounters[ncol] += dataSets[ncol]->GetTimeStep();
+                dataSets[ncol]->AppendY(atof(dblbuf)); // convert number and add data point.
+            } else {
+                dataSets[ncol]->AppendY(wxDVTimeSeriesDataSet::MissingValue());
+                missing[ncol]++;
             }
             if (*p) p++; // skip the comma or delimiter
             ncol++;
         }
+        for (; ncol < columns; ncol++) { // a short line
+            dataSets[ncol]->AppendY(wxDVTimeSeriesDataSet::MissingValue());
+            missing[ncol]++;
+        }
         line++;
     }
 
@@ -705,21 +1434,51 @@ wxDVFileReader::FastRead(wxDVPlotCtrl *plotWin, const wxString &filename, int pr
 
     fclose(inFile);
 
+    if (cancel && *cancel) {
+        for (size_t i = 0; i < dataSets.size(); i++)
+            delete dataSets[i];
+        dataSets.clear();
+        return false;
+    }
+
+    if (follower && !eofMarker && dataEnd >= 0) {
+        follower->Stop();
+        follower->m_fileName = filename;
+        follower->m_dataSets = dataSets;
+        follower->m_commaDelimiters = CommaDelimiters;
+        follower->m_offset = dataEnd;
+        follower->m_partialRowLengths = partialRowLengths;
+    } else if (follower) {
+        follower->Stop();
+        follower = 0;
+    }
+
+    SetGroupNames(dataSets, groupNames, filename);
+    info.missing = missing;
+    info.lines = line;
+    info.writeCache = (follower == 0);
+    return true;
+}
+
+bool wxDVFileReader::AddFastReadDataSets(wxDVPlotCtrl *plotWin, const wxString &filename,
+                                         std::vector<wxDVArrayDataSet *> &dataSets,
+                                         int line, int columns, int prealloc_data, unsigned lnchars,
+                                         int nthreads, wxStopWatch &sw, bool writeCache) {
     //Done reading data; add it to the plotCtrl.
 
     plotWin->Freeze();
-    for (size_t i = 0; i < dataSets.size(); i++) {
-        dataSets[i]->SetGroupName(groupNames[i].size() > 1 ? groupNames[i] : wxFileNameFromPath(filename));
-        plotWin->AddDataSet(dataSets[i], (i == dataSets.size() - 1) /* update_ui ? */);
-    }
+    plotWin->AddDataSets(std::vector<wxDVTimeSeriesDataSet *>(dataSets.begin(), dataSets.end()));
     plotWin->GetStatisticsTable()->RebuildDataViewCtrl();    //We must do this only after all datasets have been added
     plotWin->Thaw();
 
+    if (s_useCache && writeCache)
+        wxDVCacheFile::Write(filename, dataSets);
+
     plotWin->ReadState(filename.ToStdString());
 
     wxLogStatus("Read %i lines of data points.\n", line);
-    wxLogDebug("wxDVFileReader::FastRead [ncol=%d nalloc = %d lnchars=%d] = %d msec\n", columns, prealloc_data, lnchars,
-               (int) sw.Time());
+    wxLogDebug("wxDVFileReader::FastRead [ncol=%d nalloc = %d lnchars=%d nthreads=%d] = %d msec\n", columns,
+               prealloc_data, lnchars, nthreads, (int) sw.Time());
     return true;
 }
 
@@ -751,13 +1510,12 @@ void wxDVFileReader::ReadDataFromCSV(wxDVPlotCtrl *plotWin, const wxString &file
             currentLine = currentLine.Right(currentLine.size() - seriesTitle.size() - 1);
     } while (currentLine.size() > 0);
 
-    std::vector<double> timeCounters;
     currentLine = intext.ReadLine(); //Offsets from second line.
     for (size_t i = 0; i < dataSets.size(); i++) {
         wxString offsetStr = currentLine.BeforeFirst(separator);
         double offsetDouble;
         offsetStr.ToDouble(&offsetDouble);
-        timeCounters.push_back(offsetDouble);
+        dataSets[i]->SetOffset(offsetDouble);
         currentLine = currentLine.Right(currentLine.size() - offsetStr.size() - 1);
     }
 
@@ -791,27 +1549,42 @@ void wxDVFileReader::ReadDataFromCSV(wxDVPlotCtrl *plotWin, const wxString &file
                 keepGoing = false;
                 break;
             }
-            dataSets[i]->Append(wxRealPoint(timeCounters[i], dataDouble));
-            timeCounters[i] += dataSets[i]->GetTimeStep();
+            dataSets[i]->AppendY(dataDouble);
             currentLine = currentLine.Right(currentLine.size() - dataStr.size() - 1);
         }
     } while (!infile.Eof() && keepGoing);
 
     //Done reading data; add it to the plotCtrl.
-    for (size_t i = 0; i < dataSets.size(); i++) {
+    for (size_t i = 0; i < dataSets.size(); i++)
         dataSets[i]->SetGroupName(wxFileNameFromPath(filename));
-        plotWin->AddDataSet(dataSets[i], (i == dataSets.size() - 1));
-    }
+    plotWin->AddDataSets(std::vector<wxDVTimeSeriesDataSet *>(dataSets.begin(), dataSets.end()));
     plotWin->GetStatisticsTable()->RebuildDataViewCtrl();    //We must do this only after all datasets have been added
 
     plotWin->ReadState(filename.ToStdString());
 }
 
 bool wxDVFileReader::ReadWeatherFile(wxDVPlotCtrl *plotWin, const wxString &filename) {
+    if (AddCachedDataSets(plotWin, filename))
+        return true;
+
+    std::vector<wxDVArrayDataSet *> dataSets;
+    if (!ReadWeatherDataSets(filename, dataSets))
+        return false;
+
+    return AddWeatherDataSets(plotWin, filename, dataSets);
+}
+
+bool wxDVFileReader::IsWeatherFile(const wxString &filename) {
+    wxString fExtension = filename.Right(3);
+    return fExtension.CmpNoCase("tm2") == 0 || fExtension.CmpNoCase("epw") == 0;
+}
+
+bool wxDVFileReader::ReadWeatherDataSets(const wxString &filename, std::vector<wxDVArrayDataSet *> &dataSets) {
     int wfType = GetWeatherFileType(filename);
+    if (wfType != WF_TM2 && wfType != WF_TM3 && wfType != WF_EPW)
+        return false;
 
     // Set up data sets for all of the variables that are going to be read.
-    std::vector<wxDVArrayDataSet *> dataSets;
     wxDVArrayDataSet *ds = new wxDVArrayDataSet();
     ds->SetSeriesTitle("Global Horizontal");
     ds->SetUnits("Wh/m2");
@@ -862,45 +1635,82 @@ bool wxDVFileReader::ReadWeatherFile(wxDVPlotCtrl *plotWin, const wxString &file
     ds->SetUnits("cm");
     dataSets.push_back(ds);
 
-    for (size_t i = 0; i < dataSets.size(); i++)
+    for (size_t i = 0; i < dataSets.size(); i++) {
         dataSets.at(i)->SetTimeStep(1.0); //All have 1 hr tstep.
-
-    //int year, month, day, hour;
-    //double gh, dn, df, wind, drytemp, dewtemp, relhum, pressure, winddir, snowdepth;
+        dataSets.at(i)->SetOffset(0.5); //Values are plotted at the middle of the hour.
+    }
 
     // Loop over lines in file, reading into data sets array.
-    WFHeader head_info;
-    FILE *wFile;
-    switch (wfType) {
-        case WF_TM2:
-            if (!ParseTM2Header(filename, head_info, &wFile)) { return false; }
-            if (!Read8760WFLines(dataSets, wFile, wfType)) { return false; }
-            break;
-
-        case WF_TM3:
-            if (!ParseTM3Header(filename, head_info, &wFile)) { return false; }
-            if (!Read8760WFLines(dataSets, wFile, wfType)) { return false; }
-            fclose(wFile);
-            break;
-
-        case WF_EPW:
-            if (!ParseEPWHeader(filename, head_info, &wFile)) { return false; }
-            if (!Read8760WFLines(dataSets, wFile, wfType)) { return false; }
+    bool ok = false;
+    wxDVMappedFile map;
+    if (map.Open(filename)) {
+        ok = ReadWeatherRecords(map, wfType, dataSets);
+    } else {
+        WFHeader head_info;
+        FILE *wFile = 0;
+        switch (wfType) {
+            case WF_TM2:
+                ok = ParseTM2Header(filename, head_info, &wFile);
+                break;
+            case WF_TM3:
+                ok = ParseTM3Header(filename, head_info, &wFile);
+                break;
+            case WF_EPW:
+                ok = ParseEPWHeader(filename, head_info, &wFile);
+                break;
+        }
+        if (ok)
+            ok = Read8760WFLines(dataSets, wFile, wfType);
+        if (wFile)
             fclose(wFile);
-            break;
+    }
 
-        case WF_ERR:
-        default:
-            return false;
+    if (!ok) {
+        for (size_t i = 0; i < dataSets.size(); i++)
+            delete dataSets[i];
+        dataSets.clear();
     }
+    return ok;
+}
+
+void wxDVFileReader::ReadWeatherFiles(const wxArrayString &filenames,
+                                      std::vector<std::vector<wxDVArrayDataSet *> > &dataSets) {
+    dataSets.assign(filenames.GetCount(), std::vector<wxDVArrayDataSet *>());
+
+    size_t nthreads = std::thread::hardware_concurrency();
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > filenames.GetCount()) nthreads = filenames.GetCount();
+
+    // each worker takes the next file that nobody has started on
+    std::atomic<size_t> next(0);
+    auto read = [&]() {
+        size_t i;
+        while ((i = next++) < filenames.GetCount())
+            ReadWeatherDataSets(filenames[i], dataSets[i]);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < nthreads; t++)
+        workers.push_back(std::thread(read));
+    read();
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+bool wxDVFileReader::AddWeatherDataSets(wxDVPlotCtrl *plotWin, const wxString &filename,
+                                        std::vector<wxDVArrayDataSet *> &dataSets) {
+    if (dataSets.size() == 0)
+        return false;
 
     //Done reading data; add it to the plotCtrl.
-    for (size_t i = 0; i < dataSets.size(); i++) {
+    for (size_t i = 0; i < dataSets.size(); i++)
         dataSets[i]->SetGroupName(wxFileNameFromPath(filename));
-        plotWin->AddDataSet(dataSets[i], (i == dataSets.size() - 1));
-    }
+    plotWin->AddDataSets(std::vector<wxDVTimeSeriesDataSet *>(dataSets.begin(), dataSets.end()));
     plotWin->GetStatisticsTable()->RebuildDataViewCtrl();    //We must do this only after all datasets have been added
 
+    if (s_useCache)
+        wxDVCacheFile::Write(filename, dataSets);
+
     plotWin->ReadState(filename.ToStdString());
 
     return true;
@@ -916,23 +1726,258 @@ bool wxDVFileReader::Read8760WFLines(std::vector<wxDVArrayDataSet *> &dataSets,
             return false;
         }
 
-        double hr = ((double) i) + 0.5;
-
-        dataSets[0]->Append(wxRealPoint(hr, gh));
-        dataSets[1]->Append(wxRealPoint(hr, dn));
-        dataSets[2]->Append(wxRealPoint(hr, df));
-        dataSets[3]->Append(wxRealPoint(hr, wind));
-        dataSets[4]->Append(wxRealPoint(hr, drytemp));
-        dataSets[5]->Append(wxRealPoint(hr, dewtemp));
-        dataSets[6]->Append(wxRealPoint(hr, relhum));
-        dataSets[7]->Append(wxRealPoint(hr, pressure));
-        dataSets[8]->Append(wxRealPoint(hr, winddir));
-        dataSets[9]->Append(wxRealPoint(hr, snowdepth));
+        dataSets[0]->AppendY(gh);
+        dataSets[1]->AppendY(dn);
+        dataSets[2]->AppendY(df);
+        dataSets[3]->AppendY(wind);
+        dataSets[4]->AppendY(drytemp);
+        dataSets[5]->AppendY(dewtemp);
+        dataSets[6]->AppendY(relhum);
+        dataSets[7]->AppendY(pressure);
+        dataSets[8]->AppendY(winddir);
+        dataSets[9]->AppendY(snowdepth);
     }
 
     return true;
 }
 
+// A report variable and environment period read from an EnergyPlus SQL file.
+struct DataDictionaryItem {
+    int recordIndex;
+    int envPeriodIndex;
+    std::string name;
+    std::string keyValue;
+    std::string envPeriod;
+    std::string reportingFrequency;
+    std::string units;
+    std::string table;
+    unsigned intervalMinutes;
+    std::vector<wxDateTime> dateTimes;
+    std::vector<size_t> gridIndex; // minute of each HVAC system timestep sample
+    std::vector<double> stdValues;
+
+    DataDictionaryItem(int recordIndex_, int envPeriodIndex_, std::string name_, std::string keyValue_,
+                       std::string envPeriod_, std::string reportingFrequency_, std::string units_,
+                       std::string table_) : recordIndex(recordIndex_), envPeriodIndex(envPeriodIndex_),
+                                             name(name_), keyValue(keyValue_), envPeriod(envPeriod_),
+                                             reportingFrequency(reportingFrequency_), units(units_),
+                                             table(table_), intervalMinutes(0) {}
+};
+
+// The columns of a row of the EnergyPlus Time table that ReadSQLFile needs.
+struct SQLTimeRow {
+    int envPeriodIndex;
+    unsigned month, day, hour, minute, interval;
+};
+
+// Reads the Time table into a vector indexed by TimeIndex; rows that don't exist have envPeriodIndex -1.
+static void ReadSQLTimes(sqlite3 *db, std::vector<SQLTimeRow> &times) {
+    sqlite3_stmt *sqlStmtPtr;
+    if (sqlite3_prepare_v2(db, "SELECT TimeIndex, Month, Day, Hour, Minute, Interval, EnvironmentPeriodIndex FROM Time",
+                           -1, &sqlStmtPtr, nullptr) != SQLITE_OK)
+        return;
+
+    SQLTimeRow none = {-1, 0, 0, 0, 0, 0};
+    while (sqlite3_step(sqlStmtPtr) == SQLITE_ROW) {
+        int timeIndex = sqlite3_column_int(sqlStmtPtr, 0);
+        if (timeIndex < 0) continue;
+        if ((size_t) timeIndex >= times.size())
+            times.resize(timeIndex + 1, none);
+
+        SQLTimeRow &t = times[timeIndex];
+        t.month = sqlite3_column_int(sqlStmtPtr, 1);
+        t.day = sqlite3_column_int(sqlStmtPtr, 2);
+        t.hour = sqlite3_column_int(sqlStmtPtr, 3);
+        t.minute = sqlite3_column_int(sqlStmtPtr, 4);
+        t.interval = sqlite3_column_int(sqlStmtPtr, 5); // used for run periods
+        t.envPeriodIndex = sqlite3_column_int(sqlStmtPtr, 6);
+    }
+    sqlite3_finalize(sqlStmtPtr);
+}
+
+// Adds one reported value at time t to item.
+static void AddSQLValue(DataDictionaryItem &item, double value, const SQLTimeRow &t) {
+    unsigned month = t.month;
+    unsigned day = t.day;
+    unsigned hour = t.hour;
+    unsigned minute = t.minute;
+    unsigned intervalMinutes = t.interval;
+
+    if (item.stdValues.empty()) {
+        item.intervalMinutes = intervalMinutes;
+    }
+    item.stdValues.push_back(value);
+
+    if (item.reportingFrequency == "HVAC System Timestep") {
+        wxDateTime dateTime;
+
+        // E+ uses months 1 - 12; wxWidget Month is an enum 0 - 11
+        --month;
+
+        if (hour == 24) {
+            // EnergyPlus deals in a 00:00:01 -> 24:00:00 instead of
+            // 00:00:00 -> 23:59:59 hrs that the real world uses, so
+            // we are going to adjust for that
+
+            // For E+ hour = 24, we know E+ minutes must = 0
+            assert(minute == 0);
+
+            // Rather than 24:00:00, we want 23:59:59
+            dateTime = wxDateTime(day, wxDateTime::Month(month), wxDateTime::Inv_Year, 23, 59, 59, 999);
+        } else {
+            dateTime = wxDateTime(day, wxDateTime::Month(month), wxDateTime::Inv_Year, hour, minute);
+        }
+        item.dateTimes.push_back(dateTime);
+    }
+
+    // Check for varying intervals when they should remain constant
+    if (item.reportingFrequency != "HVAC System Timestep" &&
+        item.reportingFrequency != "Monthly" &&
+        intervalMinutes != item.intervalMinutes) {
+        assert(false);
+    }
+
+    //	intervalMinutes notes:
+    //	1 : 1 / 60 hour
+    //	10 : 1 / 6 hour
+    //	15 : 1 / 4 hour
+    //	60 : 1 hour
+    //	1440 : 24 hours
+    //	40320 : 28 days
+    //	41760 : 29 days ***** leap year if month == 2 *****
+    //	43200 : 30 days
+    //	44640 : 31 days
+}
+
+// A value of a data table row and the row's TimeIndex.
+struct SQLSample {
+    double value;
+    int timeIndex;
+};
+
+// The rows of a data table with rowid in [first, last], read by one worker and kept per dictionary item.
+struct SQLScanPartition {
+    sqlite3_int64 first, last;
+    std::vector<std::vector<SQLSample> > samples;
+    bool ok;
+};
+
+// Streams the rows of part in the order they were written, routing each value to the dictionary item
+// of its variable and environment period.
+static bool ScanSQLDataRows(sqlite3 *db, const std::string &sql, const std::vector<std::vector<size_t> > &routes,
+                            const std::vector<SQLTimeRow> &times,
+                            const std::vector<DataDictionaryItem> &dataDictionary, SQLScanPartition &part) {
+    sqlite3_stmt *sqlStmtPtr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &sqlStmtPtr, nullptr) != SQLITE_OK)
+        return false;
+    sqlite3_bind_int64(sqlStmtPtr, 1, part.first);
+    sqlite3_bind_int64(sqlStmtPtr, 2, part.last);
+
+    part.samples.assign(dataDictionary.size(), std::vector<SQLSample>());
+    int code;
+    while ((code = sqlite3_step(sqlStmtPtr)) == SQLITE_ROW) {
+        int dictionaryIndex = sqlite3_column_int(sqlStmtPtr, 0);
+        int timeIndex = sqlite3_column_int(sqlStmtPtr, 1);
+        if (dictionaryIndex < 0 || (size_t) dictionaryIndex >= routes.size()
+            || timeIndex < 0 || (size_t) timeIndex >= times.size())
+            continue;
+
+        const std::vector<size_t> &items = routes[dictionaryIndex];
+        for (size_t k = 0; k < items.size(); k++) {
+            if (dataDictionary[items[k]].envPeriodIndex == times[timeIndex].envPeriodIndex) {
+                SQLSample sample = {sqlite3_column_double(sqlStmtPtr, 2), timeIndex};
+                part.samples[items[k]].push_back(sample);
+                break;
+            }
+        }
+    }
+
+    // must finalize to prevent memory leaks
+    sqlite3_finalize(sqlStmtPtr);
+    return code == SQLITE_DONE;
+}
+
+static void ScanSQLPartition(const std::string &filename, const std::string &sql,
+                             const std::vector<std::vector<size_t> > &routes, const std::vector<SQLTimeRow> &times,
+                             const std::vector<DataDictionaryItem> &dataDictionary, SQLScanPartition *part) {
+    sqlite3 *db = 0;
+    part->ok = sqlite3_open_v2(filename.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) == SQLITE_OK
+               && ScanSQLDataRows(db, sql, routes, times, dataDictionary, *part);
+    sqlite3_close(db);
+}
+
+// Reads a data table in one pass, split by rowid over workers that each have their own read-only
+// connection, and appends the samples of each dictionary item to samples[item] in the order written.
+static void ReadSQLDataTable(sqlite3 *db, const std::string &filename, const std::string &table,
+                             const std::vector<SQLTimeRow> &times,
+                             const std::vector<DataDictionaryItem> &dataDictionary,
+                             std::vector<std::vector<SQLSample> > &samples) {
+    // items by dictionary index, then environment period
+    std::vector<std::vector<size_t> > routes;
+    for (size_t i = 0; i < dataDictionary.size(); i++) {
+        if (dataDictionary[i].table != table || dataDictionary[i].recordIndex < 0) continue;
+        if ((size_t) dataDictionary[i].recordIndex >= routes.size())
+            routes.resize(dataDictionary[i].recordIndex + 1);
+        routes[dataDictionary[i].recordIndex].push_back(i);
+    }
+
+    std::string indexColumn = (table == "ReportMeterData") ? "ReportMeterDataDictionaryIndex"
+                                                           : "ReportVariableDataDictionaryIndex";
+    std::string sql = "SELECT " + indexColumn + ", TimeIndex, VariableValue FROM " + table
+                      + " WHERE rowid BETWEEN ? AND ? ORDER BY rowid";
+
+    sqlite3_int64 minRow = 0, maxRow = -1;
+    sqlite3_stmt *sqlStmtPtr;
+    std::string rangeSql = "SELECT MIN(rowid), MAX(rowid) FROM " + table;
+    if (sqlite3_prepare_v2(db, rangeSql.c_str(), -1, &sqlStmtPtr, nullptr) != SQLITE_OK)
+        return;
+    if (sqlite3_step(sqlStmtPtr) == SQLITE_ROW && sqlite3_column_type(sqlStmtPtr, 0) != SQLITE_NULL) {
+        minRow = sqlite3_column_int64(sqlStmtPtr, 0);
+        maxRow = sqlite3_column_int64(sqlStmtPtr, 1);
+    }
+    sqlite3_finalize(sqlStmtPtr);
+    if (maxRow < minRow)
+        return;
+
+    // About 256k rows per worker at least; without a thread safe sqlite everything stays on this connection.
+    size_t nthreads = sqlite3_threadsafe() ? std::thread::hardware_concurrency() : 1;
+    if (nthreads < 1) nthreads = 1;
+    nthreads = (size_t) std::min((sqlite3_int64) nthreads, (maxRow - minRow) / (256 * 1024) + 1);
+
+    std::vector<SQLScanPartition> parts(nthreads);
+    sqlite3_int64 span = (maxRow - minRow) / (sqlite3_int64) nthreads + 1;
+    for (size_t t = 0; t < nthreads; t++) {
+        parts[t].first = minRow + span * (sqlite3_int64) t;
+        parts[t].last = (t + 1 < nthreads) ? parts[t].first + span - 1 : maxRow;
+        parts[t].ok = false;
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < nthreads; t++)
+        workers.push_back(std::thread(ScanSQLPartition, filename, sql, std::cref(routes), std::cref(times),
+                                      std::cref(dataDictionary), &parts[t]));
+    parts[0].ok = ScanSQLDataRows(db, sql, routes, times, dataDictionary, parts[0]);
+    for (size_t k = 0; k < workers.size(); k++)
+        workers[k].join();
+
+    // A worker that could not open its own connection is redone here; then merge in rowid order.
+    for (size_t t = 0; t < nthreads; t++) {
+        if (!parts[t].ok)
+            ScanSQLDataRows(db, sql, routes, times, dataDictionary, parts[t]);
+    }
+    samples.resize(dataDictionary.size());
+    for (size_t i = 0; i < dataDictionary.size(); i++) {
+        for (size_t t = 0; t < nthreads; t++) {
+            std::vector<SQLSample> &part = parts[t].samples[i];
+            if (samples[i].empty())
+                samples[i].swap(part);
+            else
+                samples[i].insert(samples[i].end(), part.begin(), part.end());
+            std::vector<SQLSample>().swap(part);
+        }
+    }
+}
+
 bool wxDVFileReader::ReadSQLFile(wxDVPlotCtrl *plotWin, const wxString &filename) {
     wxFileName fileName(filename);
 
@@ -948,30 +1993,15 @@ bool wxDVFileReader::ReadSQLFile(wxDVPlotCtrl *plotWin, const wxString &filename
         int convertUnits = wxMessageBox(wxT("Would you like to display your Energy+ data in IP units?."),
                                         wxT("Units Conversion"), wxYES_NO);
 
+        // the units choice changes the stored values, so it selects the cache variant
+        if (AddCachedDataSets(plotWin, filename, convertUnits == wxYES ? "IP" : "SI")) {
+            sqlite3_close(db);
+            return true;
+        }
+
         wxStopWatch sw;
         sw.Start();
 
-        struct DataDictionaryItem {
-            int recordIndex;
-            int envPeriodIndex;
-            std::string name;
-            std::string keyValue;
-            std::string envPeriod;
-            std::string reportingFrequency;
-            std::string units;
-            std::string table;
-            unsigned intervalMinutes;
-            std::vector<wxDateTime> dateTimes;
-            std::vector<double> stdValues;
-
-            DataDictionaryItem(int recordIndex_, int envPeriodIndex_, std::string name_, std::string keyValue_,
-                               std::string envPeriod_, std::string reportingFrequency_, std::string units_,
-                               std::string table_) : recordIndex(recordIndex_), envPeriodIndex(envPeriodIndex_),
-                                                     name(name_), keyValue(keyValue_), envPeriod(envPeriod_),
-                                                     reportingFrequency(reportingFrequency_), units(units_),
-                                                     table(table_) {}
-        };
-
         std::vector<DataDictionaryItem> dataDictionary;
 
         if (db) {
@@ -1047,146 +2077,70 @@ bool wxDVFileReader::ReadSQLFile(wxDVPlotCtrl *plotWin, const wxString &filename
             sqlite3_finalize(sqlStmtPtr);
         }
 
-        for (size_t i = 0; i < dataDictionary.size(); i++) {
-            wxString recordIndexString = wxString::Format(wxT("%d"), (int) dataDictionary[i].recordIndex);
-            wxString envPeriodIndexString = wxString::Format(wxT("%d"), (int) dataDictionary[i].envPeriodIndex);
+        // Read each data table in one pass rather than querying every variable and environment period.
+        std::vector<SQLTimeRow> times;
+        std::vector<std::vector<SQLSample> > samples(dataDictionary.size());
+        if (db) {
+            ReadSQLTimes(db, times);
 
-            std::stringstream s;
-            s << "SELECT dt.VariableValue, Time.Month, Time.Day, Time.Hour, Time.Minute, Time.Interval FROM ";
-            s << dataDictionary[i].table;
-            s << " dt INNER JOIN Time ON Time.timeIndex = dt.TimeIndex";
-            s << " WHERE ";
-            if (dataDictionary[i].table == "ReportMeterData") {
-                s << " dt.ReportMeterDataDictionaryIndex=";
-            } else if (dataDictionary[i].table == "ReportVariableData") {
-                s << " dt.ReportVariableDataDictionaryIndex=";
+            std::vector<std::string> tables;
+            for (size_t i = 0; i < dataDictionary.size(); i++) {
+                if (std::find(tables.begin(), tables.end(), dataDictionary[i].table) == tables.end())
+                    tables.push_back(dataDictionary[i].table);
             }
-            s << recordIndexString;
-            s << " AND Time.EnvironmentPeriodIndex = ";
-            s << envPeriodIndexString;
-
-            sqlite3_stmt *sqlStmtPtr;
-
-            int code = sqlite3_prepare_v2(db, s.str().c_str(), -1, &sqlStmtPtr, nullptr);
-
-            code = sqlite3_step(sqlStmtPtr);
-            std::stringstream s2;
-            s2 << "SQL Query:" << std::endl;
-            s2 << s.str();
-            s2 << "Return Code:" << std::endl;
-            s2 << code;
-
-            //long cumulativeSeconds = 0;
-
-            std::vector<double> stdValues;
-            stdValues.reserve(8760);
-
-            int counter = 0;
-
-            while (code == SQLITE_ROW) {
-                double value = sqlite3_column_double(sqlStmtPtr, 0);
-                stdValues.push_back(value);
-
-                unsigned month = sqlite3_column_int(sqlStmtPtr, 1);
-                unsigned day = sqlite3_column_int(sqlStmtPtr, 2);
-                unsigned hour = sqlite3_column_int(sqlStmtPtr, 3);
-                unsigned minute = sqlite3_column_int(sqlStmtPtr, 4);
-                unsigned intervalMinutes = sqlite3_column_int(sqlStmtPtr, 5); // used for run periods
-
-                if (counter++ == 0) {
-                    dataDictionary[i].intervalMinutes = intervalMinutes;
-                }
-
-                if (dataDictionary[i].reportingFrequency == "HVAC System Timestep") {
-                    wxDateTime dateTime;
-
-                    // E+ uses months 1 - 12; wxWidget Month is an enum 0 - 11
-                    --month;
-
-                    if (hour == 24) {
-                        // EnergyPlus deals in a 00:00:01 -> 24:00:00 instead of
-                        // 00:00:00 -> 23:59:59 hrs that the real world uses, so
-                        // we are going to adjust for that
-
-                        // For E+ hour = 24, we know E+ minutes must = 0
-                        assert(minute == 0);
-
-                        // Rather than 24:00:00, we want 23:59:59
-                        dateTime = wxDateTime(day, wxDateTime::Month(month), wxDateTime::Inv_Year, 23, 59, 59, 999);
-                    } else {
-                        dateTime = wxDateTime(day, wxDateTime::Month(month), wxDateTime::Inv_Year, hour, minute);
-                    }
-                    dataDictionary[i].dateTimes.push_back(dateTime);
-                }
+            for (size_t k = 0; k < tables.size(); k++)
+                ReadSQLDataTable(db, filename.ToStdString(), tables[k], times, dataDictionary, samples);
+        }
+        sqlite3_close(db);
 
-                // Check for varying intervals when they should remain constant
-                if (dataDictionary[i].reportingFrequency != "HVAC System Timestep" &&
-                    dataDictionary[i].reportingFrequency != "Monthly" &&
-                    intervalMinutes != dataDictionary[i].intervalMinutes) {
-                    assert(false);
+        // Decode partitions of the data dictionary in parallel: date/times, unit conversion and interpolation.
+        bool convertToIP = convertUnits == wxYES;
+        if (convertToIP && m_unitConversions.size() == 0)
+            InitUnitConversions();
+
+        size_t nthreads = std::thread::hardware_concurrency();
+        if (nthreads < 1) nthreads = 1;
+        nthreads = std::min(nthreads, dataDictionary.size() / 8 + 1);
+
+        std::vector<wxString> failedUnits(nthreads);
+        auto decode = [&](size_t t) {
+            for (size_t i = dataDictionary.size() * t / nthreads; i < dataDictionary.size() * (t + 1) / nthreads; i++) {
+                DataDictionaryItem &item = dataDictionary[i];
+                item.stdValues.reserve(samples[i].size());
+                for (size_t k = 0; k < samples[i].size(); k++)
+                    AddSQLValue(item, samples[i][k].value, times[samples[i][k].timeIndex]);
+                std::vector<SQLSample>().swap(samples[i]);
+
+                if (convertToIP && item.units.length())
+                    ConvertUnits(item.units, item.stdValues, true, &failedUnits[t]);
+
+                // Note: variable frequency, use 1 minute timestep (E+ minimum); "missing" data is interpolated on demand
+                if (item.reportingFrequency == "HVAC System Timestep") {
+                    NonuniformTimestepGrid(item.dateTimes, item.gridIndex);
+                    std::vector<wxDateTime>().swap(item.dateTimes);
                 }
-
-                //	intervalMinutes notes:
-                //	1 : 1 / 60 hour
-                //	10 : 1 / 6 hour
-                //	15 : 1 / 4 hour
-                //	60 : 1 hour
-                //	1440 : 24 hours
-                //	40320 : 28 days
-                //	41760 : 29 days ***** leap year if month == 2 *****
-                //	43200 : 30 days
-                //	44640 : 31 days
-
-                //if (!firstReportDateTime){
-                //	if ((month == 0) || (day == 0)){
-                //		// gets called for RunPeriod reports
-                //		firstReportDateTime = lastDateTime(false, dataDictionary.envPeriodIndex);
-                //	}
-                //	else{
-                //		// DLM: potential leap year problem
-                //		// DLM: get standard time zone?
-                //		if (intervalMinutes >= 24 * 60){
-                //			// Daily or Monthly
-                //			OS_ASSERT(intervalMinutes % (24 * 60) == 0);
-                //			firstReportDateTime = openstudio::DateTime(openstudio::Date(month, day), openstudio::Time(1, 0, 0, 0));
-                //		}
-                //		else {
-                //			firstReportDateTime = openstudio::DateTime(openstudio::Date(month, day), openstudio::Time(0, 0, intervalMinutes, 0));
-                //		}
-                //	}
-                //}
-
-                //// Use the new way to create the time series with nonzero first entry
-                //cumulativeSeconds += 60 * intervalMinutes;
-                //stdSecondsFromFirstReport.push_back(cumulativeSeconds);
-
-                //// check if this interval is same as the others
-                //if (isIntervalTimeSeries && !reportingIntervalMinutes){
-                //	reportingIntervalMinutes = intervalMinutes;
-                //}
-                //else if (reportingIntervalMinutes && (reportingIntervalMinutes.get() != intervalMinutes)){
-                //	isIntervalTimeSeries = false;
-                //	reportingIntervalMinutes.reset();
-                //}
-
-                // step to next row
-                code = sqlite3_step(sqlStmtPtr);
-            }
-
-            if (convertUnits == 2 && dataDictionary[i].units.length()) {
-                ConvertUnits(dataDictionary[i].units, stdValues);
             }
+        };
 
-            dataDictionary[i].stdValues = stdValues;
-
-            // must finalize to prevent memory leaks
-            sqlite3_finalize(sqlStmtPtr);
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < nthreads; t++)
+            workers.push_back(std::thread(decode, t));
+        decode(0);
+        for (size_t k = 0; k < workers.size(); k++)
+            workers[k].join();
+
+        wxString errors;
+        for (size_t t = 0; t < nthreads; t++)
+            errors += failedUnits[t];
+        if (errors.size() > 0) {
+            errors.RemoveLast(2); // remove last ", "
+            wxMessageBox("The following units failed to be converted: " + errors, wxT("Units Conversion Error"),
+                         wxICON_INFORMATION);
         }
 
         // Transfer from dataDictionary into DView
         std::vector<wxDVArrayDataSet *> dataSets;
         std::vector<wxString> groupNames;
-        std::vector<double> timeCounters;
 
         for (size_t i = 0; i < dataDictionary.size(); i++) {
             double timeStep = 1;
@@ -1204,8 +2158,7 @@ bool wxDVFileReader::ReadSQLFile(wxDVPlotCtrl *plotWin, const wxString &filename
                 // Shouldn't be here
                 assert(false);
             } else if (dataDictionary[i].reportingFrequency == "HVAC System Timestep") {
-                // Note: variable frequency, use 1 minute timestep (E+ minimum) and add "missing" data via interpolation;
-                NonuniformTimestepInterpolation(dataDictionary[i].dateTimes, dataDictionary[i].stdValues);
+                // Note: variable frequency, resampled to a 1 minute timestep (E+ minimum)
                 timeStep = (double) 1.0 / 60.0;
             } else if (dataDictionary[i].reportingFrequency == "Timestep" ||
                        dataDictionary[i].reportingFrequency == "Zone Timestep") {
@@ -1221,32 +2174,37 @@ bool wxDVFileReader::ReadSQLFile(wxDVPlotCtrl *plotWin, const wxString &filename
                 assert(false);
             }
 
-            wxDVArrayDataSet *ds = new wxDVArrayDataSet();
-            ds->SetSeriesTitle(dataDictionary[i].keyValue);
-            ds->SetTimeStep(timeStep);
-            ds->SetUnits(dataDictionary[i].units);
+            wxDVArrayDataSet *ds;
+            if (dataDictionary[i].reportingFrequency == "HVAC System Timestep") {
+                // E+ reports at the end of each interval
+                ds = new wxDVResampledDataSet(dataDictionary[i].keyValue, dataDictionary[i].units, timeStep, timeStep,
+                                              dataDictionary[i].gridIndex, dataDictionary[i].stdValues);
+            } else {
+                ds = new wxDVArrayDataSet();
+                ds->SetSeriesTitle(dataDictionary[i].keyValue);
+                ds->SetTimeStep(timeStep);
+                ds->SetOffset(timeStep); // E+ reports at the end of each interval
+                ds->SetUnits(dataDictionary[i].units);
+                ds->Copy(dataDictionary[i].stdValues);
+            }
+            std::vector<size_t>().swap(dataDictionary[i].gridIndex);
+            std::vector<double>().swap(dataDictionary[i].stdValues);
             dataSets.push_back(ds);
 
-            timeCounters.push_back(timeStep);
-
             groupNames.push_back(dataDictionary[i].name);
-
-            for (size_t j = 0; j < dataDictionary[i].stdValues.size(); j++) {
-                dataSets[i]->Append(wxRealPoint(timeCounters[i],
-                                                dataDictionary[i].stdValues[j])); // convert number and add data point.
-                timeCounters[i] += dataSets[i]->GetTimeStep(); // convert number and add data point.
-            }
         }
 
         // Done reading data; add it to the plotCtrl.
         plotWin->Freeze();
-        for (size_t i = 0; i < dataSets.size(); i++) {
+        for (size_t i = 0; i < dataSets.size(); i++)
             dataSets[i]->SetGroupName(groupNames[i].size() > 1 ? groupNames[i] : wxFileNameFromPath(filename));
-            plotWin->AddDataSet(dataSets[i], (i == dataSets.size() - 1) /* update_ui ? */);
-        }
+        plotWin->AddDataSets(std::vector<wxDVTimeSeriesDataSet *>(dataSets.begin(), dataSets.end()));
         plotWin->GetStatisticsTable()->RebuildDataViewCtrl();    //We must do this only after all datasets have been added
         plotWin->Thaw();
 
+        if (s_useCache)
+            wxDVCacheFile::Write(filename, dataSets, convertUnits == wxYES ? "IP" : "SI");
+
         plotWin->ReadState(filename.ToStdString());
 
         //wxLogStatus("Read %i lines of data points.\n", line);
@@ -1265,15 +2223,13 @@ bool wxDVFileReader::ReadSQLFile(wxDVPlotCtrl *plotWin, const wxString &filename
     }
 }
 
-void
-wxDVFileReader::NonuniformTimestepInterpolation(const std::vector<wxDateTime> &times, std::vector<double> &values) {
-    assert(times.size() == values.size());
-
-    std::vector<double> valuesByMinute;
-
-    wxTimeSpan timeSpan = times.at(times.size() - 1) - times.at(0);
+void wxDVFileReader::NonuniformTimestepGrid(const std::vector<wxDateTime> &times, std::vector<size_t> &gridIndex) {
+    gridIndex.assign(times.size(), 0);
 
+    wxTimeSpan timeSpan;
     for (size_t i = 1; i < times.size(); i++) {
+        gridIndex[i] = gridIndex[i - 1];
+
         timeSpan = times[i] - times[i - 1];
         wxLongLong intervalInSeconds = timeSpan.GetSeconds();
         int interval = static_cast<int>(intervalInSeconds.ToDouble()) / 60;
@@ -1297,17 +2253,8 @@ wxDVFileReader::NonuniformTimestepInterpolation(const std::vector<wxDateTime> &t
             continue;
         }
 
-        double valueDeltaPerMinute = (values[i] - values[i - 1]) / interval;
-        for (int j = 0; j < interval; j++) {
-            double value = values.at(i - 1) + valueDeltaPerMinute * j;
-            valuesByMinute.push_back(value);
-        }
+        gridIndex[i] += interval;
     }
-
-    //int size = valuesByMinute.size();
-    //assert(valuesByMinute.size() == static_cast<unsigned>(expectedVectorLength));
-
-    values = valuesByMinute;
 }
 
 bool wxDVFileReader::IsEnergyPlus(sqlite3 *db) {
@@ -1406,6 +2353,104 @@ bool wxDVFileReader::IsDate(wxString stringToCheck) {
     return true;
 }
 
+double wxDVFileReader::ParseDouble(const char *p, const char *end, const char **stop) {
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *start = p;
+
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    // accumulate up to 19 significant digits exactly; further digits only scale the exponent
+    unsigned long long mantissa = 0;
+    int nsig = 0, exponent = 0;
+    bool digits = false;
+    while (p < end && *p >= '0' && *p <= '9') {
+        digits = true;
+        if (nsig < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) nsig++;
+        } else
+            exponent++;
+        p++;
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            digits = true;
+            if (nsig < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa != 0) nsig++;
+                exponent--;
+            }
+            p++;
+        }
+    }
+
+    if (!digits) {
+        // atof() also accepts inf and nan
+        if (end - p >= 3 && (p[0] == 'i' || p[0] == 'I') && (p[1] == 'n' || p[1] == 'N') && (p[2] == 'f' || p[2] == 'F')) {
+            if (stop) *stop = p + 3;
+            return negative ? -HUGE_VAL : HUGE_VAL;
+        }
+        if (end - p >= 3 && (p[0] == 'n' || p[0] == 'N') && (p[1] == 'a' || p[1] == 'A') && (p[2] == 'n' || p[2] == 'N')) {
+            if (stop) *stop = p + 3;
+            return NAN;
+        }
+        if (stop) *stop = start;
+        return 0.0;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool negexp = false;
+        if (q < end && (*q == '+' || *q == '-')) {
+            negexp = (*q == '-');
+            q++;
+        }
+        if (q < end && *q >= '0' && *q <= '9') {
+            int e = 0;
+            while (q < end && *q >= '0' && *q <= '9') {
+                if (e < 10000) e = e * 10 + (*q - '0');
+                q++;
+            }
+            exponent += negexp ? -e : e;
+            p = q;
+        }
+    }
+
+    if (stop) *stop = p;
+
+    double value = (double) mantissa;
+    if (mantissa == 0)
+        value = 0.0;
+    else if (exponent >= 0 && exponent <= 22 && mantissa < (1ULL << 53))
+        value *= pow10[exponent]; // both operands exact, so the result is correctly rounded
+    else if (exponent < 0 && exponent >= -22 && mantissa < (1ULL << 53))
+        value /= pow10[-exponent];
+    else {
+        // rare case: let strtod round it, with the decimal point swapped for the locale's own
+        char buf[64];
+        size_t len = std::min((size_t) (p - start), sizeof(buf) - 1);
+        memcpy(buf, start, len);
+        buf[len] = '\0';
+        const char *point = localeconv()->decimal_point;
+        if (point && point[0] != '.' && point[0] != '\0') {
+            char *dot = strchr(buf, '.');
+            if (dot) *dot = point[0];
+        }
+        return strtod(buf, NULL);
+    }
+
+    return negative ? -value : value;
+}
+
 // Conversion factors from Energy+.idd
 void wxDVFileReader::InitUnitConversions() {
     // NOTE: tuple format (SI unit string, IP unit string, SI to IP conversion factor)
@@ -1536,6 +2581,20 @@ void wxDVFileReader::InitUnitConversions() {
 }
 
 bool wxDVFileReader::ConvertUnits(std::string &units, std::vector<double> &values, bool convertSIToIP) {
+    wxString errors;
+    bool success = ConvertUnits(units, values, convertSIToIP, &errors);
+
+    if (errors.size() > 0) {
+        errors.RemoveLast(2); // remove last ", "
+        wxMessageBox("The following units failed to be converted: " + errors, wxT("Units Conversion Error"),
+                     wxICON_INFORMATION);
+    }
+
+    return success;
+}
+
+bool wxDVFileReader::ConvertUnits(std::string &units, std::vector<double> &values, bool convertSIToIP,
+                                  wxString *failedUnits) {
     if (m_unitConversions.size() == 0) {
         InitUnitConversions();
     }
@@ -1547,8 +2606,7 @@ bool wxDVFileReader::ConvertUnits(std::string &units, std::vector<double> &value
     std::string::iterator end_pos = std::remove(units.begin(), units.end(), ' ');
     units.erase(end_pos, units.end());
 
-    wxString errors("The following units failed to be converted: ");
-    unsigned startSize = errors.size();
+    wxString &errors = *failedUnits;
 
     if (convertSIToIP) {
         auto it = find_if(begin(m_unitConversions), end(m_unitConversions),
@@ -1595,10 +2653,5 @@ bool wxDVFileReader::ConvertUnits(std::string &units, std::vector<double> &value
         }
     }
 
-    if (errors.size() > startSize) {
-        errors.RemoveLast(2); // remove last ", "
-        wxMessageBox(errors, wxT("Units Conversion Error"), wxICON_INFORMATION);
-    }
-
     return success;
 }
@@ -0,0 +1,129 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef __WXMSW__
+#include <wx/msw/wrapwin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "wex/dview/dvmappedfile.h"
+
+wxDVMappedFile::wxDVMappedFile()
+        : m_data(0), m_size(0) {
+#ifdef __WXMSW__
+    m_fileHandle = INVALID_HANDLE_VALUE;
+    m_mapHandle = 0;
+#else
+    m_fd = -1;
+#endif
+}
+
+wxDVMappedFile::~wxDVMappedFile() {
+    Close();
+}
+
+bool wxDVMappedFile::Open(const wxString &filename) {
+    Close();
+
+#ifdef __WXMSW__
+    m_fileHandle = ::CreateFileW(filename.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                 OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(m_fileHandle, &size) || size.QuadPart == 0) {
+        Close();
+        return false;
+    }
+
+    m_mapHandle = ::CreateFileMappingW(m_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapHandle == 0) {
+        Close();
+        return false;
+    }
+
+    m_data = (const char *) ::MapViewOfFile(m_mapHandle, FILE_MAP_READ, 0, 0, 0);
+    if (m_data == 0) {
+        Close();
+        return false;
+    }
+    m_size = (size_t) size.QuadPart;
+#else
+    m_fd = ::open(filename.fn_str(), O_RDONLY);
+    if (m_fd < 0)
+        return false;
+
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0 || st.st_size == 0) {
+        Close();
+        return false;
+    }
+
+    void *addr = ::mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (addr == MAP_FAILED) {
+        Close();
+        return false;
+    }
+    ::madvise(addr, (size_t) st.st_size, MADV_SEQUENTIAL);
+
+    m_data = (const char *) addr;
+    m_size = (size_t) st.st_size;
+#endif
+
+    return true;
+}
+
+void wxDVMappedFile::Close() {
+#ifdef __WXMSW__
+    if (m_data != 0)
+        ::UnmapViewOfFile(m_data);
+    if (m_mapHandle != 0)
+        ::CloseHandle(m_mapHandle);
+    if (m_fileHandle != INVALID_HANDLE_VALUE)
+        ::CloseHandle(m_fileHandle);
+    m_mapHandle = 0;
+    m_fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (m_data != 0)
+        ::munmap((void *) m_data, m_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_fd = -1;
+#endif
+    m_data = 0;
+    m_size = 0;
+}
@@ -0,0 +1,113 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <wx/utils.h>
+
+#include "wex/dview/dvmemorybudget.h"
+
+//Without SetLimit the views get a quarter of the memory free when the budget is first used, within these bounds.
+static const size_t MIN_DEFAULT_LIMIT = (size_t) 256 << 20;
+static const size_t UNKNOWN_DEFAULT_LIMIT = (size_t) 1024 << 20;
+
+wxDVMemoryBudget::Entry::~Entry() {
+    wxDVMemoryBudget::Get().Remove(this);
+}
+
+wxDVMemoryBudget &wxDVMemoryBudget::Get() {
+    static wxDVMemoryBudget budget;
+    return budget;
+}
+
+wxDVMemoryBudget::wxDVMemoryBudget() {
+    m_usage = 0;
+    m_limit = UNKNOWN_DEFAULT_LIMIT;
+
+    wxMemorySize free = wxGetFreeMemory();
+    if (free > 0) {
+        long long quarter = (free / 4).GetValue();
+        long long most = (long long) (std::numeric_limits<size_t>::max() / 2);
+        m_limit = std::max(MIN_DEFAULT_LIMIT, (size_t) std::min(quarter, most));
+    }
+}
+
+void wxDVMemoryBudget::SetLimit(size_t bytes) {
+    m_limit = bytes;
+    Trim(0);
+}
+
+void wxDVMemoryBudget::Touch(Entry *e) {
+    size_t size = e->GetMemorySize();
+
+    std::map<Entry *, std::list<Item>::iterator>::iterator it = m_index.find(e);
+    if (it != m_index.end()) {
+        m_usage -= it->second->size;
+        m_items.erase(it->second);
+        m_index.erase(it);
+    }
+
+    if (size == 0)
+        return;
+
+    Item item = {e, size};
+    m_items.push_front(item);
+    m_index[e] = m_items.begin();
+    m_usage += size;
+
+    Trim(e);
+}
+
+void wxDVMemoryBudget::Remove(Entry *e) {
+    std::map<Entry *, std::list<Item>::iterator>::iterator it = m_index.find(e);
+    if (it == m_index.end())
+        return;
+
+    m_usage -= it->second->size;
+    m_items.erase(it->second);
+    m_index.erase(it);
+}
+
+void wxDVMemoryBudget::Trim(Entry *keep) {
+    std::list<Item>::iterator it = m_items.end();
+    while (m_usage > m_limit && it != m_items.begin()) {
+        --it;
+        if (it->entry == keep || !it->entry->Evict())
+            continue;
+
+        m_usage -= it->size;
+        m_index.erase(it->entry);
+        it = m_items.erase(it);
+    }
+}
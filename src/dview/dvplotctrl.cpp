@@ -38,6 +38,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "wex/dview/dvplotctrl.h"
 #include "wex/dview/dvselectionlist.h"
+#include "wex/dview/dvaggregate.h"
 
 #include "wex/icons/barchart.cpng"
 #include "wex/icons/calendar.cpng"
@@ -88,6 +89,7 @@ wxDVPlotCtrl::~wxDVPlotCtrl() {
         WriteState(m_filename);
     }
 
+    m_statisticsTable->WaitForStatistics(); //The tabs are destroyed after the data sets.
     for (size_t i = 0; i < m_dataSets.size(); i++)
         delete m_dataSets[i];
 }
@@ -141,6 +143,30 @@ void wxDVPlotCtrl::AddDataSet(wxDVTimeSeriesDataSet *d, bool update_ui) {
     m_scatterPlot->AddDataSet(d, update_ui);
 }
 
+void wxDVPlotCtrl::AddDataSets(const std::vector<wxDVTimeSeriesDataSet *> &d, bool update_ui) {
+    for (size_t i = 0; i < d.size(); i++)
+        AddDataSet(d[i], update_ui && i == d.size() - 1);
+}
+
+void wxDVPlotCtrl::UpdateDataSet(wxDVTimeSeriesDataSet *d, size_t prevLength, bool update_ui) {
+    //Points from prevLength on may have been replaced (e.g. a row that was still being written), not just appended.
+    wxDVCalendarAggregate::Get(d)->Invalidate(prevLength);
+
+    m_timeSeries->UpdateDataSet(d, prevLength);
+    m_hourlyTimeSeries->UpdateDataSet(d, prevLength);
+    m_dailyTimeSeries->UpdateDataSet(d, prevLength);
+    m_monthlyTimeSeries->UpdateDataSet(d, prevLength);
+    m_dMap->UpdateDataSet(d, prevLength);
+    m_profilePlots->UpdateDataSet(d);
+    m_statisticsTable->UpdateDataSet(d);
+    m_pnCdf->UpdateDataSet(d);
+    m_durationCurve->UpdateDataSet(d);
+
+    //The scatter tab reads the data sets as it draws.
+    if (update_ui)
+        m_statisticsTable->UpdateDataViewCtrl();
+}
+
 void wxDVPlotCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
     if (!this->m_okToAccessState) return;
 
@@ -48,6 +48,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "wex/dview/dvselectionlist.h"
 #include "wex/dview/dvpncdfctrl.h"
+#include "wex/dview/dvquantilesketch.h"
+#include "wex/dview/dvsortedvalues.h"
 
 enum {
     ID_DATA_SELECTOR = wxID_HIGHEST + 1,
@@ -55,10 +57,26 @@ enum {
     wxID_NORMALIZE_CHOICE,
   //  wxID_Y1_MAX_TB,
   //  wxID_Y2_MAX_TB,
+    wxID_APPROX_CDF_CHECK,
     wxID_PVALUE_TB//,
 //    wxID_PLOT_TYPE
 };
 
+//Lets the histogram bin the y values of a data set where they are stored.
+class wxDVHistogramValues : public wxPLHistogramData {
+public:
+    wxDVHistogramValues(wxDVTimeSeriesDataSet *d) : m_data(d) {}
+
+    virtual size_t Length() const { return m_data->Length(); }
+
+    virtual const double *GetValues(size_t start, size_t end, std::vector<double> &buf) const {
+        return m_data->GetYSpan(start, end, buf);
+    }
+
+private:
+    wxDVTimeSeriesDataSet *m_data;
+};
+
 BEGIN_EVENT_TABLE(wxDVPnCdfCtrl, wxPanel)
     EVT_DVSELECTIONLIST(ID_DATA_SELECTOR, wxDVPnCdfCtrl::OnDataChannelSelection)
 //    EVT_TEXT_ENTER(wxID_Y1_MAX_TB, wxDVPnCdfCtrl::OnEnterY1Max)
@@ -67,6 +85,7 @@ BEGIN_EVENT_TABLE(wxDVPnCdfCtrl, wxPanel)
     EVT_CHOICE(wxID_NORMALIZE_CHOICE, wxDVPnCdfCtrl::OnNormalizeChoice)
     EVT_COMBOBOX(wxID_BIN_COMBO, wxDVPnCdfCtrl::OnBinComboSelection)
     EVT_TEXT_ENTER(wxID_BIN_COMBO, wxDVPnCdfCtrl::OnBinTextEnter)
+    EVT_CHECKBOX(wxID_APPROX_CDF_CHECK, wxDVPnCdfCtrl::OnApproximateCdfClick)
     EVT_CHECKBOX(wxID_ANY, wxDVPnCdfCtrl::OnShowZerosClick)
 //    EVT_CHOICE(wxID_PLOT_TYPE, wxDVPnCdfCtrl::OnPlotTypeSelection)
     EVT_TEXT(wxID_ANY, wxDVPnCdfCtrl::OnSearch)
@@ -77,6 +96,7 @@ wxDVPnCdfCtrl::wxDVPnCdfCtrl(wxWindow *parent, wxWindowID id, const wxPoint &pos
         : wxPanel(parent, id, pos, size, style, name) {
     m_bshowpvalue = bshowpvalue;
     m_bshowhidezeros = bshowhidezeros;
+    m_approximateCdf = false;
     m_srchCtrl = NULL;
     m_plotSurface = new wxPLPlotCtrl(this, wxID_ANY);
     m_plotSurface->SetBackgroundColour(*wxWHITE);
@@ -119,11 +139,17 @@ wxDVPnCdfCtrl::wxDVPnCdfCtrl(wxWindow *parent, wxWindowID id, const wxPoint &pos
     m_PlotTypeDisplayed->Append(wxT("CDF Only"));
     m_PlotTypeDisplayed->SetSelection(0);
     */
+    m_approximateCdfCheck = new wxCheckBox(this, wxID_APPROX_CDF_CHECK, "Approximate CDF", wxDefaultPosition, wxDefaultSize, wxALIGN_RIGHT);
+    m_approximateCdfCheck->SetToolTip(wxString::Format("Estimate percentiles in one pass instead of sorting every value.  "
+                                                       "Percentiles are typically within about %.2lg%% of the exact ones.",
+                                                       100.0 * wxDVQuantileSketch().GetRankError()));
     wxBoxSizer *options1Sizer = new wxBoxSizer(wxHORIZONTAL);
     if (m_bshowhidezeros) {
         options1Sizer->Add(m_hideZeros, 0, wxALL | wxALIGN_CENTER_VERTICAL, 2);
         options1Sizer->AddStretchSpacer();
     }
+    options1Sizer->Add(m_approximateCdfCheck, 0, wxALL | wxALIGN_CENTER_VERTICAL, 2);
+    options1Sizer->AddStretchSpacer();
     if (m_bshowpvalue) {
         options1Sizer->Add(new wxStaticText(this, wxID_ANY, wxT("p-value:")), 0,
             wxALIGN_CENTER | wxALL | wxALIGN_CENTER_VERTICAL, 2);
@@ -197,6 +223,8 @@ wxDVPnCdfCtrl::wxDVPnCdfCtrl(wxWindow *parent, wxWindowID id, const wxPoint &pos
 wxDVPnCdfCtrl::~wxDVPnCdfCtrl() {
     for (size_t i = 0; i < m_cdfPlotData.size(); i++)
         delete m_cdfPlotData[i];
+    for (size_t i = 0; i < m_sortedValues.size(); i++)
+        delete m_sortedValues[i];
 }
 
 void wxDVPnCdfCtrl::ReadState(std::string filename) {
@@ -216,6 +244,11 @@ void wxDVPnCdfCtrl::ReadState(std::string filename) {
     m_bshowhidezeros = (s == "false") ? false : true;
     if (m_bshowhidezeros) m_hideZeros->SetValue(m_bshowhidezeros);
     ShowZerosClick();
+
+    key = prefix + "ApproximateCdf";
+    bool approximate;
+    cfg.Read(key, &approximate, false);
+    SetCdfApproximate(approximate);
     /*
     key = prefix + "PlotType";
     success = cfg.Read(key, &s);
@@ -310,6 +343,11 @@ void wxDVPnCdfCtrl::WriteState(std::string filename) {
     success = cfg.Write(key, s.c_str());
     if (debugging) assert(success);
     */
+    key = prefix + "ApproximateCdf";
+    s = m_approximateCdf ? "true" : "false";
+    success = cfg.Write(key, s.c_str());
+    if (debugging) assert(success);
+
     key = prefix + "Normalize";
     s = wxString::Format(wxT("%d"), (int) m_normalizeChoice->GetSelection());
     success = cfg.Write(key, s.c_str());
@@ -338,6 +376,7 @@ void wxDVPnCdfCtrl::AddDataSet(wxDVTimeSeriesDataSet *d, bool update_ui) {
 
     //Add new plot data array, but leave it empty until we use it.  We'll fill it with sorted values then.
     m_cdfPlotData.push_back(new std::vector<wxRealPoint>());
+    m_sortedValues.push_back(new CdfValues(this));
 
     if (update_ui)
         Layout();
@@ -364,12 +403,31 @@ void wxDVPnCdfCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
     m_dataSets.erase(m_dataSets.begin() + index);
     delete m_cdfPlotData[index];
     m_cdfPlotData.erase(m_cdfPlotData.begin() + index);
+    delete m_sortedValues[index];
+    m_sortedValues.erase(m_sortedValues.begin() + index);
 
     m_selector->RemoveAt(index);
 
     InvalidatePlot();
 }
 
+void wxDVPnCdfCtrl::UpdateDataSet(wxDVTimeSeriesDataSet *d) {
+    for (size_t i = 0; i < m_dataSets.size(); i++) {
+        if (m_dataSets[i] != d)
+            continue;
+
+        //The cdf is resorted the next time it is shown; redraw now only if it is shown.
+        m_cdfPlotData[i]->clear();
+        if (m_selectedDataSetIndex == static_cast<int>(i)) {
+            double pValue = GetPValue();
+            ChangePlotDataTo(d, true);
+            SetPValue(pValue);
+            InvalidatePlot();
+        }
+        break;
+    }
+}
+
 void wxDVPnCdfCtrl::RemoveAllDataSets() {
     ChangePlotDataTo(NULL);
 
@@ -378,6 +436,9 @@ void wxDVPnCdfCtrl::RemoveAllDataSets() {
     for (size_t i = 0; i < m_cdfPlotData.size(); i++)
         delete m_cdfPlotData[i];
     m_cdfPlotData.clear();
+    for (size_t i = 0; i < m_sortedValues.size(); i++)
+        delete m_sortedValues[i];
+    m_sortedValues.clear();
     m_selector->RemoveAll();
 
     InvalidatePlot();
@@ -480,16 +541,8 @@ void wxDVPnCdfCtrl::SetPValue(double pValue) {
     
     if (pValue >=0) {
         // get selected cdfData x value for specified pVal
-        if (m_selectedDataSetIndex > -1) {
-            // search m_cdfData[m_selectedDataSetIndex] for y <= 100 -pVal
-            // TODO - add find for std::vector <wxRealPoint>
-            auto it =m_cdfPlotData[m_selectedDataSetIndex]->begin();
-            m_pValue_x = it->x;
-            // probability of exceedance (100-pvalue)
-            while ((it != m_cdfPlotData[m_selectedDataSetIndex]->end()) && (it->y <= (100.0 - pValue))) { 
-                m_pValue_x = it->x;
-                it++;
-            }
+        // probability of exceedance (100-pvalue)
+        if (m_selectedDataSetIndex > -1 && GetCdfValue(m_selectedDataSetIndex, 100.0 - pValue, &m_pValue_x)) {
             // set annotation
             std::vector<wxRealPoint> pValueLine;
             pValueLine.push_back(wxRealPoint(m_pValue_x,100.0- pValue));
@@ -535,7 +588,7 @@ void wxDVPnCdfCtrl::ChangePlotDataTo(wxDVTimeSeriesDataSet *d, bool forceDataRef
         else if (m_binsCombo->GetSelection() == 2) //SQRT
             m_pdfPlot->SetNumberOfBins(m_pdfPlot->GetSqrtBinsFor(d->Length()));
 
-        m_pdfPlot->SetData(d->GetDataVector()); //inefficient?
+        m_pdfPlot->SetData(new wxDVHistogramValues(d));
         m_pdfPlot->SetLabel(d->GetSeriesTitle());
         m_pdfPlot->SetXDataLabel(m_plotSurface->GetXAxis1()->GetLabel());
         m_pdfPlot->SetYDataLabel(d->GetSeriesTitle());
@@ -558,12 +611,7 @@ void wxDVPnCdfCtrl::ChangePlotDataTo(wxDVTimeSeriesDataSet *d, bool forceDataRef
         m_cdfPlot->SetYDataLabel(wxEmptyString);
     } else {
         // Read Cdf Data (requires sort) if not already sorted.
-        if (m_cdfPlotData[index]->size() == 0 || forceDataRefresh) {
-            if (forceDataRefresh) { m_cdfPlotData[index]->clear(); }
-            ReadCdfFrom(*d, m_cdfPlotData[index]);
-        }
-
-        m_cdfPlot->SetData(*m_cdfPlotData[index]);
+        ReadCdf(index, forceDataRefresh);
         m_cdfPlot->SetLabel(d->GetSeriesTitle() + " " + _("Percentile"));
         m_cdfPlot->SetXDataLabel(m_plotSurface->GetXAxis1()->GetLabel());
         m_cdfPlot->SetYDataLabel(m_cdfPlot->GetLabel());
@@ -579,34 +627,121 @@ void wxDVPnCdfCtrl::ChangePlotDataTo(wxDVTimeSeriesDataSet *d, bool forceDataRef
     }
 }
 
+//Point i of n sorted values is at 100 * i / (n - 1) percent.
+static void GetCdfPoints(const wxDVSortedValues &sorted, std::vector<wxRealPoint> *cdfArray) {
+    size_t n = sorted.Length();
+    cdfArray->reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        double percent = (n > 1) ? 100 * double(i) / double(n - 1) : 100;
+        cdfArray->push_back(wxRealPoint(sorted.At(i), percent));
+    }
+}
+
 void wxDVPnCdfCtrl::ReadCdfFrom(wxDVTimeSeriesDataSet &d, std::vector<wxRealPoint> *cdfArray) {
     // This does not use bins.  It is an empirical CDF.  See wikipedia for empirical CDF explanation.
     // This can take a long time because of sorting.
+    if (m_approximateCdf) {
+        // One pass into a sketch; the cdf is drawn through the few hundred values it keeps.
+        wxDVQuantileSketch sketch;
+        bool ignoreZeros = m_cdfPlot->GetIgnoreZeros();
+        size_t len = d.Length();
+        std::vector<double> buf;
+        for (size_t start = 0; start < len; start += wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE) {
+            size_t end = (len - start > wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE)
+                         ? start + wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE : len;
+            const double *y = d.GetYSpan(start, end, buf);
+            for (size_t i = 0; i < end - start; i++) {
+                if (wxDVTimeSeriesDataSet::IsMissing(y[i])) continue;
+                if (!ignoreZeros || y[i] != 0.0) { sketch.Add(y[i]); }
+            }
+        }
+        if (sketch.IsEmpty())
+            return;
+
+        std::vector<double> values, counts;
+        sketch.GetSortedView(values, counts);
+        double n = (double) sketch.GetCount();
+        cdfArray->reserve(values.size() + 2);
+        cdfArray->push_back(wxRealPoint(sketch.GetMin(), 0));
+        for (size_t i = 0; i < values.size(); i++)
+            cdfArray->push_back(wxRealPoint(values[i], n > 1 ? 100 * (counts[i] - 1) / (n - 1) : 100));
+        if (values.back() < sketch.GetMax())
+            cdfArray->push_back(wxRealPoint(sketch.GetMax(), 100));
+        return;
+    }
 
     wxBeginBusyCursor();
     wxBusyInfo wait("Please wait, calculating CDF...");
 
-    std::vector<double> sortedValues;
+    std::shared_ptr<const wxDVSortedValues> sorted = wxDVSortedValues::Get(&d, m_cdfPlot->GetIgnoreZeros());
+    GetCdfPoints(*sorted, cdfArray);
 
-    for (size_t i = 0; i < d.Length(); i++) {
-        if (!m_cdfPlot->GetIgnoreZeros() || d.At(i).y != 0.0) { sortedValues.push_back(d.At(i).y); }
-    }
+    wxEndBusyCursor();
+}
 
-    if (sortedValues.size() > 0) {
-        std::sort(sortedValues.begin(), sortedValues.end());
+void wxDVPnCdfCtrl::ReadCdf(int index, bool forceDataRefresh) {
+    wxDVTimeSeriesDataSet *d = m_dataSets[index];
+    if (m_approximateCdf) {
+        if (m_cdfPlotData[index]->size() == 0 || forceDataRefresh) {
+            m_cdfPlotData[index]->clear();
+            ReadCdfFrom(*d, m_cdfPlotData[index]);
+        }
+        m_cdfPlot->SetData(*m_cdfPlotData[index]);
+        return;
+    }
 
-        //double dataMin = sortedValues[0];
-        //double dataMax = sortedValues[sortedValues.size() - 1];
+    //The sorted values are only read again once d has changed; the duration curve may have sorted them already.
+    std::shared_ptr<const wxDVSortedValues> &sorted = m_sortedValues[index]->values;
+    bool ignoreZeros = m_cdfPlot->GetIgnoreZeros();
+    if (!sorted || sorted->GetDataVersion() != d->GetVersion() || sorted->IgnoresZeros() != ignoreZeros) {
+        wxBeginBusyCursor();
+        wxBusyInfo wait("Please wait, calculating CDF...");
+        sorted = wxDVSortedValues::Get(d, ignoreZeros);
+        wxEndBusyCursor();
     }
+    wxDVMemoryBudget::Get().Touch(m_sortedValues[index]);
+
+    std::vector<wxRealPoint> cdf;
+    GetCdfPoints(*sorted, &cdf);
+    m_cdfPlot->SetData(cdf);
+}
+
+size_t wxDVPnCdfCtrl::CdfValues::GetMemorySize() const {
+    return values ? values->Length() * sizeof(double) : 0;
+}
+
+bool wxDVPnCdfCtrl::CdfValues::Evict() {
+    int shown = owner->m_selectedDataSetIndex;
+    if (shown >= 0 && static_cast<size_t>(shown) < owner->m_sortedValues.size()
+        && owner->m_sortedValues[shown] == this)
+        return false;
 
-    cdfArray->reserve(sortedValues.size());
-    for (size_t i = 0; i < sortedValues.size(); i++) {
-        double x = sortedValues[i];
-        double percent = 100 * double(i) / double(sortedValues.size() - 1);
-        cdfArray->push_back(wxRealPoint(x, percent));
+    values.reset();
+    return true;
+}
+
+bool wxDVPnCdfCtrl::GetCdfValue(int index, double percent, double *x) {
+    if (!m_approximateCdf && m_sortedValues[index]->values) {
+        //Point i of the exact cdf is at 100 * i / (n - 1) percent.
+        const wxDVSortedValues &sorted = *m_sortedValues[index]->values;
+        size_t n = sorted.Length();
+        if (n == 0) return false;
+        size_t i = 0;
+        if (n > 1 && percent > 0) {
+            i = std::min((size_t) floor(percent * (n - 1) / 100.0), n - 1);
+            while (i + 1 < n && 100 * double(i + 1) / double(n - 1) <= percent) i++;
+            while (i > 0 && 100 * double(i) / double(n - 1) > percent) i--;
+        }
+        *x = sorted.At(i);
+        return true;
     }
 
-    wxEndBusyCursor();
+    const std::vector<wxRealPoint> &cdf = *m_cdfPlotData[index];
+    if (cdf.empty()) return false;
+    auto it = std::upper_bound(cdf.begin(), cdf.end(), percent,
+                               [](double y, const wxRealPoint &p) { return y < p.y; });
+    *x = (it == cdf.begin()) ? it->x : (it - 1)->x;
+    return true;
 }
 
 void wxDVPnCdfCtrl::UpdateYAxisLabel() {
@@ -735,6 +870,30 @@ void wxDVPnCdfCtrl::NormalizeChoice() {
     InvalidatePlot();
 }
 
+void wxDVPnCdfCtrl::OnApproximateCdfClick(wxCommandEvent &) {
+    SetCdfApproximate(m_approximateCdfCheck->GetValue());
+}
+
+void wxDVPnCdfCtrl::SetCdfApproximate(bool approximate) {
+    m_approximateCdfCheck->SetValue(approximate);
+    if (m_approximateCdf == approximate)
+        return;
+    m_approximateCdf = approximate;
+
+    //Cached cdfs were read in the other mode.
+    for (size_t i = 0; i < m_cdfPlotData.size(); i++) {
+        m_cdfPlotData[i]->clear();
+        m_sortedValues[i]->values.reset();
+        wxDVMemoryBudget::Get().Touch(m_sortedValues[i]);
+    }
+
+    if (m_selectedDataSetIndex > -1 && m_selectedDataSetIndex < static_cast<int>(m_cdfPlotData.size())) {
+        double pValue = m_pValue;
+        ReadCdf(m_selectedDataSetIndex, false);
+        SetPValue(pValue);
+    }
+}
+
 void wxDVPnCdfCtrl::OnShowZerosClick(wxCommandEvent &) {
     ShowZerosClick();
 }
@@ -747,9 +906,7 @@ void wxDVPnCdfCtrl::ShowZerosClick() {
     m_cdfPlot->SetIgnoreZeros(ignoreZeros);
 
     if (m_selectedDataSetIndex > -1 && m_selectedDataSetIndex < static_cast<int>(m_cdfPlotData.size())) {
-        m_cdfPlotData[m_selectedDataSetIndex]->clear();
-        ReadCdfFrom(*m_dataSets[m_selectedDataSetIndex], m_cdfPlotData[m_selectedDataSetIndex]);
-        m_cdfPlot->SetData(*m_cdfPlotData[m_selectedDataSetIndex]);
+        ReadCdf(m_selectedDataSetIndex, true);
 
         m_plotSurface->GetYAxis1()->SetWorldMax(m_pdfPlot->GetNiceYMax());
 //        m_y1MaxTextBox->SetValue(wxString::Format("%lg", m_pdfPlot->GetNiceYMax()));
@@ -43,6 +43,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <wx/tokenzr.h>
 #include <wx/timer.h>
 
+#include "wex/dview/dvaggregate.h"
 #include "wex/dview/dvprofilectrl.h"
 #include "wex/dview/dvplothelper.h"
 #include "wex/dview/dvselectionlist.h"
@@ -53,74 +54,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 static const wxString NO_UNITS("ThereAreNoUnitsForThisAxis.");
 
-#if defined(_DEBUG) && defined(WIN32)
-#define VEC_ASSERT(x) {if(!(x)) __debugbreak(); }
-#else
-#define VEC_ASSERT(X) assert(X)
-#endif
-
-template<typename T>
-class dvMatrix {
-private:
-
-    T *t_array;
-    size_t n_rows, n_cols;
-
-public:
-
-    dvMatrix() {
-        t_array = NULL;
-        n_rows = n_cols = 0;
-    }
-
-    dvMatrix(size_t nr, size_t nc, const T &val) {
-        t_array = NULL;
-        resize_fill(nr, nc, val);
-    }
-
-    virtual ~dvMatrix() {
-        if (t_array) delete[] t_array;
-    }
-
-    void resize_fill(size_t nr, size_t nc, const T &val) {
-        if (t_array == 0) {
-            delete[] t_array;
-            t_array = NULL;
-            n_rows = n_cols = 0;
-        }
-        size_t len = nr * nc;
-        if (len > 0) {
-            t_array = new T[nr * nc];
-            for (size_t i = 0; i < len; i++)
-                t_array[i] = val;
-            n_rows = nr;
-            n_cols = nc;
-        }
-    }
-
-    inline T &at(size_t r, size_t c) {
-#ifdef _DEBUG
-        VEC_ASSERT(r >= 0 && r < n_rows && c >= 0 && c < n_cols);
-#endif
-        return t_array[n_cols * r + c];
-    }
-
-    inline const T &at(size_t r, size_t c) const {
-#ifdef _DEBUG
-        VEC_ASSERT(r >= 0 && r < n_rows && c >= 0 && c < n_cols);
-#endif
-        return t_array[n_cols * r + c];
-    }
-
-    inline size_t nrows() const {
-        return n_rows;
-    }
-
-    inline size_t ncols() const {
-        return n_cols;
-    }
-};
-
 class wxDVProfileCtrl::VerticalLabelCtrl : public wxWindow {
 private:
 
@@ -318,6 +251,7 @@ void wxDVProfileCtrl::ReadState(std::string filename) {
         SelectDataSetAtIndex(0);
     }
 
+    CalculateProfileData(m_selections);
     m_counter = 0;
     m_timer->Start(10);
 }
@@ -400,6 +334,22 @@ bool wxDVProfileCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
     return true;
 }
 
+void wxDVProfileCtrl::UpdateDataSet(wxDVTimeSeriesDataSet *d) {
+    for (size_t i = 0; i < m_plots.size(); i++) {
+        if (m_plots[i]->dataset != d)
+            continue;
+
+        //A hidden plot set is recalculated when it is shown again.
+        if (m_dataSelector->IsSelected(i, 0)) {
+            m_plots[i]->CalculateProfileData();
+            AutoScaleYAxes();
+            for (int j = 0; j < 13; j++)
+                m_plotSurfaces[j]->Refresh();
+        }
+        break;
+    }
+}
+
 void wxDVProfileCtrl::RemoveAllDataSets() {
     HideAllPlots(false);
     for (int i = m_plots.size() - 1; i >= 0; i--) {
@@ -411,7 +361,9 @@ void wxDVProfileCtrl::RemoveAllDataSets() {
 
 wxDVProfileCtrl::PlotSet::PlotSet(wxDVTimeSeriesDataSet *ds) {
     dataset = ds;
+    aggregate = wxDVCalendarAggregate::Get(ds);
     axisPosition = wxPLPlotCtrl::Y_LEFT;
+    version = 0;
     for (int i = 0; i < 13; i++)
         plots[i] = 0;
 }
@@ -422,47 +374,33 @@ wxDVProfileCtrl::PlotSet::~PlotSet() {
             delete plots[i];
 }
 
+bool wxDVProfileCtrl::PlotSet::IsCalculated() const {
+    for (int i = 0; i < 13; i++)
+        if (plots[i] == 0) return false;
+    return version == dataset->GetVersion();
+}
+
 void wxDVProfileCtrl::PlotSet::CalculateProfileData() {
     if (!dataset || dataset->Length() < 2)
         return;
-    bool already_calculated = true;
-    for (int i = 0; i < 13; i++)
-        already_calculated = already_calculated && (plots[i] != 0);
-    if (already_calculated) return;
-    // Holds all of the data points we read at each interval so we can average them.
-    // We have to store each months data instead of reusing our array because the data could be multi-year.
-    dvMatrix<double> dailyData(12, 24.0 / dataset->GetTimeStep(), 0.0);
-    // For averaging
-    dvMatrix<int> dataPointCount(12, 24.0 / dataset->GetTimeStep(), 0.0);
-    wxDateTime timeKeeper(01, wxDateTime::Jan, 1970, 00, 00, 00);
-    double hours = dataset->At(0).x;
-    double offsetFraction = fmod(dataset->At(0).x,
-                                 dataset->GetTimeStep()); //Non int offsets get chopped off without this.
-    timeKeeper.Add(wxTimeSpan::Hours(hours));
-    int k = (timeKeeper.GetHour() + (double) timeKeeper.GetMinute() / 60.0) /
-            dataset->GetTimeStep(); //Account for initial offset.
-    //Read data points into the correct month array.
-    //This code requires a uniform time step. (Otherwise we have to re-define how we compute the average).
-    //This will handle multiple years and data that starts mid-year correctly.
-    //Multi-year data will all get averaged into the same plots (if there are 2 Jan months in the data, we average over 62 days).
-    for (size_t i = 0; i < dataset->Length(); i++) {
-        wxDateTime::Month currentMonth = timeKeeper.GetMonth();
-        dailyData.at(currentMonth, k) = dailyData.at(currentMonth, k) + dataset->At(i).y;
-        dataPointCount.at(currentMonth, k) += 1;
-        k = (k + 1) % int(24 / dataset->GetTimeStep());
-        timeKeeper.Add(wxTimeSpan::Minutes(dataset->GetTimeStep() * 60));
-        currentMonth = timeKeeper.GetMonth();
-        hours += dataset->GetTimeStep();
-    }
+    if (IsCalculated()) return;
+    // The sums and counts at each time of day of each month come from the data set's calendar aggregate,
+    // which the time series tabs and statistics share.  Multi-year data is averaged into the same plots
+    // (if there are 2 Jan months in the data, we average over 62 days).
+    aggregate->Update();
+    version = dataset->GetVersion();
+    size_t slots = aggregate->GetProfileSlots();
+    double timestep = dataset->GetTimeStep();
+    double offsetFraction = fmod(dataset->At(0).x, timestep); //Non int offsets get chopped off without this.
     std::vector<std::vector<wxRealPoint> > plotData(13);
+    std::vector<double> sums, counts;
     //Compute average, and then set plottable data.
-    for (size_t i = 0; i < dailyData.nrows(); i++) {
-        plotData[i].reserve(dailyData.ncols());
-        for (size_t j = 0; j < dailyData.ncols(); j++) {
-            dailyData.at(i, j) = dataPointCount.at(i, j) > 0 ? dailyData.at(i, j) / dataPointCount.at(i, j)
-                                                             : 0; //Do avarage. Don't /0.
-            plotData[i].push_back(wxRealPoint(offsetFraction + j * dataset->GetTimeStep(), dailyData.at(i, j)));
-        }
+    for (int i = 0; i < 12; i++) {
+        aggregate->GetProfile(i, sums, counts);
+        plotData[i].reserve(slots);
+        for (size_t j = 0; j < slots; j++)
+            plotData[i].push_back(wxRealPoint(offsetFraction + j * timestep,
+                                              counts[j] > 0 ? sums[j] / counts[j] : 0)); //Do avarage. Don't /0.
     }
     // Average again into annual profile:
     // Right now we are averaging across 12 months.
@@ -497,6 +435,22 @@ void wxDVProfileCtrl::PlotSet::CalculateProfileData() {
     }
 }
 
+void wxDVProfileCtrl::CalculateProfileData(const std::vector<int> &indices) {
+    // The aggregate updates are the expensive part and each one locks only its own aggregate,
+    // so run them side by side.  Lazily read columns are left to load on the UI thread.
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (indices[i] < 0 || indices[i] >= (int) m_plots.size()) continue;
+        PlotSet *ps = m_plots[indices[i]];
+        if (ps->IsCalculated() || !ps->dataset->IsLoaded() || ps->dataset->Length() < 2) continue;
+        std::shared_ptr<wxDVCalendarAggregate> aggregate = ps->aggregate;
+        m_workers.Queue([aggregate]() { aggregate->Update(); });
+    }
+    m_workers.Wait();
+    for (size_t i = 0; i < indices.size(); i++)
+        if (indices[i] >= 0 && indices[i] < (int) m_plots.size())
+            m_plots[indices[i]]->CalculateProfileData();
+}
+
 /*Event Handlers*/
 void wxDVProfileCtrl::OnDataChannelSelection(wxCommandEvent &) {
     int row;
@@ -713,9 +667,9 @@ void wxDVProfileCtrl::HidePlotAtIndex(int i, bool update) {
             }
         } else if (NumY2AxisSelections > 0)    //We deselected the last variable with Y1 units, so move Y2 to Y1
         {
+            CalculateProfileData(currently_shown);
             for (size_t j = 0; j < currently_shown.size(); j++) {
                 int index = currently_shown[j];
-                m_plots[index]->CalculateProfileData();
                 m_plots[index]->axisPosition = wxPLPlotCtrl::Y_LEFT;
                 for (int k = 0; k < 13; k++) {
                     m_plotSurfaces[k]->RemovePlot(m_plots[index]->plots[k]);
@@ -839,13 +793,17 @@ wxDVSelectionListCtrl *wxDVProfileCtrl::GetDataSelectionList() {
 
 void wxDVProfileCtrl::SetSelectedNames(const wxString &names) {
     HideAllPlots(false);
+    std::vector<int> rows;
     wxStringTokenizer tkz(names, ";");
     while (tkz.HasMoreTokens()) {
         wxString token = tkz.GetNextToken();
         int row = m_dataSelector->SelectRowWithNameInCol(token);
         if (row != -1)
-            ShowPlotAtIndex(row);
+            rows.push_back(row);
     }
+    CalculateProfileData(rows);
+    for (size_t i = 0; i < rows.size(); i++)
+        ShowPlotAtIndex(rows[i]);
 }
 
 void wxDVProfileCtrl::SelectDataSetAtIndex(int index) {
@@ -0,0 +1,189 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <math.h>
+
+#include "wex/dview/dvquantilesketch.h"
+
+//The smallest compactor; lower levels shrink by 2/3 per level down to this.
+static const size_t MIN_LEVEL_CAPACITY = 8;
+
+wxDVQuantileSketch::wxDVQuantileSketch(unsigned k) {
+    m_k = (k >= MIN_LEVEL_CAPACITY) ? k : MIN_LEVEL_CAPACITY;
+    Clear();
+}
+
+void wxDVQuantileSketch::Clear() {
+    m_count = 0;
+    m_retained = 0;
+    m_min = m_max = 0.0;
+    m_levels.assign(1, std::vector<double>());
+    UpdateCapacity();
+    m_random.seed(m_k); // fixed seed, so the same data always gives the same plot
+}
+
+void wxDVQuantileSketch::Add(double value) {
+    if (m_count == 0) {
+        m_min = m_max = value;
+    } else {
+        if (value < m_min) m_min = value;
+        if (value > m_max) m_max = value;
+    }
+    m_count++;
+
+    m_levels[0].push_back(value);
+    m_retained++;
+    if (m_retained >= m_capacity)
+        Compress();
+}
+
+void wxDVQuantileSketch::Merge(const wxDVQuantileSketch &other) {
+    if (other.m_count == 0)
+        return;
+    if (m_count == 0) {
+        m_min = other.m_min;
+        m_max = other.m_max;
+    } else {
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+    m_count += other.m_count;
+
+    if (m_levels.size() < other.m_levels.size()) {
+        m_levels.resize(other.m_levels.size());
+        UpdateCapacity();
+    }
+    for (size_t h = 0; h < other.m_levels.size(); h++) {
+        m_levels[h].insert(m_levels[h].end(), other.m_levels[h].begin(), other.m_levels[h].end());
+        m_retained += other.m_levels[h].size();
+    }
+    if (m_retained >= m_capacity)
+        Compress();
+}
+
+double wxDVQuantileSketch::GetQuantile(double fraction) const {
+    if (m_count == 0)
+        return 0.0;
+    if (fraction <= 0.0)
+        return m_min;
+    if (fraction >= 1.0)
+        return m_max;
+
+    std::vector<double> values, counts;
+    GetSortedView(values, counts);
+    double target = fraction * m_count;
+    size_t i = std::lower_bound(counts.begin(), counts.end(), target) - counts.begin();
+    return (i < values.size()) ? values[i] : m_max;
+}
+
+double wxDVQuantileSketch::GetRank(double value) const {
+    if (m_count == 0)
+        return 0.0;
+
+    double weight = 1.0, below = 0.0;
+    for (size_t h = 0; h < m_levels.size(); h++, weight *= 2.0)
+        for (size_t i = 0; i < m_levels[h].size(); i++)
+            if (m_levels[h][i] <= value)
+                below += weight;
+    return below / m_count;
+}
+
+double wxDVQuantileSketch::GetRankError() const {
+    //Empirical fit for KLL sketches taken from Apache DataSketches; it has not been checked against this
+    //implementation, so it is only a guide to the size of the error.
+    return 2.296 / pow((double) m_k, 0.9723);
+}
+
+void wxDVQuantileSketch::GetSortedView(std::vector<double> &values, std::vector<double> &counts) const {
+    std::vector<std::pair<double, double> > items;
+    items.reserve(m_retained);
+    double weight = 1.0;
+    for (size_t h = 0; h < m_levels.size(); h++, weight *= 2.0)
+        for (size_t i = 0; i < m_levels[h].size(); i++)
+            items.push_back(std::make_pair(m_levels[h][i], weight));
+    std::sort(items.begin(), items.end());
+
+    values.resize(items.size());
+    counts.resize(items.size());
+    double total = 0.0;
+    for (size_t i = 0; i < items.size(); i++) {
+        total += items[i].second;
+        values[i] = items[i].first;
+        counts[i] = total;
+    }
+}
+
+size_t wxDVQuantileSketch::GetCapacity(size_t level) const {
+    //The top level holds k items and each level below it 2/3 as many.
+    size_t depth = m_levels.size() - 1 - level;
+    size_t capacity = (size_t) ceil(m_k * pow(2.0 / 3.0, (double) depth));
+    return (capacity > MIN_LEVEL_CAPACITY) ? capacity : MIN_LEVEL_CAPACITY;
+}
+
+void wxDVQuantileSketch::UpdateCapacity() {
+    m_capacity = 0;
+    for (size_t h = 0; h < m_levels.size(); h++)
+        m_capacity += GetCapacity(h);
+}
+
+void wxDVQuantileSketch::Compress() {
+    while (m_retained >= m_capacity) {
+        //Some level is at capacity whenever the sketch as a whole is.
+        size_t h = 0;
+        while (h < m_levels.size() && m_levels[h].size() < GetCapacity(h))
+            h++;
+        if (h == m_levels.size())
+            break;
+        if (h + 1 == m_levels.size()) {
+            m_levels.push_back(std::vector<double>());
+            UpdateCapacity();
+        }
+
+        std::vector<double> &level = m_levels[h];
+        std::vector<double> &above = m_levels[h + 1];
+        std::sort(level.begin(), level.end());
+
+        //An odd item out stays behind; of the rest, every other one is promoted at twice the weight.
+        size_t pairs = level.size() / 2;
+        size_t offset = m_random() & 1;
+        for (size_t i = 0; i < pairs; i++)
+            above.push_back(level[2 * i + offset]);
+        if (level.size() % 2 == 1) {
+            double last = level.back();
+            level.assign(1, last);
+        } else {
+            level.clear();
+        }
+        m_retained -= pairs;
+    }
+}
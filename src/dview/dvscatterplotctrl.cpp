@@ -35,6 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include <wx/wx.h>
 #include <wx/config.h>
@@ -51,12 +52,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 static const wxString NO_UNITS("ThereAreNoUnitsForThisAxis.");
 
+//Default number of points above which channel pairs are drawn as densities.
+static const size_t DEFAULT_DENSITY_THRESHOLD = 50000;
+
+//Below this many points the density grid is counted on the calling thread.
+static const size_t PARALLEL_DENSITY_MIN = 1 << 16;
+
 class wxDVScatterPlot : public wxPLScatterPlot {
 private:
     wxDVTimeSeriesDataSet *m_x, *m_y;
+    wxDVWorkerPool *m_workers;
 public:
-    wxDVScatterPlot(wxDVTimeSeriesDataSet *x, wxDVTimeSeriesDataSet *y)
-            : m_x(x), m_y(y) {
+    wxDVScatterPlot(wxDVTimeSeriesDataSet *x, wxDVTimeSeriesDataSet *y, wxDVWorkerPool *workers = 0)
+            : m_x(x), m_y(y), m_workers(workers) {
     }
 
     virtual wxString GetXDataLabel(wxPLPlot *) const {
@@ -78,6 +86,51 @@ public:
         size_t ylen = m_y->Length();
         return xlen < ylen ? xlen : ylen;
     }
+
+protected:
+    //Reads the channels a span at a time and counts blocks of points on the
+    //worker pool, each into its own grid, then adds the grids up.
+    virtual void CountDensity(const wxPLDeviceMapping &map, double cell, int width, int height,
+                              std::vector<unsigned int> &counts) {
+        wxRealPoint min = map.GetWorldMinimum();
+        wxRealPoint max = map.GetWorldMaximum();
+        wxRealPoint pos;
+        map.GetDeviceExtents(&pos, 0);
+
+        auto count = [&](size_t begin, size_t end, std::vector<unsigned int> &grid) {
+            std::vector<double> xbuf, ybuf;
+            for (size_t start = begin; start < end; start += wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE) {
+                size_t stop = (end - start > wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE)
+                              ? start + wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE : end;
+                const double *xs = m_x->GetYSpan(start, stop, xbuf);
+                const double *ys = m_y->GetYSpan(start, stop, ybuf);
+                for (size_t i = 0; i < stop - start; i++) {
+                    if (xs[i] >= min.x && xs[i] <= max.x
+                        && ys[i] >= min.y && ys[i] <= max.y)
+                        grid[DensityCellIndex(map.ToDevice(xs[i], ys[i]), pos, cell, width, height)]++;
+                }
+            }
+        };
+
+        size_t len = Len();
+        size_t nblocks = std::thread::hardware_concurrency();
+        if (!m_workers || len < PARALLEL_DENSITY_MIN || nblocks < 2) {
+            count(0, len, counts);
+            return;
+        }
+
+        std::vector<std::vector<unsigned int> > grids(nblocks, std::vector<unsigned int>(counts.size(), 0));
+        for (size_t j = 0; j < nblocks; j++) {
+            size_t begin = len * j / nblocks, end = len * (j + 1) / nblocks;
+            std::vector<unsigned int> *grid = &grids[j];
+            m_workers->Queue([&count, begin, end, grid]() { count(begin, end, *grid); });
+        }
+        m_workers->Wait();
+
+        for (size_t j = 0; j < nblocks; j++)
+            for (size_t i = 0; i < counts.size(); i++)
+                counts[i] += grids[j][i];
+    }
 };
 
 enum {
@@ -125,6 +178,7 @@ wxDVScatterPlotCtrl::wxDVScatterPlotCtrl(wxWindow *parent, wxWindowID id, const
     m_xDataIndex = -1;
 
     m_showLine = false;
+    m_densityThreshold = DEFAULT_DENSITY_THRESHOLD;
 }
 
 wxDVScatterPlotCtrl::~wxDVScatterPlotCtrl() {
@@ -148,6 +202,12 @@ void wxDVScatterPlotCtrl::ReadState(std::string filename) {
     // Must manually call the function as wxWidgets does not emit a signal when a widget state is set programmatically
     ShowLine();
 
+    key = prefix + "DensityThreshold";
+    long threshold;
+    cfg.Read(key, &threshold, (long) DEFAULT_DENSITY_THRESHOLD);
+    if (threshold >= 0)
+        SetDensityThreshold((size_t) threshold);
+
     key = prefix + "Selections";
     success = cfg.Read(key, &s);
     if (debugging) assert(success);
@@ -198,6 +258,11 @@ void wxDVScatterPlotCtrl::WriteState(std::string filename) {
     success = cfg.Write(key, s.c_str());
     if (debugging) assert(success);
 
+    key = prefix + "DensityThreshold";
+    s = wxString::Format(wxT("%lu"), (unsigned long) m_densityThreshold);
+    success = cfg.Write(key, s.c_str());
+    if (debugging) assert(success);
+
     auto selections = m_dataSelectionList->GetSelectionsInCol();
     for (auto selection : selections) {
         ss << selection;
@@ -276,6 +341,15 @@ void wxDVScatterPlotCtrl::AddYAxisChannel(int index) {
     RefreshDisabledCheckBoxes();
 }
 
+void wxDVScatterPlotCtrl::SetDensityThreshold(size_t npoints) {
+    if (m_densityThreshold == npoints) return;
+
+    m_densityThreshold = npoints;
+    UpdatePlotWithChannelSelections();
+    m_plotSurface->Invalidate();
+    m_plotSurface->Refresh();
+}
+
 bool wxDVScatterPlotCtrl::IsAnythingSelected() {
     return m_dataSelectionList->GetNumberOfSelections() > 0;
 }
@@ -298,8 +372,10 @@ void wxDVScatterPlotCtrl::UpdatePlotWithChannelSelections() {
     size_t NumY2AxisSelections = 0;
     for (size_t i = 0; i < m_yDataIndices.size(); i++) {
         if ((size_t) m_yDataIndices[i] < m_dataSets.size()) {
-            wxDVScatterPlot *p = new wxDVScatterPlot(m_dataSets[m_xDataIndex], m_dataSets[m_yDataIndices[i]]);
+            wxDVScatterPlot *p = new wxDVScatterPlot(m_dataSets[m_xDataIndex], m_dataSets[m_yDataIndices[i]],
+                                                     &m_workers);
             p->SetLineOfPerfectAgreementFlag(m_showLine);
+            p->SetDensityThreshold(m_densityThreshold);
             p->SetLabel(m_dataSets[m_yDataIndices[i]]->GetSeriesTitle());
             p->SetSize(2);
             p->SetColour(m_dataSelectionList->GetColourForIndex(m_yDataIndices[i]));
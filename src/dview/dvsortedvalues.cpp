@@ -0,0 +1,151 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "wex/dview/dvsortedvalues.h"
+#include "wex/dview/dvtimeseriesdataset.h"
+#include "wex/dview/dvworkerpool.h"
+
+//Fewer values than this are sorted on the calling thread.
+static const size_t PARALLEL_SORT_MIN = 1 << 16;
+
+std::shared_ptr<const wxDVSortedValues> wxDVSortedValues::Get(wxDVTimeSeriesDataSet *d, bool ignoreZeros) {
+    typedef std::pair<wxDVTimeSeriesDataSet *, bool> Key;
+    static std::mutex registryMutex;
+    static std::map<Key, std::weak_ptr<const wxDVSortedValues> > registry;
+
+    std::shared_ptr<const wxDVSortedValues> all;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::shared_ptr<const wxDVSortedValues> s = registry[Key(d, ignoreZeros)].lock();
+        if (s && s->GetDataVersion() == d->GetVersion())
+            return s;
+        if (ignoreZeros) {
+            all = registry[Key(d, false)].lock();
+            if (all && all->GetDataVersion() != d->GetVersion())
+                all.reset();
+        }
+    }
+
+    //Sort without holding the registry; another view asking at the same time just sorts twice.
+    std::shared_ptr<const wxDVSortedValues> s;
+    if (all)
+        s = WithoutZeros(*all);
+    else
+        s = std::make_shared<wxDVSortedValues>(d, ignoreZeros);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    //Forget the data sets whose views are all gone while we are at it.
+    for (auto it = registry.begin(); it != registry.end();) {
+        if (it->second.expired())
+            it = registry.erase(it);
+        else
+            ++it;
+    }
+    registry[Key(d, ignoreZeros)] = s;
+    return s;
+}
+
+void wxDVSortedValues::Sort(std::vector<double> &values) {
+    size_t nthreads = std::thread::hardware_concurrency();
+    if (values.size() < PARALLEL_SORT_MIN || nthreads < 2) {
+        std::sort(values.begin(), values.end());
+        return;
+    }
+
+    //Runs are [bounds[j], bounds[j + 1]).
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= nthreads; i++)
+        bounds.push_back(values.size() * i / nthreads);
+
+    wxDVWorkerPool workers(nthreads);
+    for (size_t j = 0; j + 1 < bounds.size(); j++) {
+        std::vector<double>::iterator first = values.begin() + bounds[j], last = values.begin() + bounds[j + 1];
+        workers.Queue([first, last]() { std::sort(first, last); });
+    }
+    workers.Wait();
+
+    //Merge neighbouring runs in pairs until one is left; an odd run out waits for the next round.
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged;
+        size_t runs = bounds.size() - 1;
+        for (size_t j = 0; j < runs; j += 2) {
+            merged.push_back(bounds[j]);
+            if (j + 1 < runs) {
+                std::vector<double>::iterator first = values.begin() + bounds[j],
+                        middle = values.begin() + bounds[j + 1], last = values.begin() + bounds[j + 2];
+                workers.Queue([first, middle, last]() { std::inplace_merge(first, middle, last); });
+            }
+        }
+        merged.push_back(values.size());
+        workers.Wait();
+        bounds.swap(merged);
+    }
+}
+
+wxDVSortedValues::wxDVSortedValues(wxDVTimeSeriesDataSet *d, bool ignoreZeros)
+        : m_data(d), m_dataLength(d->Length()), m_ignoreZeros(ignoreZeros) {
+    m_values.reserve(m_dataLength);
+    std::vector<double> buf;
+    for (size_t start = 0; start < m_dataLength; start += wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE) {
+        size_t end = (m_dataLength - start > wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE)
+                     ? start + wxDVTimeSeriesDataSet::SPAN_CHUNK_SIZE : m_dataLength;
+        const double *y = d->GetYSpan(start, end, buf);
+        for (size_t i = 0; i < end - start; i++) {
+            if (wxDVTimeSeriesDataSet::IsMissing(y[i])) continue;
+            if (!ignoreZeros || y[i] != 0.0)
+                m_values.push_back(y[i]);
+        }
+    }
+    Sort(m_values);
+    //Read after the values: loading a lazy data set moves its version on.
+    m_dataVersion = d->GetVersion();
+}
+
+std::shared_ptr<const wxDVSortedValues> wxDVSortedValues::WithoutZeros(const wxDVSortedValues &all) {
+    std::shared_ptr<wxDVSortedValues> s(new wxDVSortedValues());
+    s->m_data = all.m_data;
+    s->m_dataLength = all.m_dataLength;
+    s->m_dataVersion = all.m_dataVersion;
+    s->m_ignoreZeros = true;
+    //The zeros (and negative zeros) sit together in the sorted values.
+    std::pair<std::vector<double>::const_iterator, std::vector<double>::const_iterator> zeros
+            = std::equal_range(all.m_values.begin(), all.m_values.end(), 0.0);
+    s->m_values.reserve(all.m_values.size() - (zeros.second - zeros.first));
+    s->m_values.insert(s->m_values.end(), all.m_values.begin(), zeros.first);
+    s->m_values.insert(s->m_values.end(), zeros.second, all.m_values.end());
+    return s;
+}
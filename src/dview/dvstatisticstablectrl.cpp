@@ -115,6 +115,17 @@ void dvStatisticsTreeModelNode::RemoveAllChildren() {
     m_children.clear();
 }
 
+void dvStatisticsTreeModelNode::SetValues(double avg, double min, double max, double sum, double stdev,
+                                          double avgdailymin, double avgdailymax) {
+    m_avg = avg;
+    m_min = min;
+    m_max = max;
+    m_sum = sum;
+    m_stdev = stdev;
+    m_avgdailymin = avgdailymin;
+    m_avgdailymax = avgdailymax;
+}
+
 wxString dvStatisticsTreeModelNode::GetName() {
     return m_nodeName;
 }
@@ -362,6 +373,61 @@ void dvStatisticsTreeModel::Refresh(std::vector<wxDVVariableStatistics *> stats,
     }
 }
 
+bool dvStatisticsTreeModel::UpdateValues(std::vector<wxDVVariableStatistics *> stats, bool showMonths) {
+    if (m_root == NULL)
+        return false;
+
+    //Walk the nodes in the order Refresh created them.
+    std::vector<dvStatisticsTreeModelNode *> groupNodes;
+    std::vector<unsigned int> nextChild;
+    for (size_t i = 0; i < stats.size(); i++) {
+        size_t g = 0;
+        while (g < groupNodes.size() && groupNodes[g]->GetName() != stats[i]->GetGroupName())
+            g++;
+        if (g == groupNodes.size()) {
+            dvStatisticsTreeModelNode *groupNode = m_root->GetNthChild(g);
+            if (groupNode == NULL || groupNode->GetName() != stats[i]->GetGroupName())
+                return false;
+            groupNodes.push_back(groupNode);
+            nextChild.push_back(0);
+        }
+
+        wxDVStatisticsDataSet *ds = stats[i]->GetDataSet();
+        wxString name = ds->GetSeriesTitle() + " (" + ds->GetUnits() + ")";
+        StatisticsPoint p;
+
+        if (showMonths) {
+            dvStatisticsTreeModelNode *variableNode = groupNodes[g]->GetNthChild(nextChild[g]++);
+            if (variableNode == NULL || variableNode->GetName() != name ||
+                variableNode->GetChildCount() != ds->Length())
+                return false;
+
+            for (size_t j = 0; j < ds->Length(); j++) {
+                p = ds->At(j);
+                dvStatisticsTreeModelNode *monthNode = variableNode->GetNthChild(j);
+                if (monthNode->GetName() != p.name)
+                    return false;
+                monthNode->SetValues(p.Mean, p.Min, p.Max, p.Sum, p.StDev, p.AvgDailyMin, p.AvgDailyMax);
+                ItemChanged(wxDataViewItem(monthNode));
+            }
+        } else {
+            for (size_t j = 0; j < ds->Length(); j++) {
+                if (ds->At(j).name == "Total") {
+                    p = ds->At(j);
+                    dvStatisticsTreeModelNode *variableNode = groupNodes[g]->GetNthChild(nextChild[g]++);
+                    if (variableNode == NULL || variableNode->GetName() != name)
+                        return false;
+                    variableNode->SetValues(p.Mean, p.Min, p.Max, p.Sum, p.StDev, p.AvgDailyMin, p.AvgDailyMax);
+                    ItemChanged(wxDataViewItem(variableNode));
+                    break;
+                }
+            }
+        }
+    }
+
+    return groupNodes.size() == m_root->GetChildCount();
+}
+
 wxDataViewItem dvStatisticsTreeModel::GetRoot() {
     return (wxDataViewItem) m_root;
 }
@@ -419,11 +485,14 @@ enum {
 BEGIN_EVENT_TABLE(wxDVStatisticsTableCtrl, wxPanel)
                 EVT_MENU_RANGE(ID_COPY_DATA_CLIP, ID_SEND_EXCEL, wxDVStatisticsTableCtrl::OnPopupMenu)
                 EVT_CHECKBOX(wxID_ANY, wxDVStatisticsTableCtrl::OnShowMonthsClick)
+                EVT_SHOW(wxDVStatisticsTableCtrl::OnShow)
 END_EVENT_TABLE()
 
 wxDVStatisticsTableCtrl::wxDVStatisticsTableCtrl(wxWindow *parent, wxWindowID id)
         : wxPanel(parent, id) {
     m_showMonths = false;
+    m_lastRequest = 0;
+    m_refreshQueued = false;
 
     m_ctrl = new wxDataViewCtrl(this, ID_STATISTICS_CTRL, wxDefaultPosition, wxSize(1040, 720),
         wxDV_MULTIPLE | wxDV_ROW_LINES | wxDV_VERT_RULES | wxDV_HORIZ_RULES);// | wxBORDER_NONE);
@@ -538,10 +607,81 @@ void wxDVStatisticsTableCtrl::RebuildDataViewCtrl() {
     if (item.IsOk()) { m_ctrl->Expand(item); }
 }
 
+void wxDVStatisticsTableCtrl::UpdateDataViewCtrl() {
+    if (!m_StatisticsModel->UpdateValues(m_variableStatistics, m_showMonths))
+        RebuildDataViewCtrl();
+}
+
 void wxDVStatisticsTableCtrl::AddDataSet(wxDVTimeSeriesDataSet *d) {
     wxDVStatisticsDataSet *s = new wxDVStatisticsDataSet(d);
     wxDVVariableStatistics *p = new wxDVVariableStatistics(s, d->GetGroupName(), true);
     m_variableStatistics.push_back(p); //Add to data sets list.
+
+    if (d->IsLoaded()) // otherwise once it has been read, see OnShow
+        ComputeInBackground(s);
+}
+
+void wxDVStatisticsTableCtrl::WaitForStatistics() {
+    m_workers.Wait();
+}
+
+void wxDVStatisticsTableCtrl::ComputeInBackground(wxDVStatisticsDataSet *ds) {
+    size_t request = ++m_lastRequest;
+    m_pending[ds] = request;
+
+    m_workers.Queue([this, ds, request]() {
+        std::vector<StatisticsPoint> points;
+        ds->Compute(points);
+        CallAfter([this, ds, request, points]() { OnStatisticsReady(ds, request, points); });
+    });
+}
+
+void wxDVStatisticsTableCtrl::OnStatisticsReady(wxDVStatisticsDataSet *ds, size_t request,
+                                                const std::vector<StatisticsPoint> &points) {
+    //Drop the results if the data set was removed or updated since they were requested.
+    std::map<wxDVStatisticsDataSet *, size_t>::iterator it = m_pending.find(ds);
+    if (it == m_pending.end() || it->second != request)
+        return;
+    m_pending.erase(it);
+
+    ds->Clear();
+    ds->Alloc(points.size());
+    for (size_t i = 0; i < points.size(); i++)
+        ds->Append(points[i]);
+
+    //Results arriving together are shown with one refresh.
+    if (!m_refreshQueued) {
+        m_refreshQueued = true;
+        CallAfter(&wxDVStatisticsTableCtrl::OnStatisticsRefresh);
+    }
+}
+
+void wxDVStatisticsTableCtrl::OnStatisticsRefresh() {
+    m_refreshQueued = false;
+    UpdateDataViewCtrl();
+}
+
+void wxDVStatisticsTableCtrl::OnShow(wxShowEvent &e) {
+    e.Skip();
+    if (!e.IsShown()) return;
+
+    //Fill in the statistics of lazily read columns that have been read since they were added.
+    for (size_t i = 0; i < m_variableStatistics.size(); i++) {
+        wxDVStatisticsDataSet *ds = m_variableStatistics[i]->GetDataSet();
+        if (ds->Length() == 0 && ds->IsSourceLoaded() && m_pending.find(ds) == m_pending.end())
+            ComputeInBackground(ds);
+    }
+}
+
+void wxDVStatisticsTableCtrl::UpdateDataSet(wxDVTimeSeriesDataSet *d) {
+    for (size_t i = 0; i < m_variableStatistics.size(); i++) {
+        wxDVStatisticsDataSet *ds = m_variableStatistics[i]->GetDataSet();
+        if (ds->IsSourceDataset(d)) {
+            m_pending.erase(ds); // the results of an earlier request would be stale
+            ds->Update();
+            break;
+        }
+    }
 }
 
 bool wxDVStatisticsTableCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
@@ -549,6 +689,8 @@ bool wxDVStatisticsTableCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
     wxDVStatisticsDataSet *ds;
     int removedIndex = 0;
 
+    WaitForStatistics();
+
     //Find the plottable:
     for (size_t i = 0; i < m_variableStatistics.size(); i++) {
         ds = m_variableStatistics[i]->GetDataSet();
@@ -566,6 +708,7 @@ bool wxDVStatisticsTableCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
     //for (int i = 0; i<wxPLPlotCtrl::NPLOTPOS; i++)
     //	m_plotSurface->RemovePlot(plotToRemove);
 
+    m_pending.erase(m_variableStatistics[removedIndex]->GetDataSet());
     m_variableStatistics.erase(m_variableStatistics.begin() +
                                removedIndex); //This is more efficient than remove when we already know the index.
 
@@ -576,6 +719,8 @@ bool wxDVStatisticsTableCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
 
 void wxDVStatisticsTableCtrl::RemoveAllDataSets() {
     //Remove all data sets. Deleting a data set also deletes its plottable.
+    WaitForStatistics();
+    m_pending.clear();
     for (size_t i = 0; i < m_variableStatistics.size(); i++)
         delete m_variableStatistics[i];
 
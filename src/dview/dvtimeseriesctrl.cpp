@@ -55,6 +55,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <wex/radiochoice.h>
 
+#include "wex/dview/dvaggregate.h"
+#include "wex/dview/dvmemorybudget.h"
 #include "wex/dview/dvselectionlist.h"
 #include "wex/dview/dvtimeseriesctrl.h"
 #include "wex/dview/dvtimeseriesdataset.h"
@@ -79,7 +81,16 @@ enum {
     ID_TopCheckbox = wxID_HIGHEST + 1, ID_BottomCheckbox, ID_StatCheckbox, ID_Timer
 };
 
-class wxDVTimeSeriesPlot : public wxPLPlottable {
+//The average or sum of a summary period, or missing if all of its values were.
+static double PeriodSummary(double sum, double counter, wxDVStatType statType) {
+    if (counter == 0.0)
+        return wxDVTimeSeriesDataSet::MissingValue();
+    return statType == wxDV_AVERAGE ? sum / counter : sum;
+}
+
+//A summary plot is a memory budget entry: while it is not shown its points may be freed, and they are
+//built again from the aggregate when it is shown (see EnsureSummary).
+class wxDVTimeSeriesPlot : public wxPLPlottable, public wxDVMemoryBudget::Entry {
 private:
     wxDVTimeSeriesDataSet *m_data;
     wxColour m_colour;
@@ -88,10 +99,14 @@ private:
     bool m_ownsDataset;
     wxDVTimeSeriesPlot *m_stackedOnTopOf;
     bool m_stacked;
+    wxDVTimeSeriesDataSet *m_source; // the data set m_data summarizes, or m_data itself
+    std::shared_ptr<wxDVCalendarAggregate> m_aggregate; // periods of m_source, shared with the other views
+    size_t m_closedLength; // number of summary points before the last one, which may still change
+    wxPLPlot *m_surface; // a summary is shown when it is on this
 
 public:
     wxDVTimeSeriesPlot(wxDVTimeSeriesDataSet *ds, wxDVTimeSeriesType seriesType, bool OwnsDataset = false)
-            : m_data(ds), m_stackedOnTopOf(0) {
+            : m_data(ds), m_stackedOnTopOf(0), m_source(ds), m_closedLength(0), m_surface(0) {
         assert(ds != 0);
 
         // Note: defaulting to false really happens in wxDVTimeSeriesCtrl::ReadState
@@ -166,14 +181,18 @@ public:
         if (i >= m_data->Length())
             return wxRealPoint(std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN());
 
+        //Missing values stack as 0 so the areas stay closed.
+        wxRealPoint cur(m_data->At(i));
+        if (wxDVTimeSeriesDataSet::IsMissing(cur.y))
+            cur.y = 0.0;
+
         if (m_stackedOnTopOf != 0 && m_stackedOnTopOf != this) {
             wxRealPoint base(m_stackedOnTopOf->StackedAt(i, ybase));
             if (ybase) *ybase = base.y;
-            wxRealPoint cur(m_data->At(i));
             return wxRealPoint(cur.x, base.y + cur.y);
         } else {
             if (ybase) *ybase = 0;
-            return m_data->At(i);
+            return cur;
         }
     }
 
@@ -240,7 +259,7 @@ public:
                     points.push_back(map.ToDevice(base[base.size() - i - 1]));
             } else {
                 for (size_t i = 0; i < len; i++) {
-                    wxRealPoint p(At(i));
+                    wxRealPoint p(StackedAt(i));
                     if (p.x < wmin.x || p.x > wmax.x) continue;
                     if (m_style == wxDV_STEPPED) {
                         lowX = GetPeriodLowerBoundary(p.x, timeStep);
@@ -267,31 +286,29 @@ public:
             dc.Polygon(points.size(), &points[0], wxPLOutputDevice::WINDING_RULE);
         } else {
             // not stacked - just lines
+            bool lod = false;
 
             if (m_style == wxDV_NORMAL) {
-                len = m_data->Length();
-                if (m_data->At(0).x < wmin.x) { len++; }
-                if (m_data->At(m_data->Length() - 1).x > wmax.x) { len++; }
-
-                points.reserve(len);
-
                 //If this is a line plot then add a point at the left edge of the graph if there isn't one there in the data
                 if (m_style == wxDV_NORMAL && m_data->At(0).x < wmin.x) {
-                    for (size_t i = 1; i < m_data->Length(); i++) {
+                    size_t i = FindIndex(wmin.x, true);
+                    if (i < m_data->Length()) {
                         rpt = m_data->At(i);
                         rpt2 = m_data->At(i - 1);
-                        if (rpt.x > wmin.x) {
-                            tempY = rpt2.y + ((rpt.y - rpt2.y) * (wmin.x - rpt2.x) / (rpt.x - rpt2.x));
-                            points.push_back(map.ToDevice(wxRealPoint(wmin.x, tempY)));
-                            break;
-                        }
+                        tempY = rpt2.y + ((rpt.y - rpt2.y) * (wmin.x - rpt2.x) / (rpt.x - rpt2.x));
+                        points.push_back(map.ToDevice(wxRealPoint(wmin.x, tempY)));
                     }
                 }
 
                 // cull data points that get mapped to the same X coordinate on the device
                 // this is a much needed rendering optimization for large datasets
-                size_t i = 0;
-                size_t len_tmp = m_data->Length();
+                size_t i = FindIndex(wmin.x, false);
+                size_t len_tmp = FindIndex(wmax.x, true);
+                lod = AppendLODPoints(map, i, len_tmp, points);
+                if (lod)
+                    i = len_tmp;
+                else
+                    points.reserve(points.size() + len_tmp - i + 1);
                 while (i < len_tmp) {
                     rpt = m_data->At(i);
                     if (rpt.x < wmin.x || rpt.x > wmax.x) {
@@ -299,6 +316,13 @@ public:
                         continue;
                     }
 
+                    //A missing value breaks the line; keep it as a NaN point for DrawLines.
+                    if (wxDVTimeSeriesDataSet::IsMissing(rpt.y)) {
+                        points.push_back(rpt);
+                        i++;
+                        continue;
+                    }
+
                     wxRealPoint cur(map.ToDevice(rpt));
 
                     size_t jmin = i, jmax = i;
@@ -312,7 +336,7 @@ public:
                         rpt2_tmp = m_data->At(j);
                         wxRealPoint cur2(map.ToDevice(rpt2_tmp));
 
-                        if (wxRound(cur.x) != wxRound(cur2.x))
+                        if (wxRound(cur.x) != wxRound(cur2.x) || wxDVTimeSeriesDataSet::IsMissing(rpt2_tmp.y))
                             break;
 
                         if (rpt2_tmp.y > max) {
@@ -343,14 +367,12 @@ public:
 
                 //If this is a line plot then add a point at the right edge of the graph if there isn't one there in the data
                 if (m_style == wxDV_NORMAL && m_data->At(m_data->Length() - 1).x > wmax.x) {
-                    for (int k = m_data->Length() - 2; k >= 0; k--) {
-                        rpt = m_data->At(k);
-                        rpt2 = m_data->At(k + 1);
-                        if (rpt.x < wmax.x) {
-                            tempY = rpt.y + ((rpt2.y - rpt.y) * (wmax.x - rpt.x) / (rpt2.x - rpt.x));
-                            points.push_back(map.ToDevice(wxRealPoint(wmax.x, tempY)));
-                            break;
-                        }
+                    size_t k = FindIndex(wmax.x, false);
+                    if (k > 0) {
+                        rpt = m_data->At(k - 1);
+                        rpt2 = m_data->At(k);
+                        tempY = rpt.y + ((rpt2.y - rpt.y) * (wmax.x - rpt.x) / (rpt2.x - rpt.x));
+                        points.push_back(map.ToDevice(wxRealPoint(wmax.x, tempY)));
                     }
                 }
             } else {
@@ -429,12 +451,121 @@ public:
             wxRealPoint devpos, devsize;
             map.GetDeviceExtents(&devpos, &devsize);
 
-            if (points.size() > 4 * devsize.x) {
+            //the level of detail points are already bounded by the pixel columns
+            if (!lod && points.size() > 4 * devsize.x) {
                 dc.Text("too many data points: please zoom in", devpos);
                 return; // quit if 4x more x coord points than integer device units
             }
 
-            dc.Lines(points.size(), &points[0]);
+            DrawLines(dc, points);
+        }
+    }
+
+    //Index of the first point with x > hour (after) or x >= hour, by bisection since x is ordered.
+    size_t FindIndex(double hour, bool after) const {
+        size_t lo = 0, hi = m_data->Length();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            double x = m_data->At(mid).x;
+            if (after ? x <= hour : x < hour)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    //When many samples share a pixel column, draws points [start, end) from the data set's level of
+    //detail buckets instead of visiting every sample: the first, extreme and last values of each
+    //column, so at most 4 points per column trace the same line as the full resolution data.
+    //Returns false if the data set has no buckets or it isn't zoomed out far enough.
+    bool AppendLODPoints(const wxPLDeviceMapping &map, size_t start, size_t end, std::vector<wxRealPoint> &points) {
+        wxRealPoint devpos, devsize;
+        map.GetDeviceExtents(&devpos, &devsize);
+        double timeStep = m_data->GetTimeStep();
+        if (end <= start || devsize.x < 1 || timeStep <= 0)
+            return false;
+
+        //Buckets of at most half a pixel, so one straddling two columns shifts by less than a pixel.
+        double samplesPerPixel = (map.GetWorldMaximum().x - map.GetWorldMinimum().x) / (timeStep * devsize.x);
+        size_t level = 0;
+        while ((double) ((size_t) 2 << level) <= samplesPerPixel / 2)
+            level++;
+        if (level < wxDVLODPyramid::MIN_LEVEL)
+            return false;
+
+        size_t bucketSize = (size_t) 1 << level;
+        size_t first = (start + bucketSize - 1) / bucketSize, last = end / bucketSize;
+        std::vector<wxDVLODBucket> buckets;
+        if (last <= first || !m_data->GetLODBuckets(level, first, last, buckets) || buckets.size() != last - first)
+            return false;
+
+        double offset = m_data->GetOffset();
+        int column = 0;
+        double columnX = 0;
+        bool open = false;
+        wxDVLODBucket run = wxDVLODBucket::Empty();
+
+        auto flush = [&]() {
+            if (!open) return;
+            open = false;
+            double y[4] = {run.first, run.minFirst ? run.min : run.max, run.minFirst ? run.max : run.min, run.last};
+            for (size_t k = 0; k < 4; k++)
+                if (k == 0 || y[k] != y[k - 1])
+                    points.push_back(map.ToDevice(columnX, y[k]));
+        };
+
+        auto add = [&](size_t index, const wxDVLODBucket &b) {
+            double x = offset + index * timeStep;
+            if (b.AllMissing()) {
+                //A missing run breaks the line; keep one NaN point for DrawLines.
+                flush();
+                if (points.empty() || !wxDVTimeSeriesDataSet::IsMissing(points.back().y))
+                    points.push_back(wxRealPoint(x, b.first));
+                return;
+            }
+
+            int c = wxRound(map.ToDevice(x, 0).x);
+            if (open && c == column) {
+                run.Append(b);
+                return;
+            }
+            flush();
+            open = true;
+            column = c;
+            columnX = x;
+            run = b;
+        };
+
+        //The samples before the first and after the last whole bucket go in as one partial bucket each.
+        std::vector<double> buf;
+        auto addSamples = [&](size_t from, size_t to) {
+            if (from >= to) return;
+            const double *y = m_data->GetYSpan(from, to, buf);
+            wxDVLODBucket b = wxDVLODBucket::Sample(y[0]);
+            for (size_t i = 1; i < to - from; i++)
+                b.Append(wxDVLODBucket::Sample(y[i]));
+            add(from, b);
+        };
+
+        addSamples(start, first * bucketSize);
+        for (size_t b = 0; b < buckets.size(); b++)
+            add((first + b) * bucketSize, buckets[b]);
+        addSamples(last * bucketSize, end);
+        flush();
+
+        return true;
+    }
+
+    //Draws the runs of points between missing (NaN) ones as separate lines.
+    static void DrawLines(wxPLOutputDevice &dc, const std::vector<wxRealPoint> &points) {
+        size_t begin = 0;
+        for (size_t i = 0; i <= points.size(); i++) {
+            if (i == points.size() || wxDVTimeSeriesDataSet::IsMissing(points[i].y)) {
+                if (i - begin > 1)
+                    dc.Lines(i - begin, &points[begin]);
+                begin = i + 1;
+            }
         }
     }
 
@@ -530,7 +661,7 @@ public:
                 factor = m_data->GetTimeStep();
             }
 
-            if (wxDVArrayDataSet *arrdata = dynamic_cast<wxDVArrayDataSet *>(m_data)) {
+            if (wxDVArrayDataSetBase *arrdata = dynamic_cast<wxDVArrayDataSetBase *>(m_data)) {
                 if (divide) arrdata->SetY(i, m_data->At(i).y / factor);
                 else arrdata->SetY(i, m_data->At(i).y * factor);
             }
@@ -538,6 +669,71 @@ public:
     }
 
     wxDVTimeSeriesDataSet *GetDataSet() const { return m_data; }
+
+    wxDVTimeSeriesDataSet *GetSourceDataSet() const { return m_source; }
+
+    //Makes this plot's own data set an hourly, daily or monthly summary of source; see UpdateSummary.
+    void SetSourceDataSet(wxDVTimeSeriesDataSet *source, wxPLPlot *surface) {
+        m_source = source;
+        m_surface = surface;
+        m_aggregate = wxDVCalendarAggregate::Get(source);
+    }
+
+    //Builds the summary if it was put off, or evicted, until the plot is shown.
+    void EnsureSummary(wxDVStatType statType) {
+        if (m_source == m_data) return;
+
+        if (m_data->Length() == 0)
+            UpdateSummary(statType);
+        wxDVMemoryBudget::Get().Touch(this);
+    }
+
+    virtual size_t GetMemorySize() const {
+        return (m_source != m_data) ? m_data->Length() * 2 * sizeof(double) : 0;
+    }
+
+    virtual bool Evict() {
+        if (m_source == m_data || m_surface->ContainsPlot(this))
+            return false;
+
+        static_cast<wxDVPointArrayDataSet *>(m_data)->Clear();
+        m_closedLength = 0;
+        return true;
+    }
+
+    //Appends the average (or sum) of each hour, day or month of the source data set at the middle of the
+    //period, from the shared aggregate.  Only the last period is redone when points were appended.
+    void UpdateSummary(wxDVStatType statType) {
+        if (m_source == m_data) return;
+
+        wxDVCalendarPeriod kind = (m_seriesType == wxDV_HOURLY) ? wxDV_PERIOD_HOUR
+                                  : (m_seriesType == wxDV_DAILY) ? wxDV_PERIOD_DAY : wxDV_PERIOD_MONTH;
+        m_aggregate->Update();
+        size_t count = m_aggregate->GetPeriodCount(kind);
+        if (count < m_closedLength) // the source lost points that were already summarized; start over
+            m_closedLength = 0;
+
+        wxDVPointArrayDataSet *d2 = static_cast<wxDVPointArrayDataSet *>(m_data);
+        d2->Truncate(m_closedLength);
+
+        std::vector<wxDVPeriodStats> periods;
+        m_aggregate->GetPeriods(kind, m_closedLength, periods);
+
+        //Leave out the final point if it represents 12/31 24:00, which the system interprets as 1/1 0:00 and would create a point for January of the next year
+        size_t n = periods.size();
+        if (n > 0) {
+            double MaxHrs = m_source->GetMaxHours();
+            if (!(MaxHrs > 0.0 && fmod(MaxHrs, 8760.0) != 0))
+                n--;
+        }
+
+        for (size_t i = 0; i < n; i++)
+            d2->Append(wxRealPoint(periods[i].lower + (periods[i].upper - periods[i].lower) / 2.0,
+                                   PeriodSummary(periods[i].sum, periods[i].count, statType)));
+
+        m_closedLength = (count > 0) ? count - 1 : 0;
+        wxDVMemoryBudget::Get().Touch(this);
+    }
 };
 
 BEGIN_EVENT_TABLE(wxDVTimeSeriesSettingsDialog, wxDialog)
@@ -1188,7 +1384,7 @@ void wxDVTimeSeriesCtrl::OnSettings(wxCommandEvent &) {
                 m_plots[i]->SetStyle((wxDVTimeSeriesStyle) m_style);
                 m_plots[i]->UpdateSummaryData(m_statType == wxDV_AVERAGE ? true : false);
 
-                if (0 == dynamic_cast<wxDVArrayDataSet *>(m_plots[i]->GetDataSet()))
+                if (0 == dynamic_cast<wxDVArrayDataSetBase *>(m_plots[i]->GetDataSet()))
                     nonmodifiables += m_plots[i]->GetDataSet()->GetSeriesTitle() + "\n";
             }
 
@@ -1359,215 +1555,28 @@ void wxDVTimeSeriesCtrl::OnDataChannelSelection(wxCommandEvent &) {
 void wxDVTimeSeriesCtrl::AddDataSet(wxDVTimeSeriesDataSet *d, bool refresh_ui) {
     wxDVTimeSeriesPlot *p = 0;
 
-    //For daily and monthly time series create a dataset with the average x and y values for the day/month
-    //For stepped graphs we have to start the array with the average y value for the first period at x = 0, have each avg y value at the beginning of the period (leftmost x for the period),
-    //and end it with the average y value for the final period duplicated at x = max
-    double sum = 0.0;
-    double avg = 0.0;
-    double counter = 0.0;
+    //For hourly, daily and monthly time series create a dataset with the average (or sum) y value for each hour/day/month
+    //at the middle of the period, if the data is finer than that.
     double timestep = d->GetTimeStep();
-    double MinHrs = d->GetMinHours();
-    double MaxHrs = d->GetMaxHours();
-    wxDVArrayDataSet *d2 = 0;
-    bool IsDataSetEmpty = true;
 
     if (m_seriesType == wxDV_RAW) {
-        IsDataSetEmpty = false;
-    } else if (m_seriesType == wxDV_HOURLY && timestep < 1.0) {
-        //Create hourly data set (avg value of data by day) from m_data if timestep < 1
-        IsDataSetEmpty = false;
-        double nextHour = 0.0;
-        double currentHour = 0.0;
-
-        d2 = new wxDVArrayDataSet(d->GetSeriesTitle(), d->GetUnits(), 1.0 / timestep);
-        d2->SetGroupName(d->GetGroupName());
-
-        while (nextHour <= MinHrs) {
-            nextHour += 1.0;
-        }
-
-        currentHour = nextHour - 1.0;
-
-        for (size_t i = 0; i < d->Length(); i++) {
-            if (d->At(i).x >= nextHour) {
-                if (i != 0 && counter != 0) {
-                    avg = sum / counter;
-                    d2->Append(wxRealPoint((double) currentHour + (double) (nextHour - currentHour) / 2.0,
-                                           (m_statType == wxDV_AVERAGE ? avg : sum)));
-                    currentHour = nextHour;
-                    nextHour += 1;
-                }
-
-                counter = 0.0;
-                sum = 0.0;
-            }
-
-            counter += 1.0;
-            sum += d->At(i).y;
-        }
-
-        avg = sum / counter;
-
-        //Prevent appending the final point if it represents 12/31 24:00, which the system interprets as 1/1 0:00 and creates a point for January of the next year
-        if (MaxHrs > 0.0 && fmod(MaxHrs, 8760.0) != 0) {
-            d2->Append(wxRealPoint((double) currentHour + (double) (nextHour - currentHour) / 2.0,
-                                   (m_statType == wxDV_AVERAGE ? avg : sum)));
-        }
-    } else if (m_seriesType == wxDV_DAILY && timestep < 24.0) {
-        //Create daily data set (avg value of data by day) from m_data if timestep < 24
-        IsDataSetEmpty = false;
-        double nextDay = 0.0;
-        double currentDay = 0.0;
-
-        d2 = new wxDVArrayDataSet(d->GetSeriesTitle(), d->GetUnits(), 24.0 / timestep);
-        d2->SetGroupName(d->GetGroupName());
-
-        while (nextDay <= MinHrs) {
-            nextDay += 24.0;
-        }
-
-        currentDay = nextDay - 24.0;
-
-        for (size_t i = 0; i < d->Length(); i++) {
-            if (d->At(i).x >= nextDay) {
-                if (i != 0 && counter != 0) {
-                    avg = sum / counter;
-                    d2->Append(wxRealPoint((double) currentDay + (double) (nextDay - currentDay) / 2.0,
-                                           (m_statType == wxDV_AVERAGE ? avg : sum)));
-                    currentDay = nextDay;
-                    nextDay += 24.0;
-                }
-
-                counter = 0.0;
-                sum = 0.0;
-            }
-
-            counter += 1.0;
-            sum += d->At(i).y;
-        }
-
-        avg = sum / counter;
-
-        //Prevent appending the final point if it represents 12/31 24:00, which the system interprets as 1/1 0:00 and creates a point for January of the next year
-        if (MaxHrs > 0.0 && fmod(MaxHrs, 8760.0) != 0) {
-            d2->Append(wxRealPoint((double) currentDay + (double) (nextDay - currentDay) / 2.0,
-                                   (m_statType == wxDV_AVERAGE ? avg : sum)));
-        }
-    } else if (m_seriesType == wxDV_MONTHLY && timestep < 672.0)    //672 hours = 28 days = shortest possible month
+        p = new wxDVTimeSeriesPlot(d, m_seriesType);
+    } else if ((m_seriesType == wxDV_HOURLY && timestep < 1.0)
+               || (m_seriesType == wxDV_DAILY && timestep < 24.0)
+               || (m_seriesType == wxDV_MONTHLY && timestep < 672.0))    //672 hours = 28 days = shortest possible month
     {
-        //Create monthly data set (avg value of data by month) from m_data
-        IsDataSetEmpty = false;
-        double nextMonth = 0.0;
-        double currentMonth = 0.0;
-        double year = 0.0;
-
-        d2 = new wxDVArrayDataSet(d->GetSeriesTitle(), d->GetUnits(), 744.0 / timestep);
+        double periodSteps = (m_seriesType == wxDV_HOURLY) ? 1.0 : (m_seriesType == wxDV_DAILY) ? 24.0 : 744.0;
+        wxDVPointArrayDataSet *d2 = new wxDVPointArrayDataSet(d->GetSeriesTitle(), d->GetUnits(),
+                                                              periodSteps / timestep);
         d2->SetGroupName(d->GetGroupName());
 
-        while (MinHrs > 8760.0) {
-            year += 8760.0;
-            MinHrs -= 8760.0;
-        }
-
-        if (MinHrs >= 0.0 && MinHrs < 744.0) {
-            currentMonth = year;
-            nextMonth = year + 744.0;
-        }
-        else if (MinHrs >= 744.0 && MinHrs < 1416.0) {
-            currentMonth = year + 744.0;
-            nextMonth = year + 1416.0;
-        }
-        else if (MinHrs >= 1416.0 && MinHrs < 2160.0) {
-            currentMonth = year + 1416.0;
-            nextMonth = year + 2160.0;
-        }
-        else if (MinHrs >= 2160.0 && MinHrs < 2880.0) {
-            currentMonth = year + 2160.0;
-            nextMonth = year + 2880.0;
-        }
-        else if (MinHrs >= 2880.0 && MinHrs < 3624.0) {
-            currentMonth = year + 2880.0;
-            nextMonth = year + 3624.0;
-        }
-        else if (MinHrs >= 3624.0 && MinHrs < 4344.0) {
-            currentMonth = year + 3624.0;
-            nextMonth = year + 4344.0;
-        }
-        else if (MinHrs >= 4344.0 && MinHrs < 5088.0) {
-            currentMonth = year + 4344.0;
-            nextMonth = year + 5088.0;
-        }
-        else if (MinHrs >= 5088.0 && MinHrs < 5832.0) {
-            currentMonth = year + 5088.0;
-            nextMonth = year + 5832.0;
-        }
-        else if (MinHrs >= 5832.0 && MinHrs < 6552.0) {
-            currentMonth = year + 5832.0;
-            nextMonth = year + 6552.0;
-        }
-        else if (MinHrs >= 6552.0 && MinHrs < 7296.0) {
-            currentMonth = year + 6552.0;
-            nextMonth = year + 7296.0;
-        }
-        else if (MinHrs >= 7296.0 && MinHrs < 8016.0) {
-            currentMonth = year + 7296.0;
-            nextMonth = year + 8016.0;
-        }
-        else if (MinHrs >= 8016.0 && MinHrs < 8760.0) {
-            currentMonth = year + 8016.0;
-            nextMonth = year + 8760.0;
-        }
-
-        for (size_t i = 0; i < d->Length(); i++) {
-            if (d->At(i).x >= nextMonth) {
-                if (i != 0 && counter != 0) {
-                    avg = sum / counter;
-
-                    d2->Append(wxRealPoint((double) currentMonth + (double) (nextMonth - currentMonth) / 2.0,
-                                           (m_statType == wxDV_AVERAGE ? avg : sum)));
-
-                    currentMonth = nextMonth;
-                    if (nextMonth == 744.0 + year) { nextMonth = 1416.0 + year; }
-                    else if (nextMonth == 1416.0 + year) { nextMonth = 2160.0 + year; }
-                    else if (nextMonth == 2160.0 + year) { nextMonth = 2880.0 + year; }
-                    else if (nextMonth == 2880.0 + year) { nextMonth = 3624.0 + year; }
-                    else if (nextMonth == 3624.0 + year) { nextMonth = 4344.0 + year; }
-                    else if (nextMonth == 4344.0 + year) { nextMonth = 5088.0 + year; }
-                    else if (nextMonth == 5088.0 + year) { nextMonth = 5832.0 + year; }
-                    else if (nextMonth == 5832.0 + year) { nextMonth = 6552.0 + year; }
-                    else if (nextMonth == 6552.0 + year) { nextMonth = 7296.0 + year; }
-                    else if (nextMonth == 7296.0 + year) { nextMonth = 8016.0 + year; }
-                    else if (nextMonth == 8016.0 + year) { nextMonth = 8760.0 + year; }
-                    else if (nextMonth == 8760.0 + year) {
-                        year += 8760.0;
-                        nextMonth = 744.0 + year;
-                    }
-                }
-
-                counter = 0.0;
-                sum = 0.0;
-            }
-
-            counter += 1.0;
-            sum += d->At(i).y;
-        }
-
-        avg = sum / counter;
-
-        //Prevent appending the final point if it represents 12/31 24:00, which the system interprets as 1/1 0:00 and creates a point for January of the next year
-        if (MaxHrs > 0.0 && fmod(MaxHrs, 8760.0) != 0) {
-            d2->Append(wxRealPoint((double) currentMonth + (double) (nextMonth - currentMonth) / 2.0,
-                                   (m_statType == wxDV_AVERAGE ? avg : sum)));
-        }
+        p = new wxDVTimeSeriesPlot(d2, m_seriesType, true);
+        p->SetSourceDataSet(d, m_plotSurface);
+        if (d->IsLoaded()) //Columns that are not read yet are summarized once shown.
+            p->UpdateSummary(m_statType);
     }
 
-    if (!IsDataSetEmpty) {
-        if (m_seriesType == wxDV_RAW) {
-            p = new wxDVTimeSeriesPlot(d, m_seriesType);
-        } else {
-            p = new wxDVTimeSeriesPlot(d2, m_seriesType, true);
-        }
-
+    if (p) {
         p->SetStyle(m_style);
         m_plots.push_back(p); //Add to data sets list.
         m_dataSelector->Append(d->GetTitleWithUnits(), d->GetGroupName());
@@ -1579,12 +1588,49 @@ void wxDVTimeSeriesCtrl::AddDataSet(wxDVTimeSeriesDataSet *d, bool refresh_ui) {
     }
 }
 
+void wxDVTimeSeriesCtrl::UpdateDataSet(wxDVTimeSeriesDataSet *d, size_t prevLength) {
+    int index = -1;
+    for (size_t i = 0; i < m_plots.size(); i++) {
+        if (m_plots[i]->GetSourceDataSet() == d) {
+            index = i;
+            break;
+        }
+    }
+
+    if (index < 0) return;
+
+    //Keep following the end of the data if it was in view before the new points arrived.
+    bool showingEnd = prevLength > 0 && GetViewMax() >= d->At(prevLength - 1).x;
+
+    //A hidden summary that was not built yet, or was evicted, is built once it is shown.
+    bool selected = m_dataSelector->IsRowSelected(index);
+    if (selected || m_plots[index]->GetDataSet()->Length() > 0)
+        m_plots[index]->UpdateSummary(m_statType);
+
+    if (!selected)
+        return;
+
+    if (showingEnd) {
+        double min = GetViewMin();
+        double max = GetViewMax();
+        double dataMax = GetMaxPossibleTimeForVisibleChannels();
+        if (min <= GetMinPossibleTimeForVisibleChannels())
+            SetViewRange(min, dataMax); // showing all of the data: keep doing so
+        else
+            SetViewRange(dataMax - (max - min), dataMax);
+    } else {
+        if (m_topAutoScale || m_top2AutoScale || m_bottomAutoScale || m_bottom2AutoScale) { AutoscaleYAxis(true); }
+        UpdateScrollbarPosition();
+        Invalidate();
+    }
+}
+
 bool wxDVTimeSeriesCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
     wxDVTimeSeriesPlot *plotToRemove = NULL;
     int removedIndex = 0;
     //Find the plottable:
     for (size_t i = 0; i < m_plots.size(); i++) {
-        if (m_plots[i]->GetDataSet() == d) {
+        if (m_plots[i]->GetSourceDataSet() == d) {
             removedIndex = i;
             plotToRemove = m_plots[i];
             break;
@@ -1603,6 +1649,7 @@ bool wxDVTimeSeriesCtrl::RemoveDataSet(wxDVTimeSeriesDataSet *d) {
 
     // make sure an erased plot is nolonger referenced in stacking
     UpdateStacking();
+    delete plotToRemove;
 
     Invalidate();
 
@@ -2069,6 +2116,8 @@ void wxDVTimeSeriesCtrl::AddGraphAfterChannelSelection(wxPLPlotCtrl::PlotPos pPo
     size_t idx = (size_t) index;
     wxString YLabelText;
 
+    m_plots[idx]->EnsureSummary(m_statType);
+
     //Set our line colour correctly.  Assigned by data selection window.
     m_plots[idx]->SetColour(m_dataSelector->GetColourForIndex(index));
 
@@ -30,9 +30,33 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+
+#include <wx/log.h>
+
+#include "wex/dview/dvaggregate.h"
 #include "wex/dview/dvtimeseriesdataset.h"
 
-wxDVTimeSeriesDataSet::wxDVTimeSeriesDataSet() {
+//Versions are handed out from one sequence, so no two data sets share one.
+static std::atomic<unsigned long> s_nextVersion(1);
+
+wxDVTimeSeriesDataSet::wxDVTimeSeriesDataSet()
+        : m_version(s_nextVersion++) {
+}
+
+wxDVTimeSeriesDataSet::wxDVTimeSeriesDataSet(const wxDVTimeSeriesDataSet &d)
+        : m_metaData(d.m_metaData), m_groupName(d.m_groupName), m_version(s_nextVersion++) {
+}
+
+wxDVTimeSeriesDataSet &wxDVTimeSeriesDataSet::operator=(const wxDVTimeSeriesDataSet &d) {
+    m_metaData = d.m_metaData;
+    m_groupName = d.m_groupName;
+    NewVersion();
+    return *this;
+}
+
+void wxDVTimeSeriesDataSet::NewVersion() const {
+    m_version.store(s_nextVersion++, std::memory_order_release);
 }
 
 wxDVTimeSeriesDataSet::~wxDVTimeSeriesDataSet() {
@@ -42,6 +66,20 @@ wxString wxDVTimeSeriesDataSet::GetLabel() const {
     return GetTitleWithUnits();
 }
 
+const double *wxDVTimeSeriesDataSet::GetXSpan(size_t start, size_t end, std::vector<double> &buf) const {
+    buf.resize(end > start ? end - start : 0);
+    for (size_t i = start; i < end; i++)
+        buf[i - start] = At(i).x;
+    return buf.empty() ? 0 : &buf[0];
+}
+
+const double *wxDVTimeSeriesDataSet::GetYSpan(size_t start, size_t end, std::vector<double> &buf) const {
+    buf.resize(end > start ? end - start : 0);
+    for (size_t i = start; i < end; i++)
+        buf[i - start] = At(i).y;
+    return buf.empty() ? 0 : &buf[0];
+}
+
 /* Helper Functions */
 wxString wxDVTimeSeriesDataSet::GetTitleWithUnits() const {
     wxString units(GetUnits());
@@ -54,11 +92,15 @@ wxRealPoint wxDVTimeSeriesDataSet::operator[](size_t i) const {
 }
 
 double wxDVTimeSeriesDataSet::GetMinHours() {
-    return At(0).x;
+    std::vector<double> buf; // x only, so a lazy data set isn't read for it
+    return GetXSpan(0, 1, buf)[0];
 }
 
 double wxDVTimeSeriesDataSet::GetMaxHours() {
-    return At(Length() - 1).x;
+    if (Length() == 0)
+        return GetMinHours();
+    std::vector<double> buf;
+    return GetXSpan(Length() - 1, Length(), buf)[0];
 }
 
 double wxDVTimeSeriesDataSet::GetTotalHours() {
@@ -70,16 +112,26 @@ void wxDVTimeSeriesDataSet::GetMinAndMaxInRange(double *min, double *max,
     if (endIndex > Length())
         endIndex = Length();
 
-    double myMin = At(startIndex).y;
-    double myMax = At(startIndex).y;
-
-    for (size_t i = startIndex + 1; i < endIndex; i++) {
-        if (At(i).y < myMin)
-            myMin = At(i).y;
-        if (At(i).y > myMax)
-            myMax = At(i).y;
+    //Comparisons with a missing value are false, so these skip them without branching.
+    double first = At(startIndex).y;
+    double myMin = IsMissing(first) ? std::numeric_limits<double>::infinity() : first;
+    double myMax = IsMissing(first) ? -std::numeric_limits<double>::infinity() : first;
+
+    if (!QueryMinMaxIndex(startIndex, endIndex, &myMin, &myMax)) {
+        std::vector<double> buf;
+        for (size_t start = startIndex; start < endIndex; start += SPAN_CHUNK_SIZE) {
+            size_t end = (endIndex - start > SPAN_CHUNK_SIZE) ? start + SPAN_CHUNK_SIZE : endIndex;
+            const double *y = GetYSpan(start, end, buf);
+            for (size_t i = 0; i < end - start; i++) {
+                myMin = (y[i] < myMin) ? y[i] : myMin;
+                myMax = (y[i] > myMax) ? y[i] : myMax;
+            }
+        }
     }
 
+    if (myMin > myMax) //nothing but missing values
+        myMin = myMax = 0.0;
+
     if (min)
         *min = myMin;
     if (max)
@@ -106,491 +158,863 @@ void wxDVTimeSeriesDataSet::GetDataMinAndMax(double *min, double *max) {
     GetMinAndMaxInRange(min, max, size_t(0), Length());
 }
 
+bool wxDVTimeSeriesDataSet::QueryMinMaxIndex(size_t, size_t, double *, double *) const {
+    return false;
+}
+
+bool wxDVTimeSeriesDataSet::GetLODBuckets(size_t, size_t, size_t, std::vector<wxDVLODBucket> &) const {
+    return false;
+}
+
 std::vector<wxRealPoint> wxDVTimeSeriesDataSet::GetDataVector() {
+    size_t len = Length();
     std::vector<wxRealPoint> pp;
-    pp.reserve(Length());
-    for (size_t i = 0; i < Length(); i++)
-        pp.push_back(At(i));
+    pp.reserve(len);
+
+    std::vector<double> xbuf, ybuf;
+    for (size_t start = 0; start < len; start += SPAN_CHUNK_SIZE) {
+        size_t end = (len - start > SPAN_CHUNK_SIZE) ? start + SPAN_CHUNK_SIZE : len;
+        const double *x = GetXSpan(start, end, xbuf);
+        const double *y = GetYSpan(start, end, ybuf);
+        for (size_t i = 0; i < end - start; i++)
+            pp.push_back(wxRealPoint(x[i], y[i]));
+    }
     return pp;
 }
 
-// ******** Array data set *********** //
+// ******** Min/max index *********** //
 
-wxDVArrayDataSet::wxDVArrayDataSet()
+wxDVMinMaxIndex::wxDVMinMaxIndex()
+        : m_valid(0), m_length(0) {
+}
+
+wxDVMinMaxIndex::wxDVMinMaxIndex(const wxDVMinMaxIndex &)
+        : m_valid(0), m_length(0) {
+}
+
+wxDVMinMaxIndex &wxDVMinMaxIndex::operator=(const wxDVMinMaxIndex &) {
+    Invalidate();
+    return *this;
+}
+
+void wxDVMinMaxIndex::Invalidate(size_t index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index < m_valid)
+        m_valid = index;
+}
+
+void wxDVMinMaxIndex::Update(const wxDVTimeSeriesDataSet &d) {
+    size_t len = d.Length();
+    if (m_valid == len && m_length == len && !m_mins.empty())
+        return;
+
+    size_t nblocks = (len + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t firstBlock = std::min(m_valid, len) / BLOCK_SIZE;
+    if (m_mins.empty()) {
+        m_mins.resize(1);
+        m_maxs.resize(1);
+    }
+    m_mins[0].resize(nblocks);
+    m_maxs[0].resize(nblocks);
+
+    //Comparisons with a missing value are false, so a block of them keeps +/-infinity.
+    std::vector<double> buf;
+    for (size_t b = firstBlock; b < nblocks; b++) {
+        size_t start = b * BLOCK_SIZE;
+        size_t end = std::min(start + BLOCK_SIZE, len);
+        const double *y = d.GetYSpan(start, end, buf);
+        double mn = std::numeric_limits<double>::infinity();
+        double mx = -std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < end - start; i++) {
+            mn = (y[i] < mn) ? y[i] : mn;
+            mx = (y[i] > mx) ? y[i] : mx;
+        }
+        m_mins[0][b] = mn;
+        m_maxs[0][b] = mx;
+    }
+
+    //Only entries that cover a recomputed block change on the upper levels.
+    size_t levels = 1;
+    while (((size_t) 2 << (levels - 1)) <= nblocks)
+        levels++;
+    m_mins.resize(levels);
+    m_maxs.resize(levels);
+    for (size_t k = 1; k < levels; k++) {
+        size_t span = (size_t) 1 << k, half = span / 2;
+        size_t n = nblocks - span + 1;
+        m_mins[k].resize(n);
+        m_maxs[k].resize(n);
+        for (size_t j = (firstBlock >= span ? firstBlock - span + 1 : 0); j < n; j++) {
+            m_mins[k][j] = std::min(m_mins[k - 1][j], m_mins[k - 1][j + half]);
+            m_maxs[k][j] = std::max(m_maxs[k - 1][j], m_maxs[k - 1][j + half]);
+        }
+    }
+
+    m_valid = m_length = len;
+}
+
+void wxDVMinMaxIndex::Query(const wxDVTimeSeriesDataSet &d, size_t start, size_t end, double *min, double *max) {
+    if (start >= end)
+        return;
+
+    double mn = *min, mx = *max;
+    size_t first = (start + BLOCK_SIZE - 1) / BLOCK_SIZE; // whole blocks [first, last)
+    size_t last = end / BLOCK_SIZE;
+
+    std::vector<double> buf;
+    if (last <= first + 1) {
+        //not worth the index
+        const double *y = d.GetYSpan(start, end, buf);
+        for (size_t i = 0; i < end - start; i++) {
+            mn = (y[i] < mn) ? y[i] : mn;
+            mx = (y[i] > mx) ? y[i] : mx;
+        }
+    } else {
+        size_t headEnd = first * BLOCK_SIZE, tailStart = last * BLOCK_SIZE;
+        if (start < headEnd) {
+            const double *y = d.GetYSpan(start, headEnd, buf);
+            for (size_t i = 0; i < headEnd - start; i++) {
+                mn = (y[i] < mn) ? y[i] : mn;
+                mx = (y[i] > mx) ? y[i] : mx;
+            }
+        }
+        if (tailStart < end) {
+            const double *y = d.GetYSpan(tailStart, end, buf);
+            for (size_t i = 0; i < end - tailStart; i++) {
+                mn = (y[i] < mn) ? y[i] : mn;
+                mx = (y[i] > mx) ? y[i] : mx;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Update(d);
+        size_t k = 0;
+        while (((size_t) 2 << k) <= last - first)
+            k++;
+        size_t j = last - ((size_t) 1 << k);
+        mn = std::min(mn, std::min(m_mins[k][first], m_mins[k][j]));
+        mx = std::max(mx, std::max(m_maxs[k][first], m_maxs[k][j]));
+    }
+
+    *min = mn;
+    *max = mx;
+}
+
+// ******** Level of detail *********** //
+
+wxDVLODBucket wxDVLODBucket::Sample(double y) {
+    wxDVLODBucket b;
+    b.first = b.last = y;
+    b.min = wxDVTimeSeriesDataSet::IsMissing(y) ? std::numeric_limits<double>::infinity() : y;
+    b.max = wxDVTimeSeriesDataSet::IsMissing(y) ? -std::numeric_limits<double>::infinity() : y;
+    b.minFirst = true;
+    return b;
+}
+
+void wxDVLODBucket::Append(const wxDVLODBucket &next) {
+    //Ties keep the earlier sample, as the full resolution culling does.
+    bool minNext = next.min < min, maxNext = next.max > max;
+    if (minNext != maxNext)
+        minFirst = maxNext;
+    else if (minNext)
+        minFirst = next.minFirst;
+
+    if (minNext) min = next.min;
+    if (maxNext) max = next.max;
+    if (AllMissing()) first = next.first;
+    if (!next.AllMissing()) last = next.last;
+}
+
+wxDVLODPyramid::wxDVLODPyramid()
+        : m_valid(0), m_length(0) {
+}
+
+wxDVLODPyramid::wxDVLODPyramid(const wxDVLODPyramid &)
+        : m_valid(0), m_length(0) {
+}
+
+wxDVLODPyramid &wxDVLODPyramid::operator=(const wxDVLODPyramid &) {
+    Invalidate();
+    return *this;
+}
+
+void wxDVLODPyramid::Invalidate(size_t index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index < m_valid)
+        m_valid = index;
+}
+
+void wxDVLODPyramid::Update(const wxDVTimeSeriesDataSet &d) {
+    size_t len = d.Length();
+    if (m_valid == len && m_length == len && !m_levels.empty())
+        return;
+
+    size_t bucketSize = (size_t) 1 << MIN_LEVEL;
+    size_t nbuckets = (len + bucketSize - 1) / bucketSize;
+    size_t firstBucket = std::min(m_valid, len) / bucketSize;
+    if (m_levels.empty())
+        m_levels.resize(1);
+    m_levels[0].resize(nbuckets);
+
+    std::vector<double> buf;
+    for (size_t b = firstBucket; b < nbuckets; b++) {
+        size_t start = b * bucketSize;
+        size_t end = std::min(start + bucketSize, len);
+        const double *y = d.GetYSpan(start, end, buf);
+        wxDVLODBucket bucket = wxDVLODBucket::Sample(y[0]);
+        for (size_t i = 1; i < end - start; i++)
+            bucket.Append(wxDVLODBucket::Sample(y[i]));
+        m_levels[0][b] = bucket;
+    }
+
+    //Each level pairs up the buckets of the one below, down to a single bucket.
+    size_t k = 1;
+    for (; m_levels[k - 1].size() > 1; k++) {
+        if (m_levels.size() <= k)
+            m_levels.resize(k + 1);
+        const std::vector<wxDVLODBucket> &lower = m_levels[k - 1];
+        std::vector<wxDVLODBucket> &level = m_levels[k];
+        level.resize((lower.size() + 1) / 2);
+        firstBucket /= 2;
+        for (size_t b = firstBucket; b < level.size(); b++) {
+            level[b] = lower[2 * b];
+            if (2 * b + 1 < lower.size())
+                level[b].Append(lower[2 * b + 1]);
+        }
+    }
+    m_levels.resize(k);
+
+    m_valid = m_length = len;
+}
+
+void wxDVLODPyramid::Query(const wxDVTimeSeriesDataSet &d, size_t level, size_t first, size_t end,
+                           std::vector<wxDVLODBucket> &buckets) {
+    buckets.clear();
+    if (level < MIN_LEVEL)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Update(d);
+
+    //the top level's single bucket covers the data set at any higher level too
+    const std::vector<wxDVLODBucket> &lod = m_levels[std::min<size_t>(level - MIN_LEVEL, m_levels.size() - 1)];
+    end = std::min(end, lod.size());
+    if (first < end)
+        buckets.assign(lod.begin() + first, lod.begin() + end);
+}
+
+// ******** Array data sets *********** //
+
+wxDVArrayDataSetBase::wxDVArrayDataSetBase()
         : m_timestep(1), m_offset(0) {
 }
 
+wxDVArrayDataSetBase::wxDVArrayDataSetBase(const wxString &var, const wxString &units, double offset,
+                                           double timestep, const std::vector<double> &data)
+        : m_varLabel(var), m_varUnits(units), m_timestep(timestep), m_offset(offset), m_yData(data) {
+}
+
+size_t wxDVArrayDataSetBase::Length() const {
+    return m_yData.size();
+}
+
+double wxDVArrayDataSetBase::GetTimeStep() const {
+    return m_timestep;
+}
+
+double wxDVArrayDataSetBase::GetOffset() const {
+    return m_offset;
+}
+
+wxString wxDVArrayDataSetBase::GetSeriesTitle() const {
+    return m_varLabel;
+}
+
+wxString wxDVArrayDataSetBase::GetUnits() const {
+    return m_varUnits;
+}
+
+const double *wxDVArrayDataSetBase::GetYSpan(size_t start, size_t end, std::vector<double> &buf) const {
+    if (start < end && end <= m_yData.size())
+        return &m_yData[start];
+    return wxDVTimeSeriesDataSet::GetYSpan(start, end, buf);
+}
+
+bool wxDVArrayDataSetBase::QueryMinMaxIndex(size_t start, size_t end, double *min, double *max) const {
+    m_minMaxIndex.Query(*this, start, end, min, max);
+    return true;
+}
+
+void wxDVArrayDataSetBase::YDataChanged(size_t index) const {
+    m_minMaxIndex.Invalidate(index);
+    NewVersion();
+}
+
+void wxDVArrayDataSetBase::SetY(size_t i, double y) {
+    if (i < m_yData.size()) {
+        m_yData[i] = y;
+        YDataChanged(i);
+    }
+}
+
+void wxDVArrayDataSetBase::SetSeriesTitle(const wxString &title) {
+    m_varLabel = title;
+}
+
+void wxDVArrayDataSetBase::SetUnits(const wxString &units) {
+    m_varUnits = units;
+}
+
+void wxDVArrayDataSetBase::SetTimeStep(double ts) {
+    m_timestep = ts;
+}
+
+void wxDVArrayDataSetBase::SetOffset(double off) {
+    m_offset = off;
+}
+
+void wxDVArrayDataSetBase::SetTimeStep(double ts, bool) {
+    m_timestep = ts;
+}
+
+void wxDVArrayDataSetBase::SetOffset(double off, bool) {
+    m_offset = off;
+}
+
+void wxDVArrayDataSetBase::RecomputeXData() {
+}
+
+//True if sample i at x is where a series starting at offset with the given timestep has it.
+static bool IsOnGrid(double offset, double timestep, size_t i, double x) {
+    double expected = offset + i * timestep;
+    return fabs(x - expected) <= 1e-6 * std::max(1.0, fabs(expected));
+}
+
+wxDVArrayDataSetBase *wxDVArrayDataSetBase::Create(const wxString &var, const std::vector<wxRealPoint> &data) {
+    double timestep = (data.size() > 1) ? data[1].x - data[0].x : 1.0;
+    for (size_t i = 2; i < data.size(); i++)
+        if (!IsOnGrid(data[0].x, timestep, i, data[i].x))
+            return new wxDVPointArrayDataSet(var, data);
+    return new wxDVArrayDataSet(var, data);
+}
+
+wxDVArrayDataSet::wxDVArrayDataSet()
+        : m_offGridReported(false) {
+}
+
 wxDVArrayDataSet::wxDVArrayDataSet(const wxString &var, const std::vector<double> &data)
-        : m_varLabel(var), m_timestep(1), m_offset(0) {
-    Copy(data);
+        : wxDVArrayDataSetBase(var, wxEmptyString, 0, 1, data), m_offGridReported(false) {
 }
 
 wxDVArrayDataSet::wxDVArrayDataSet(const wxString &var, const std::vector<wxRealPoint> &data)
-        : m_varLabel(var), m_timestep(1), m_offset(0), m_pData(data) {
+        : wxDVArrayDataSetBase(var, wxEmptyString, 0, 1, std::vector<double>()), m_offGridReported(false) {
+    if (data.size() > 0)
+        m_offset = data[0].x;
+    if (data.size() > 1 && data[1].x > data[0].x)
+        m_timestep = data[1].x - data[0].x;
+
+    m_yData.resize(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        CheckX(i, data[i].x);
+        m_yData[i] = data[i].y;
+    }
 }
 
 wxDVArrayDataSet::wxDVArrayDataSet(const wxString &var, const wxString &units, const double &timestep)
-        : m_varLabel(var), m_varUnits(units), m_timestep(timestep), m_offset(0) {
+        : wxDVArrayDataSetBase(var, units, 0, timestep, std::vector<double>()), m_offGridReported(false) {
 }
 
 wxDVArrayDataSet::wxDVArrayDataSet(const wxString &var, const wxString &units, const double &timestep,
                                    const std::vector<double> &data)
-        : m_varLabel(var), m_varUnits(units), m_timestep(timestep), m_offset(0) {
-    Copy(data);
+        : wxDVArrayDataSetBase(var, units, 0, timestep, data), m_offGridReported(false) {
 }
 
 wxDVArrayDataSet::wxDVArrayDataSet(const wxString &var, const wxString &units, const double &offset,
                                    const double &timestep, const std::vector<double> &data)
-        : m_varLabel(var), m_varUnits(units), m_timestep(timestep), m_offset(offset) {
-    Copy(data);
+        : wxDVArrayDataSetBase(var, units, offset, timestep, data), m_offGridReported(false) {
+}
+
+void wxDVArrayDataSet::CheckX(size_t i, double x) {
+    if (m_offGridReported || IsOnGrid(m_offset, m_timestep, i, x))
+        return;
+
+    m_offGridReported = true;
+    wxLogWarning("Data set %s: point %lu is at hour %g, but evenly spaced points put it at %g. "
+                 "Uneven x values are not kept; use wxDVPointArrayDataSet or wxDVArrayDataSetBase::Create for them.",
+                 m_varLabel, (unsigned long) i, x, m_offset + i * m_timestep);
 }
 
 wxRealPoint wxDVArrayDataSet::At(size_t i) const {
-    if (i < m_pData.size())
-        return wxRealPoint(m_pData[i].x, m_pData[i].y);
+    if (i < m_yData.size())
+        return wxRealPoint(m_offset + i * m_timestep, m_yData[i]);
     else
         return wxRealPoint(m_offset + i * m_timestep, 0.0);
 }
 
-size_t wxDVArrayDataSet::Length() const {
-    return m_pData.size();
+const double *wxDVArrayDataSet::GetXSpan(size_t start, size_t end, std::vector<double> &buf) const {
+    buf.resize(end > start ? end - start : 0);
+    for (size_t i = start; i < end; i++)
+        buf[i - start] = m_offset + i * m_timestep;
+    return buf.empty() ? 0 : &buf[0];
 }
 
-double wxDVArrayDataSet::GetTimeStep() const {
-    return m_timestep;
-}
-
-double wxDVArrayDataSet::GetOffset() const {
-    return m_offset;
+void wxDVArrayDataSet::YDataChanged(size_t index) const {
+    m_lodPyramid.Invalidate(index);
+    wxDVArrayDataSetBase::YDataChanged(index);
 }
 
-wxString wxDVArrayDataSet::GetSeriesTitle() const {
-    return m_varLabel;
+bool wxDVArrayDataSet::GetLODBuckets(size_t level, size_t first, size_t end,
+                                     std::vector<wxDVLODBucket> &buckets) const {
+    if (level < wxDVLODPyramid::MIN_LEVEL)
+        return false;
+    m_lodPyramid.Query(*this, level, first, end, buckets);
+    return true;
 }
 
-wxString wxDVArrayDataSet::GetUnits() const {
-    return m_varUnits;
+void wxDVArrayDataSet::Clear() {
+    std::vector<double>().swap(m_yData);
+    YDataChanged();
 }
 
-void wxDVArrayDataSet::Clear() {
-    m_pData.clear();
+void wxDVArrayDataSet::Truncate(size_t len) {
+    if (len < m_yData.size()) {
+        m_yData.resize(len);
+        YDataChanged(len);
+    }
 }
 
 void wxDVArrayDataSet::Copy(const std::vector<double> &data) {
-    m_pData.clear();
-    if (data.size() > 0) {
-        m_pData.resize(data.size());
-        for (size_t i = 0; i < data.size(); i++)
-            m_pData[i] = wxRealPoint(m_offset + i * m_timestep, data[i]);
-    }
+    m_yData = data;
+    YDataChanged();
 }
 
 void wxDVArrayDataSet::Alloc(size_t n) {
-    m_pData.reserve(n);
+    m_yData.reserve(n);
 }
 
 void wxDVArrayDataSet::Append(const wxRealPoint &p) {
-    m_pData.push_back(p);
+    CheckX(m_yData.size(), p.x);
+    YDataChanged(m_yData.size());
+    m_yData.push_back(p.y);
+}
+
+void wxDVArrayDataSet::AppendY(double y) {
+    YDataChanged(m_yData.size());
+    m_yData.push_back(y);
+}
+
+void wxDVArrayDataSet::AppendY(const double *y, size_t n) {
+    YDataChanged(m_yData.size());
+    m_yData.insert(m_yData.end(), y, y + n);
 }
 
 void wxDVArrayDataSet::Set(size_t i, double x, double y) {
-    if (i < m_pData.size())
-        m_pData[i] = wxRealPoint(x, y);
+    if (i < m_yData.size()) {
+        CheckX(i, x);
+        m_yData[i] = y;
+        YDataChanged(i);
+    }
 }
 
-void wxDVArrayDataSet::SetY(size_t i, double y) {
-    if (i < m_pData.size())
-        m_pData[i].y = y;
+// ******** Point array data set *********** //
+
+wxDVPointArrayDataSet::wxDVPointArrayDataSet() {
 }
 
-void wxDVArrayDataSet::SetSeriesTitle(const wxString &title) {
-    m_varLabel = title;
+wxDVPointArrayDataSet::wxDVPointArrayDataSet(const wxString &var, const std::vector<wxRealPoint> &data)
+        : wxDVArrayDataSetBase(var, wxEmptyString, 0, 1, std::vector<double>()) {
+    if (data.size() > 0)
+        m_offset = data[0].x;
+    if (data.size() > 1 && data[1].x > data[0].x)
+        m_timestep = data[1].x - data[0].x;
+
+    m_xData.resize(data.size());
+    m_yData.resize(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        m_xData[i] = data[i].x;
+        m_yData[i] = data[i].y;
+    }
 }
 
-void wxDVArrayDataSet::SetUnits(const wxString &units) {
-    m_varUnits = units;
+wxDVPointArrayDataSet::wxDVPointArrayDataSet(const wxString &var, const wxString &units, const double &timestep)
+        : wxDVArrayDataSetBase(var, units, 0, timestep, std::vector<double>()) {
 }
 
-void wxDVArrayDataSet::SetTimeStep(double ts, bool recompute_x) {
-    m_timestep = ts;
-    if (recompute_x) RecomputeXData();
+wxRealPoint wxDVPointArrayDataSet::At(size_t i) const {
+    if (i < m_yData.size())
+        return wxRealPoint(m_xData[i], m_yData[i]);
+    else
+        return wxRealPoint(m_offset + i * m_timestep, 0.0);
 }
 
-void wxDVArrayDataSet::SetOffset(double off, bool recompute_x) {
-    m_offset = off;
-    if (recompute_x) RecomputeXData();
+const double *wxDVPointArrayDataSet::GetXSpan(size_t start, size_t end, std::vector<double> &buf) const {
+    if (start < end && end <= m_xData.size())
+        return &m_xData[start];
+    return wxDVTimeSeriesDataSet::GetXSpan(start, end, buf);
 }
 
-void wxDVArrayDataSet::RecomputeXData() {
-    for (size_t i = 0; i < m_pData.size(); i++)
-        m_pData[i].x = m_offset + i * m_timestep;
+void wxDVPointArrayDataSet::Copy(const std::vector<double> &data) {
+    m_yData = data;
+    m_xData.resize(m_yData.size());
+    for (size_t i = 0; i < m_xData.size(); i++)
+        m_xData[i] = m_offset + i * m_timestep;
+    YDataChanged();
 }
 
-// ******** Statistics data set *********** //
+void wxDVPointArrayDataSet::Clear() {
+    std::vector<double>().swap(m_xData);
+    std::vector<double>().swap(m_yData);
+    YDataChanged();
+}
 
-wxDVStatisticsDataSet::wxDVStatisticsDataSet(wxDVTimeSeriesDataSet *d) {
-    baseDataset = d;
+void wxDVPointArrayDataSet::Truncate(size_t len) {
+    if (len < m_yData.size()) {
+        m_xData.resize(len);
+        m_yData.resize(len);
+        YDataChanged(len);
+    }
+}
 
-    double MinHrs = d->GetMinHours();
-    double MaxHrs = d->GetMaxHours();
-    double Offset = d->GetOffset();
+void wxDVPointArrayDataSet::Alloc(size_t n) {
+    m_xData.reserve(n);
+    m_yData.reserve(n);
+}
 
-    //Create monthly and total statistics from m_data - start with very large number (2 billion) for Min variables and -2 billion for Max's, since we'll be looking for anything lower than this in the data.
-    wxString name = "";
-    double nextDay = 0.0;
-    double nextMonth = 0.0;
-    double currentMonth = 0.0;
-    double year = 0.0;
-    double counter = 0.0;
-    double sum = 0.0;
-    double avg = 0.0;
-    double min = 2000000000.0;
-    double max = -2000000000.0;
-    double StDev = 0.0;
-    double AvgDailyMin = 2000000000.0;
-    double AvgDailyMax = -2000000000.0;
-    int DayNumber = 0;
-    double DayCounter = 0.0;
-    double StDevCounter = 0.0;
-    double DayMins[31] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
-                          0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
-    double DayMaxs[31] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
-                          0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
-    int FirstOrdinalOfMonth = 0;
-    double totalcounter = 0.0;
-    double totalsum = 0.0;
-    double totalmin = 2000000000.0;
-    double totalmax = -2000000000.0;
-    std::vector<wxRealPoint> totalDayStats;
-    StatisticsPoint sp;
-    bool MultiYear = false;
-    int yrNum = 1;
+void wxDVPointArrayDataSet::Append(const wxRealPoint &p) {
+    YDataChanged(m_yData.size());
+    m_xData.push_back(p.x);
+    m_yData.push_back(p.y);
+}
 
-    while (MinHrs > 8760.0) {
-        year += 8760.0;
-        MinHrs -= 8760.0;
-        MaxHrs -= 8760.0;
-    }
+void wxDVPointArrayDataSet::AppendY(double y) {
+    YDataChanged(m_yData.size());
+    m_xData.push_back(m_offset + m_xData.size() * m_timestep);
+    m_yData.push_back(y);
+}
 
-    if (MaxHrs > 8760) { MultiYear = true; }    //Determine if the dataset contains data for more than one year
+void wxDVPointArrayDataSet::AppendY(const double *y, size_t n) {
+    YDataChanged(m_yData.size());
+    m_xData.reserve(m_xData.size() + n);
+    for (size_t i = 0; i < n; i++)
+        m_xData.push_back(m_offset + m_xData.size() * m_timestep);
+    m_yData.insert(m_yData.end(), y, y + n);
+}
 
-    while (nextDay <= MinHrs) {
-        nextDay += 24.0;
+void wxDVPointArrayDataSet::Set(size_t i, double x, double y) {
+    if (i < m_yData.size()) {
+        m_xData[i] = x;
+        m_yData[i] = y;
+        YDataChanged(i);
     }
+}
 
-    if (MinHrs >= 0.0 && MinHrs < 744.0) {
-        currentMonth = year;
-        nextMonth = year + 744.0;
-        name = "Jan";
-    }
-    else if (MinHrs >= 744.0 && MinHrs < 1416.0) {
-        currentMonth = year + 744.0;
-        nextMonth = year + 1416.0;
-        name = "Feb";
-    }
-    else if (MinHrs >= 1416.0 && MinHrs < 2160.0) {
-        currentMonth = year + 1416.0;
-        nextMonth = year + 2160.0;
-        name = "Mar";
-    }
-    else if (MinHrs >= 2160.0 && MinHrs < 2880.0) {
-        currentMonth = year + 2160.0;
-        nextMonth = year + 2880.0;
-        name = "Apr";
-    }
-    else if (MinHrs >= 2880.0 && MinHrs < 3624.0) {
-        currentMonth = year + 2880.0;
-        nextMonth = year + 3624.0;
-        name = "May";
-    }
-    else if (MinHrs >= 3624.0 && MinHrs < 4344.0) {
-        currentMonth = year + 3624.0;
-        nextMonth = year + 4344.0;
-        name = "Jun";
-    }
-    else if (MinHrs >= 4344.0 && MinHrs < 5088.0) {
-        currentMonth = year + 4344.0;
-        nextMonth = year + 5088.0;
-        name = "Jul";
-    }
-    else if (MinHrs >= 5088.0 && MinHrs < 5832.0) {
-        currentMonth = year + 5088.0;
-        nextMonth = year + 5832.0;
-        name = "Aug";
-    }
-    else if (MinHrs >= 5832.0 && MinHrs < 6552.0) {
-        currentMonth = year + 5832.0;
-        nextMonth = year + 6552.0;
-        name = "Sep";
-    }
-    else if (MinHrs >= 6552.0 && MinHrs < 7296.0) {
-        currentMonth = year + 6552.0;
-        nextMonth = year + 7296.0;
-        name = "Oct";
-    }
-    else if (MinHrs >= 7296.0 && MinHrs < 8016.0) {
-        currentMonth = year + 7296.0;
-        nextMonth = year + 8016.0;
-        name = "Nov";
-    }
-    else if (MinHrs >= 8016.0 && MinHrs < 8760.0) {
-        currentMonth = year + 8016.0;
-        nextMonth = year + 8760.0;
-        name = "Dec";
+// ******** Lazy array data set *********** //
+
+wxDVLazyArrayDataSet::wxDVLazyArrayDataSet(const wxDVArrayDataSet &header, size_t length,
+                                           const std::shared_ptr<wxDVColumnLoader> &loader, size_t column)
+        : wxDVArrayDataSet(header), m_length(length), m_column(column), m_loader(loader), m_loaded(false) {
+}
+
+bool wxDVLazyArrayDataSet::IsLoaded() const {
+    return m_loaded.load(std::memory_order_acquire);
+}
+
+void wxDVLazyArrayDataSet::Load() const {
+    if (m_loaded.load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard<std::mutex> lock(m_loadMutex);
+    if (m_loaded.load(std::memory_order_relaxed))
+        return;
+
+    std::vector<double> &y = const_cast<wxDVLazyArrayDataSet *>(this)->m_yData;
+    size_t nheader = y.size();
+    if (!m_loader || !m_loader->LoadColumn(m_column, y))
+        y.resize(nheader);
+    y.resize(m_length, MissingValue());
+    m_loader.reset(); // the file index goes away with the last column that needs it
+    YDataChanged();
+
+    m_loaded.store(true, std::memory_order_release);
+}
+
+wxRealPoint wxDVLazyArrayDataSet::At(size_t i) const {
+    Load();
+    return wxDVArrayDataSet::At(i);
+}
+
+size_t wxDVLazyArrayDataSet::Length() const {
+    return IsLoaded() ? m_yData.size() : m_length;
+}
+
+const double *wxDVLazyArrayDataSet::GetYSpan(size_t start, size_t end, std::vector<double> &buf) const {
+    Load();
+    return wxDVArrayDataSet::GetYSpan(start, end, buf);
+}
+
+bool wxDVLazyArrayDataSet::QueryMinMaxIndex(size_t start, size_t end, double *min, double *max) const {
+    Load(); // loading invalidates the index, so it can't happen while the index is locked
+    return wxDVArrayDataSet::QueryMinMaxIndex(start, end, min, max);
+}
+
+bool wxDVLazyArrayDataSet::GetLODBuckets(size_t level, size_t first, size_t end,
+                                         std::vector<wxDVLODBucket> &buckets) const {
+    Load();
+    return wxDVArrayDataSet::GetLODBuckets(level, first, end, buckets);
+}
+
+void wxDVLazyArrayDataSet::Copy(const std::vector<double> &data) {
+    Load();
+    wxDVArrayDataSet::Copy(data);
+}
+
+void wxDVLazyArrayDataSet::Clear() {
+    Load();
+    wxDVArrayDataSet::Clear();
+}
+
+void wxDVLazyArrayDataSet::Truncate(size_t len) {
+    Load();
+    wxDVArrayDataSet::Truncate(len);
+}
+
+void wxDVLazyArrayDataSet::Alloc(size_t n) {
+    Load();
+    wxDVArrayDataSet::Alloc(n);
+}
+
+void wxDVLazyArrayDataSet::Append(const wxRealPoint &p) {
+    Load();
+    wxDVArrayDataSet::Append(p);
+}
+
+void wxDVLazyArrayDataSet::AppendY(double y) {
+    Load();
+    wxDVArrayDataSet::AppendY(y);
+}
+
+void wxDVLazyArrayDataSet::AppendY(const double *y, size_t n) {
+    Load();
+    wxDVArrayDataSet::AppendY(y, n);
+}
+
+void wxDVLazyArrayDataSet::Set(size_t i, double x, double y) {
+    Load();
+    wxDVArrayDataSet::Set(i, x, y);
+}
+
+// ******** Resampled data set *********** //
+
+wxDVResampledDataSet::wxDVResampledDataSet(const wxString &var, const wxString &units, double offset,
+                                           double timestep, const std::vector<size_t> &gridIndex,
+                                           const std::vector<double> &values)
+        : wxDVArrayDataSet(var, units, offset, timestep, std::vector<double>()),
+          m_gridIndex(gridIndex), m_values(values) {
+    if (m_values.size() != m_gridIndex.size() || m_values.size() < 2) {
+        m_gridIndex.clear();
+        m_values.clear();
     }
+}
 
-    if (MultiYear) {
-        name = "Year 1, " + name;
-    }    //If the dataset contains data for more than one year then append the year number to the name
-
-    for (size_t i = 0; i < d->Length(); i++) {
-        if (d->At(i).x >= nextDay) {
-            if (i != 0) {
-                DayMins[DayNumber] = (AvgDailyMin == 2000000000.0) ? 0.0 : AvgDailyMin;
-                DayMaxs[DayNumber] = (AvgDailyMax == -2000000000.0) ? 0.0 : AvgDailyMax;
-                totalDayStats.push_back(wxRealPoint(AvgDailyMin, AvgDailyMax));
-                DayNumber++;
-                AvgDailyMin = 2000000000.0;
-                AvgDailyMax = -2000000000.0;
-                nextDay += 24.0;
-            }
-        }
+size_t wxDVResampledDataSet::FindSegment(size_t i) const {
+    // the last segment starting at or before i; empty segments are skipped by construction
+    return (std::upper_bound(m_gridIndex.begin(), m_gridIndex.end() - 1, i) - m_gridIndex.begin()) - 1;
+}
 
-        if (d->At(i).x >= nextMonth) {
-            if (i != 0 && counter != 0) {
-                AvgDailyMin = 0.0;
-                AvgDailyMax = 0.0;
-                avg = sum / counter;
-
-                //Calculate standard deviation for the month's data
-                StDev = 0.0;
-                StDevCounter = 0.0;
-                for (size_t j = FirstOrdinalOfMonth; j < i; j++) {
-                    StDev += (d->At(j).y - avg) * (d->At(j).y - avg);
-                    StDevCounter += 1.0;
-                }
-                if (StDevCounter > 0.0) {
-                    StDev = StDev / StDevCounter;
-                    StDev = sqrt(StDev);
-                }
-
-                //Summarize the daily Min and Max values into average daily min and max values for the month.
-                for (size_t j = 0; j < 31; j++) {
-                    if (DayMaxs[j] >
-                        0)    //Not every month will have 31 days and endpoints may be missing some days in the month, as denoted by a 0 maximum value
-                    {
-                        AvgDailyMin += DayMins[j];
-                        AvgDailyMax += DayMaxs[j];
-                        DayCounter += 1.0;
-                    }
-                }
-                if (DayCounter > 0.0) {
-                    AvgDailyMax = AvgDailyMax / DayCounter;
-                    AvgDailyMin = AvgDailyMin / DayCounter;
-                }
-
-                sp = StatisticsPoint();
-                if (Offset < 672.0 && Offset > 0.0)    //xOffset is within number of hours in the shortest month
-                {
-                    sp.x = currentMonth + Offset;
-                } else {
-                    sp.x = currentMonth + ((nextMonth - currentMonth) / 2.0);    //Make x the middle of the month
-                }
-                sp.name = name;
-                sp.Max = RoundSignificant(max);
-                sp.Min = RoundSignificant(min);
-                sp.Sum = RoundSignificant(sum);
-                sp.Mean = RoundSignificant(avg);
-                sp.StDev = RoundSignificant(StDev);
-                sp.AvgDailyMax = RoundSignificant(AvgDailyMax);
-                sp.AvgDailyMin = RoundSignificant(AvgDailyMin);
-
-                Append(sp);
-
-                currentMonth = nextMonth;
-                if (nextMonth == 744.0 + year) {
-                    nextMonth = 1416.0 + year;
-                    name = "Feb";
-                }
-                else if (nextMonth == 1416.0 + year) {
-                    nextMonth = 2160.0 + year;
-                    name = "Mar";
-                }
-                else if (nextMonth == 2160.0 + year) {
-                    nextMonth = 2880.0 + year;
-                    name = "Apr";
-                }
-                else if (nextMonth == 2880.0 + year) {
-                    nextMonth = 3624.0 + year;
-                    name = "May";
-                }
-                else if (nextMonth == 3624.0 + year) {
-                    nextMonth = 4344.0 + year;
-                    name = "Jun";
-                }
-                else if (nextMonth == 4344.0 + year) {
-                    nextMonth = 5088.0 + year;
-                    name = "Jul";
-                }
-                else if (nextMonth == 5088.0 + year) {
-                    nextMonth = 5832.0 + year;
-                    name = "Aug";
-                }
-                else if (nextMonth == 5832.0 + year) {
-                    nextMonth = 6552.0 + year;
-                    name = "Sep";
-                }
-                else if (nextMonth == 6552.0 + year) {
-                    nextMonth = 7296.0 + year;
-                    name = "Oct";
-                }
-                else if (nextMonth == 7296.0 + year) {
-                    nextMonth = 8016.0 + year;
-                    name = "Nov";
-                }
-                else if (nextMonth == 8016.0 + year) {
-                    nextMonth = 8760.0 + year;
-                    name = "Dec";
-                }
-                else if (nextMonth == 8760.0 + year) {
-                    year += 8760.0;
-                    nextMonth = 744.0 + year;
-                    name = "Jan";
-                    yrNum += 1;
-                }
-
-                if (MultiYear) {
-                    name = "Year " + wxString::Format("%d", yrNum) + ", " + name;
-                }    //If the dataset contains data for more than one year then prepend the year number to the name
-            }
+double wxDVResampledDataSet::Interpolate(size_t k, size_t i) const {
+    double valueDeltaPerStep = (m_values[k + 1] - m_values[k]) / (double) (m_gridIndex[k + 1] - m_gridIndex[k]);
+    return m_values[k] + valueDeltaPerStep * (double) (i - m_gridIndex[k]);
+}
 
-            counter = 0.0;
-            sum = 0.0;
-            avg = 0.0;
-            min = 2000000000.0;
-            max = -2000000000.0;
-            StDev = 0.0;
-            AvgDailyMin = 2000000000.0;
-            AvgDailyMax = -2000000000.0;
-            DayNumber = 0;
-            DayCounter = 0.0;
-            FirstOrdinalOfMonth = i;
-        }
+wxRealPoint wxDVResampledDataSet::At(size_t i) const {
+    if (m_gridIndex.empty() || i >= Length())
+        return wxDVArrayDataSet::At(i);
+    return wxRealPoint(m_offset + i * m_timestep, Interpolate(FindSegment(i), i));
+}
+
+size_t wxDVResampledDataSet::Length() const {
+    return m_gridIndex.empty() ? m_yData.size() : m_gridIndex.back();
+}
+
+const double *wxDVResampledDataSet::GetYSpan(size_t start, size_t end, std::vector<double> &buf) const {
+    if (m_gridIndex.empty() || start >= end || end > Length())
+        return wxDVArrayDataSet::GetYSpan(start, end, buf);
 
-        counter += 1.0;
-        totalcounter += 1.0;
-        sum += d->At(i).y;
-        totalsum += d->At(i).y;
-        if (min > d->At(i).y) { min = d->At(i).y; }
-        if (totalmin > d->At(i).y) { totalmin = d->At(i).y; }
-        if (max < d->At(i).y) { max = d->At(i).y; }
-        if (totalmax < d->At(i).y) { totalmax = d->At(i).y; }
-        if (AvgDailyMin > d->At(i).y) { AvgDailyMin = d->At(i).y; }
-        if (AvgDailyMax < d->At(i).y) { AvgDailyMax = d->At(i).y; }
+    buf.resize(end - start);
+    size_t k = FindSegment(start);
+    for (size_t i = start; i < end; i++) {
+        while (m_gridIndex[k + 1] <= i)
+            k++;
+        buf[i - start] = Interpolate(k, i);
     }
+    return &buf[0];
+}
 
-    if (MaxHrs > 0.0 && fmod(MaxHrs, 8760.0) !=
-                        0)    //Prevent appending the final point if it represents 12/31 24:00, which the system interprets as 1/1 0:00 and creates a point for January of the next year
-    {
-        DayMins[DayNumber] = AvgDailyMin;
-        DayMaxs[DayNumber] = AvgDailyMax;
-        totalDayStats.push_back(wxRealPoint(AvgDailyMin, AvgDailyMax));
-        AvgDailyMin = 0.0;
-        AvgDailyMax = 0.0;
-
-        avg = sum / counter;
-
-        //Calculate standard deviation for the month's data
-        StDev = 0.0;
-        StDevCounter = 0.0;
-        for (size_t j = FirstOrdinalOfMonth; j < d->Length(); j++) {
-            StDev += (d->At(j).y - avg) * (d->At(j).y - avg);
-            StDevCounter += 1.0;
-        }
-        if (StDevCounter > 0.0) {
-            StDev = StDev / StDevCounter;
-            StDev = sqrt(StDev);
-        }
+void wxDVResampledDataSet::Materialize() {
+    if (m_gridIndex.empty())
+        return;
+
+    std::vector<double> y;
+    GetYSpan(0, Length(), y);
+    m_yData.swap(y);
+    std::vector<size_t>().swap(m_gridIndex);
+    std::vector<double>().swap(m_values);
+}
+
+void wxDVResampledDataSet::Copy(const std::vector<double> &data) {
+    Materialize();
+    wxDVArrayDataSet::Copy(data);
+}
+
+void wxDVResampledDataSet::Clear() {
+    Materialize();
+    wxDVArrayDataSet::Clear();
+}
+
+void wxDVResampledDataSet::Truncate(size_t len) {
+    Materialize();
+    wxDVArrayDataSet::Truncate(len);
+}
+
+void wxDVResampledDataSet::Alloc(size_t n) {
+    Materialize();
+    wxDVArrayDataSet::Alloc(n);
+}
+
+void wxDVResampledDataSet::Append(const wxRealPoint &p) {
+    Materialize();
+    wxDVArrayDataSet::Append(p);
+}
+
+void wxDVResampledDataSet::AppendY(double y) {
+    Materialize();
+    wxDVArrayDataSet::AppendY(y);
+}
+
+void wxDVResampledDataSet::AppendY(const double *y, size_t n) {
+    Materialize();
+    wxDVArrayDataSet::AppendY(y, n);
+}
+
+void wxDVResampledDataSet::Set(size_t i, double x, double y) {
+    Materialize();
+    wxDVArrayDataSet::Set(i, x, y);
+}
+
+// ******** Statistics data set *********** //
+
+wxDVStatisticsDataSet::wxDVStatisticsDataSet(wxDVTimeSeriesDataSet *d) {
+    baseDataset = d;
+    m_aggregate = wxDVCalendarAggregate::Get(d);
+}
+
+void wxDVStatisticsDataSet::Update() {
+    Compute(m_sData);
+}
+
+void wxDVStatisticsDataSet::Compute(std::vector<StatisticsPoint> &points) const {
+    static const char *MONTH_NAMES[12] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                          "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
 
-        //Summarize the daily Min and Max values into average daily min and max values for the month.
-        for (size_t j = 0; j < 31; j++) {
-            if (DayMaxs[j] >
-                0)    //Not every month will have 31 days and endpoints may be missing some days in the month, as denoted by a 0 maximum value
-            {
-                AvgDailyMin += DayMins[j];
-                AvgDailyMax += DayMaxs[j];
+    wxDVTimeSeriesDataSet *d = baseDataset;
+    points.clear();
+    if (d->Length() == 0)
+        return;
+
+    m_aggregate->Update();
+    std::vector<wxDVPeriodStats> months, days;
+    m_aggregate->GetPeriods(wxDV_PERIOD_MONTH, 0, months);
+    m_aggregate->GetPeriods(wxDV_PERIOD_DAY, 0, days);
+    if (months.empty())
+        return;
+
+    double MaxHrs = d->GetMaxHours();
+    double Offset = d->GetOffset();
+    double firstYear = floor(months[0].lower / 8760.0) * 8760.0;
+    bool MultiYear = MaxHrs - firstYear > 8760;    //Determine if the dataset contains data for more than one year
+
+    //Prevent reporting the final month if it only holds 12/31 24:00, which the system interprets as 1/1 0:00 of the next year
+    size_t nmonths = months.size();
+    if (!(MaxHrs > 0.0 && fmod(MaxHrs, 8760.0) != 0))
+        nmonths--;
+
+    wxDVPeriodStats total = months[0];
+    total.count = total.sum = total.sqDev = 0.0;
+    total.min = total.max = wxDVTimeSeriesDataSet::MissingValue();
+    double totalDailyMin = 0.0, totalDailyMax = 0.0, totalDays = 0.0;
+    size_t day = 0;
+    StatisticsPoint sp;
+
+    for (size_t m = 0; m < months.size(); m++) {
+        const wxDVPeriodStats &p = months[m];
+        total.Merge(p);
+
+        //Average the daily minimum and maximum over the days of the month that have data.
+        double AvgDailyMin = 0.0, AvgDailyMax = 0.0, DayCounter = 0.0;
+        for (; day < days.size() && days[day].lower < p.upper; day++) {
+            if (days[day].count > 0.0) {
+                AvgDailyMin += days[day].min;
+                AvgDailyMax += days[day].max;
                 DayCounter += 1.0;
             }
         }
+        if (m >= nmonths)
+            break;
+
+        totalDailyMin += AvgDailyMin;
+        totalDailyMax += AvgDailyMax;
+        totalDays += DayCounter;
         if (DayCounter > 0.0) {
-            AvgDailyMax = AvgDailyMax / DayCounter;
-            AvgDailyMin = AvgDailyMin / DayCounter;
+            AvgDailyMin /= DayCounter;
+            AvgDailyMax /= DayCounter;
         }
 
+        double year = floor(p.lower / 8760.0) * 8760.0;
+        wxString name = MONTH_NAMES[wxDVCalendarAggregate::GetMonthOfYear(p.lower)];
+        if (MultiYear) {
+            name = "Year " + wxString::Format("%d", (int) ((year - firstYear) / 8760.0) + 1) + ", " + name;
+        }    //If the dataset contains data for more than one year then prepend the year number to the name
+
         sp = StatisticsPoint();
         if (Offset < 672.0 && Offset > 0.0)    //xOffset is within number of hours in the shortest month
         {
-            sp.x = currentMonth + Offset;
+            sp.x = p.lower + Offset;
         } else {
-            sp.x = currentMonth + ((nextMonth - currentMonth) / 2.0);    //Make x the middle of the month
+            sp.x = p.lower + ((p.upper - p.lower) / 2.0);    //Make x the middle of the month
         }
         sp.name = name;
-        sp.Max = RoundSignificant(max);
-        sp.Min = RoundSignificant(min);
-        sp.Sum = RoundSignificant(sum);
-        sp.Mean = RoundSignificant(avg);
-        sp.StDev = RoundSignificant(StDev);
+        sp.Max = RoundSignificant(p.max);
+        sp.Min = RoundSignificant(p.min);
+        sp.Sum = RoundSignificant(p.sum);
+        sp.Mean = RoundSignificant(p.Mean());
+        sp.StDev = RoundSignificant(p.StDev());
         sp.AvgDailyMax = RoundSignificant(AvgDailyMax);
         sp.AvgDailyMin = RoundSignificant(AvgDailyMin);
 
-        Append(sp);
+        points.push_back(sp);
     }
 
     //Append StatisticsPoint for totals over all months
-
-    AvgDailyMin = 0.0;
-    AvgDailyMax = 0.0;
-    avg = totalsum / totalcounter;
-
-    //Calculate standard deviation for the month's data
-    StDev = 0.0;
-    StDevCounter = 0.0;
-    for (size_t j = 0; j < d->Length(); j++) {
-        StDev += (d->At(j).y - avg) * (d->At(j).y - avg);
-        StDevCounter += 1.0;
-    }
-    if (StDevCounter > 0.0) {
-        StDev = StDev / StDevCounter;
-        StDev = sqrt(StDev);
-    }
-
-    //Summarize the daily Min and Max values into average daily min and max values for the month.
-    DayCounter = 0.0;
-    for (size_t j = 0; j < totalDayStats.size(); j++) {
-        AvgDailyMin += totalDayStats[j].x;
-        AvgDailyMax += totalDayStats[j].y;
-        DayCounter += 1.0;
-    }
-    if (DayCounter > 0.0) {
-        AvgDailyMax = AvgDailyMax / DayCounter;
-        AvgDailyMin = AvgDailyMin / DayCounter;
+    if (totalDays > 0.0) {
+        totalDailyMin /= totalDays;
+        totalDailyMax /= totalDays;
     }
 
     sp = StatisticsPoint();
     sp.x = d->At(d->Length() - 1).x + 1.0;    //Make x one greater than the last x value in the dataset
     sp.name = "Total";
-    sp.Max = RoundSignificant(totalmax);
-    sp.Min = RoundSignificant(totalmin);
-    sp.Sum = RoundSignificant(totalsum);
-    sp.Mean = RoundSignificant(avg);
-    sp.StDev = RoundSignificant(StDev);
-    sp.AvgDailyMax = RoundSignificant(AvgDailyMax);
-    sp.AvgDailyMin = RoundSignificant(AvgDailyMin);
-
-    Append(sp);
+    sp.Max = RoundSignificant(total.max);
+    sp.Min = RoundSignificant(total.min);
+    sp.Sum = RoundSignificant(total.sum);
+    sp.Mean = RoundSignificant(total.Mean());
+    sp.StDev = RoundSignificant(total.StDev());
+    sp.AvgDailyMax = RoundSignificant(totalDailyMax);
+    sp.AvgDailyMin = RoundSignificant(totalDailyMin);
+
+    points.push_back(sp);
 }
 
-double wxDVStatisticsDataSet::RoundSignificant(double ValueToRound, size_t NumSignifDigits) {
+double wxDVStatisticsDataSet::RoundSignificant(double ValueToRound, size_t NumSignifDigits) const {
     double roundedValue = ValueToRound;
     double multiplier = pow(10, (int) NumSignifDigits);    //set the multiplier to be 10 to the power of NumSignifDigits
 
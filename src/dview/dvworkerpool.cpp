@@ -0,0 +1,91 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) Alliance for Sustainable Energy, LLC. See also https://github.com/NREL/wex/blob/develop/LICENSE
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "wex/dview/dvworkerpool.h"
+
+wxDVWorkerPool::wxDVWorkerPool(size_t nthreads) {
+    if (nthreads == 0)
+        nthreads = std::thread::hardware_concurrency();
+    m_maxThreads = (nthreads > 0) ? nthreads : 1;
+    m_running = 0;
+    m_stop = false;
+}
+
+wxDVWorkerPool::~wxDVWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+}
+
+void wxDVWorkerPool::Queue(const std::function<void()> &task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(task);
+        //Start another thread only if every running one is busy.
+        if (m_threads.size() < m_maxThreads && m_tasks.size() + m_running > m_threads.size())
+            m_threads.push_back(std::thread(&wxDVWorkerPool::Run, this));
+    }
+    m_wake.notify_one();
+}
+
+void wxDVWorkerPool::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_tasks.empty() && m_running == 0; });
+}
+
+bool wxDVWorkerPool::IsBusy() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_tasks.empty() || m_running > 0;
+}
+
+void wxDVWorkerPool::Run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+        if (m_tasks.empty())
+            return; // stopping, and the queue has been drained
+
+        std::function<void()> task = m_tasks.front();
+        m_tasks.pop_front();
+        m_running++;
+        lock.unlock();
+        task();
+        lock.lock();
+        m_running--;
+        if (m_tasks.empty() && m_running == 0)
+            m_idle.notify_all();
+    }
+}
@@ -176,6 +176,50 @@ wxColour wxPLColourMap::ColourForValue(double val) {
         return m_colourList.back();
 }
 
+void wxPLColourMap::ColoursForValues(const double *values, size_t n, unsigned char *rgb) {
+    const wxColour &bg = *wxCONTOUR_BG;
+    if (m_colourList.size() == 0) {
+        for (size_t i = 0; i < n; i++, rgb += 3) {
+            rgb[0] = bg.Red();
+            rgb[1] = bg.Green();
+            rgb[2] = bg.Blue();
+        }
+        return;
+    }
+
+    // unpack the list once so the loop only indexes bytes
+    size_t ncol = m_colourList.size();
+    std::vector<unsigned char> lut(3 * ncol);
+    for (size_t i = 0; i < ncol; i++) {
+        lut[3 * i] = m_colourList[i].Red();
+        lut[3 * i + 1] = m_colourList[i].Green();
+        lut[3 * i + 2] = m_colourList[i].Blue();
+    }
+
+    double range = m_max - m_min;
+    for (size_t i = 0; i < n; i++, rgb += 3) {
+        double val = values[i];
+        if (!wxFinite(val)) {
+            rgb[0] = bg.Red();
+            rgb[1] = bg.Green();
+            rgb[2] = bg.Blue();
+            continue;
+        }
+
+        double frac = (val - m_min) / range;
+        double pos = ((double) ncol) * (m_reversed ? 1.0 - frac : frac);
+        size_t index;
+        if (pos >= 0 && pos < (double) ncol) index = (size_t) pos;
+        else if (pos >= (double) ncol) index = ncol - 1;
+        else index = 0;
+
+        const unsigned char *c = &lut[3 * index];
+        rgb[0] = c[0];
+        rgb[1] = c[1];
+        rgb[2] = c[2];
+    }
+}
+
 wxPLCoarseRainbowColourMap::wxPLCoarseRainbowColourMap(double min, double max)
         : wxPLColourMap(min, max) {
     m_colourList.push_back(wxColour(0, 0, 0));
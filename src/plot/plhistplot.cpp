@@ -30,19 +30,116 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <cmath>
+#include <limits>
+
 #include <wx/dc.h>
 #include "wex/plot/plhistplot.h"
 
+//Values are read and binned this many at a time.
+static const size_t BLOCK_SIZE = 8192;
+
+//The y values of a vector of points, copied once into the plot.
+class wxPLHistogramPointValues : public wxPLHistogramData {
+public:
+    wxPLHistogramPointValues(const std::vector<wxRealPoint> &data) {
+        m_values.reserve(data.size());
+        for (size_t i = 0; i < data.size(); i++)
+            m_values.push_back(data[i].y);
+    }
+
+    virtual size_t Length() const { return m_values.size(); }
+
+    virtual const double *GetValues(size_t start, size_t, std::vector<double> &) const { return &m_values[start]; }
+
+private:
+    std::vector<double> m_values;
+};
+
+// The min/max and binning kernels work on two values at a time with SSE2, which every x86-64 processor has,
+// and fall back to plain loops elsewhere.  Comparisons with NaN (missing data) are false, so NaNs drop out
+// of the min and max without branches.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PL_HIST_SSE2
+#include <emmintrin.h>
+#endif
+
+static void ExtendMinMax(const double *y, size_t n, double *pmin, double *pmax) {
+    size_t i = 0;
+    double mn = *pmin, mx = *pmax;
+#ifdef PL_HIST_SSE2
+    //_mm_min_pd(a, b) is b when a is NaN.  Two pairs of accumulators keep both units busy.
+    __m128d mn0 = _mm_set1_pd(mn), mn1 = mn0;
+    __m128d mx0 = _mm_set1_pd(mx), mx1 = mx0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d a = _mm_loadu_pd(y + i);
+        __m128d b = _mm_loadu_pd(y + i + 2);
+        mn0 = _mm_min_pd(a, mn0);
+        mn1 = _mm_min_pd(b, mn1);
+        mx0 = _mm_max_pd(a, mx0);
+        mx1 = _mm_max_pd(b, mx1);
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_min_pd(mn0, mn1));
+    mn = (lanes[0] < lanes[1]) ? lanes[0] : lanes[1];
+    _mm_storeu_pd(lanes, _mm_max_pd(mx0, mx1));
+    mx = (lanes[0] > lanes[1]) ? lanes[0] : lanes[1];
+#endif
+    for (; i < n; i++) {
+        mn = (y[i] < mn) ? y[i] : mn;
+        mx = (y[i] > mx) ? y[i] : mx;
+    }
+    *pmin = mn;
+    *pmax = mx;
+}
+
+//Bin of each value in [min, max]; missing values, and zeros if ignoreZeros, go to the extra bin nbins.
+static void GetBinIndices(const double *y, size_t n, double min, double max, size_t nbins, bool ignoreZeros,
+                          int *bins) {
+    double range = max - min;
+    double dn = (double) nbins;
+    double last = dn - 1; // the max goes in the last bin
+    size_t i = 0;
+#ifdef PL_HIST_SSE2
+    __m128d vmin = _mm_set1_pd(min), vrange = _mm_set1_pd(range);
+    __m128d vdn = _mm_set1_pd(dn), vlast = _mm_set1_pd(last), vzero = _mm_setzero_pd();
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(y + i);
+        __m128d f = _mm_div_pd(_mm_mul_pd(vdn, _mm_sub_pd(v, vmin)), vrange);
+        f = _mm_min_pd(f, vlast);
+        __m128d keep = _mm_cmpord_pd(v, v);
+        if (ignoreZeros)
+            keep = _mm_andnot_pd(_mm_cmpeq_pd(v, vzero), keep);
+        f = _mm_or_pd(_mm_and_pd(keep, f), _mm_andnot_pd(keep, vdn));
+        _mm_storel_epi64((__m128i *) (bins + i), _mm_cvttpd_epi32(f));
+    }
+#endif
+    for (; i < n; i++) {
+        double v = y[i];
+        if (v != v || (ignoreZeros && v == 0.0)) {
+            bins[i] = (int) nbins;
+            continue;
+        }
+        double f = dn * (v - min) / range;
+        bins[i] = (int) ((f < last) ? f : last);
+    }
+}
+
 wxPLHistogramPlot::wxPLHistogramPlot() {
+    m_data = 0;
     Init();
 }
 
 wxPLHistogramPlot::wxPLHistogramPlot(const std::vector<wxRealPoint> &data,
                                      const wxString &label)
         : wxPLPlottable(label) {
+    m_data = 0;
     Init();
-    m_data = data;
-    RecalculateHistogram();
+    SetData(data);
+}
+
+wxPLHistogramPlot::~wxPLHistogramPlot() {
+    delete m_data;
 }
 
 void wxPLHistogramPlot::Init() {
@@ -54,15 +151,26 @@ void wxPLHistogramPlot::Init() {
     m_ignoreZeros = false;
     m_numberOfBins = 20;
     m_niceMax = m_dataMin = m_dataMax = 0.0;
+    m_dataCount = 0.0;
+    m_binRangesValid = false;
 }
 
 void wxPLHistogramPlot::SetData(const std::vector<wxRealPoint> &data) {
+    SetData(new wxPLHistogramPointValues(data));
+}
+
+void wxPLHistogramPlot::SetData(wxPLHistogramData *data) {
+    if (m_data != data)
+        delete m_data;
     m_data = data;
+    ReadDataRange();
     RecalculateHistogram();
 }
 
+//The x of each point is its index; only the values are kept.
 wxRealPoint wxPLHistogramPlot::At(size_t i) const {
-    return m_data[i];
+    std::vector<double> buf;
+    return wxRealPoint((double) i, *m_data->GetValues(i, i + 1, buf));
 }
 
 double wxPLHistogramPlot::HistAt(size_t i) const {
@@ -70,11 +178,13 @@ double wxPLHistogramPlot::HistAt(size_t i) const {
 }
 
 wxRealPoint wxPLHistogramPlot::HistBinAt(size_t i) const {
+    if (!m_binRangesValid)
+        CalculateBinRanges();
     return m_histDataBinRanges[i];
 }
 
 size_t wxPLHistogramPlot::Len() const {
-    return m_data.size();
+    return m_data ? m_data->Length() : 0;
 }
 
 void wxPLHistogramPlot::SetLineStyle(const wxColour &c, double width) {
@@ -106,7 +216,7 @@ void wxPLHistogramPlot::SetNormalize(NormalizeType n) {
             m_normalizeToPdf = true;
     }
 
-    RecalculateHistogram();
+    NormalizeHistogram();
 }
 
 wxPLHistogramPlot::NormalizeType wxPLHistogramPlot::GetNormalize() const {
@@ -230,52 +340,69 @@ std::vector<wxRealPoint> wxPLHistogramPlot::GetExportableDataset(double, double,
     return data;
 }
 
-void wxPLHistogramPlot::RecalculateHistogram() {
-    //This method builds histogram data. (basically, just groups and counts WPPlotData)
-    //Histogram data is stored in a local array m_histData.
-    //Uses WPPlotData to build this data.
+void wxPLHistogramPlot::ReadDataRange() {
+    //The range takes in all the values, zeros too, and does not depend on the bins.
+    size_t len = Len();
+    if (len < 2) return;
+
+    // NaN values (missing data) are not counted; comparisons with them are false
+    m_dataMin = std::numeric_limits<double>::infinity();
+    m_dataMax = -std::numeric_limits<double>::infinity();
+    std::vector<double> buf;
+    for (size_t start = 0; start < len; start += BLOCK_SIZE) {
+        size_t end = (len - start > BLOCK_SIZE) ? start + BLOCK_SIZE : len;
+        ExtendMinMax(m_data->GetValues(start, end, buf), end - start, &m_dataMin, &m_dataMax);
+    }
+}
 
-    size_t index;
-    size_t DataCount = 0;
+void wxPLHistogramPlot::RecalculateHistogram() {
+    //This method builds histogram data. (basically, just groups and counts the values)
+    //The counts are kept in m_binCounts and normalized into m_histData.
 
+    m_binCounts.clear();
     m_histData.clear();
     m_histDataBinRanges.clear();
-
-    if (m_data.size() < 2 || m_numberOfBins < 1) return;
-
-    m_dataMin = m_data[0].y;
-    m_dataMax = m_data[0].y;
-    for (size_t i = 1; i < m_data.size(); i++) {
-        if (m_data[i].y < m_dataMin) m_dataMin = m_data[i].y;
-        if (m_data[i].y > m_dataMax) m_dataMax = m_data[i].y;
+    m_binRangesValid = false;
+    m_dataCount = 0;
+
+    size_t len = Len();
+    if (len < 2 || m_numberOfBins < 1) return;
+    if (m_dataMin >= m_dataMax) return;
+
+    //Counting into interleaved sets of counters keeps runs of values in one bin from waiting on each other.
+    const size_t SETS = 4;
+    size_t stride = m_numberOfBins + 1;
+    std::vector<size_t> counts(SETS * stride, 0);
+    std::vector<int> bins(BLOCK_SIZE);
+    std::vector<double> buf;
+    for (size_t start = 0; start < len; start += BLOCK_SIZE) {
+        size_t n = (len - start > BLOCK_SIZE) ? BLOCK_SIZE : len - start;
+        GetBinIndices(m_data->GetValues(start, start + n, buf), n, m_dataMin, m_dataMax, m_numberOfBins,
+                      m_ignoreZeros, &bins[0]);
+        for (size_t i = 0; i < n; i++)
+            counts[(i % SETS) * stride + bins[i]]++;
     }
 
-    if (m_dataMin == m_dataMax) return;
-
-    m_histData.resize(m_numberOfBins, 0.0);
-    m_histDataBinRanges.resize(m_numberOfBins, wxRealPoint(m_dataMax, m_dataMin));
-
-    for (size_t i = 0; i < m_data.size(); i++) {
-        if (!m_ignoreZeros || m_data[i].y != 0) DataCount++;
-        if (m_ignoreZeros && m_data[i].y == 0) continue;
-
-        index = m_numberOfBins * (m_data[i].y - m_dataMin) / (m_dataMax - m_dataMin);
-        if (index >= m_numberOfBins)
-            index--;
-
-        if (index < m_histData.size()) {
-            m_histData[index]++;
-            if (m_histDataBinRanges[index].x > m_data[i].y) { m_histDataBinRanges[index].x = m_data[i].y; }
-            if (m_histDataBinRanges[index].y < m_data[i].y) { m_histDataBinRanges[index].y = m_data[i].y; }
-        }
+    m_binCounts.resize(m_numberOfBins, 0.0);
+    for (size_t i = 0; i < m_numberOfBins; i++) {
+        for (size_t k = 0; k < SETS; k++)
+            m_binCounts[i] += counts[k * stride + i];
+        m_dataCount += m_binCounts[i];
     }
     //We now have a histogram...
 
+    NormalizeHistogram();
+}
+
+void wxPLHistogramPlot::NormalizeHistogram() {
+    if (m_binCounts.empty()) return;
+
+    m_histData = m_binCounts;
     m_niceMax = 0;
     if (m_normalize) {
         //Here we normalize it so that we show percent on the y axis instead of the count.
         for (size_t i = 0; i < m_numberOfBins; i++) {
-            m_histData[i] *= 100.0f / (double) DataCount;
+            m_histData[i] *= 100.0f / m_dataCount;
             if (m_normalizeToPdf) {
                 //This scales so total area is equal to 1 (like a pdf).
                 double binWidth = (m_dataMax - m_dataMin) / ((double) m_numberOfBins);
@@ -296,6 +423,29 @@ void wxPLHistogramPlot::RecalculateHistogram() {
     m_niceMax += interval - fmod(m_niceMax, interval);
 }
 
+void wxPLHistogramPlot::CalculateBinRanges() const {
+    //The smallest and largest value in each bin, which only the exported data needs.
+    m_histDataBinRanges.clear();
+    m_binRangesValid = true;
+    if (m_binCounts.empty()) return;
+
+    m_histDataBinRanges.resize(m_numberOfBins, wxRealPoint(m_dataMax, m_dataMin));
+    size_t len = Len();
+    std::vector<int> bins(BLOCK_SIZE);
+    std::vector<double> buf;
+    for (size_t start = 0; start < len; start += BLOCK_SIZE) {
+        size_t n = (len - start > BLOCK_SIZE) ? BLOCK_SIZE : len - start;
+        const double *y = m_data->GetValues(start, start + n, buf);
+        GetBinIndices(y, n, m_dataMin, m_dataMax, m_numberOfBins, m_ignoreZeros, &bins[0]);
+        for (size_t i = 0; i < n; i++) {
+            if (bins[i] >= (int) m_numberOfBins) continue;
+            wxRealPoint &range = m_histDataBinRanges[bins[i]];
+            if (range.x > y[i]) { range.x = y[i]; }
+            if (range.y < y[i]) { range.y = y[i]; }
+        }
+    }
+}
+
 int wxPLHistogramPlot::GetSturgesBinsFor(int nDataPoints) {
     return (int) ceil(log10(double(nDataPoints)) / log10(2.0) + 1); //Sturges formula.
 }
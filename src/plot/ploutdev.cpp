@@ -231,6 +231,25 @@ void wxPLPdfOutputDevice::Measure(const wxString &text, double *width, double *h
     if (height) *height = m_pdf.GetFontSize();
 }
 
+void wxPLPdfOutputDevice::Image(const wxImage &img, double x, double y, double width, double height) {
+    if (!img.IsOk() || width <= 0 || height <= 0) return;
+
+    // viewers smooth images that are stretched a lot, so enlarge small ones by
+    // whole pixel factors up to about two pixels per point to keep edges sharp
+    int xfactor = wxMin(16, wxMax(1, (int) ceil(2.0 * width / img.GetWidth())));
+    int yfactor = wxMin(16, wxMax(1, (int) ceil(2.0 * height / img.GetHeight())));
+
+    // the document reuses images with the same name, so every call needs its own
+    static unsigned long s_imageCount = 0;
+    wxString name(wxString::Format("wxPLImage%lu", ++s_imageCount));
+
+    if (xfactor > 1 || yfactor > 1)
+        m_pdf.Image(name, img.Scale(img.GetWidth() * xfactor, img.GetHeight() * yfactor, wxIMAGE_QUALITY_NEAREST),
+                    x, y, width, height);
+    else
+        m_pdf.Image(name, img, x, y, width, height);
+}
+
 #define CAST(x) ((int)wxRound(m_scale*(x)))
 
 static void TranslateBrush(wxBrush *b, const wxColour &c, wxPLOutputDevice::Style sty) {
@@ -575,3 +594,12 @@ void wxPLGraphicsOutputDevice::Measure(const wxString &text, double *width, doub
         *width = (wxCoord) (w + 0.5) / m_scale;
 #endif
 }
+
+void wxPLGraphicsOutputDevice::Image(const wxImage &img, double x, double y, double width, double height) {
+    if (!img.IsOk() || width <= 0 || height <= 0) return;
+
+    wxInterpolationQuality quality = m_gc->GetInterpolationQuality();
+    m_gc->SetInterpolationQuality(wxINTERPOLATION_NONE);
+    m_gc->DrawBitmap(wxBitmap(img), SCALE(x), SCALE(y), SCALE(width), SCALE(height));
+    m_gc->SetInterpolationQuality(quality);
+}
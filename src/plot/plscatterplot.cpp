@@ -31,12 +31,31 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <algorithm>
+#include <math.h>
 
 #include <wx/dc.h>
+#include <wx/image.h>
 
 #include "wex/plot/plcolourmap.h"
 #include "wex/plot/plscatterplot.h"
 
+// shades from a faint tint of the series colour to the colour itself
+class wxPLDensityColourMap : public wxPLColourMap {
+public:
+    wxPLDensityColourMap(const wxColour &c, double min, double max)
+            : wxPLColourMap(min, max) {
+        const int steps = 32;
+        for (int i = 0; i < steps; i++) {
+            double f = 0.25 + 0.75 * i / (steps - 1);
+            m_colourList.push_back(wxColour((unsigned char) (255 - f * (255 - c.Red())),
+                                            (unsigned char) (255 - f * (255 - c.Green())),
+                                            (unsigned char) (255 - f * (255 - c.Blue()))));
+        }
+    }
+
+    virtual wxString GetName() { return _("Density"); }
+};
+
 wxPLScatterPlot::wxPLScatterPlot() {
     m_cmap = 0;
     m_colour = *wxBLUE;
@@ -44,6 +63,7 @@ wxPLScatterPlot::wxPLScatterPlot() {
     m_scale = false;
     m_antiAliasing = false;
     m_drawLineOfPerfectAgreement = false;
+    m_densityThreshold = 0;
 }
 
 wxPLScatterPlot::wxPLScatterPlot(const std::vector<wxRealPoint> &data,
@@ -59,6 +79,7 @@ wxPLScatterPlot::wxPLScatterPlot(const std::vector<wxRealPoint> &data,
     m_scale = scale;
     m_antiAliasing = false;
     m_drawLineOfPerfectAgreement = false;
+    m_densityThreshold = 0;
 }
 
 wxPLScatterPlot::~wxPLScatterPlot() {
@@ -107,24 +128,28 @@ void wxPLScatterPlot::Draw(wxPLOutputDevice &dc, const wxPLDeviceMapping &map) {
 
     bool has_sizes = (m_sizes.size() == len);
 
-    for (size_t i = 0; i < len; i++) {
-        const wxRealPoint p = At(i);
-        if (p.x >= min.x && p.x <= max.x
-            && p.y >= min.y && p.y <= max.y) {
-            double rad = m_radius;
-
-            if (has_sizes) {
-                rad = m_sizes[i];
-                if (rad < 1) rad = 1;
+    if (IsDensityShown())
+        DrawDensity(dc, map);
+    else {
+        for (size_t i = 0; i < len; i++) {
+            const wxRealPoint p = At(i);
+            if (p.x >= min.x && p.x <= max.x
+                && p.y >= min.y && p.y <= max.y) {
+                double rad = m_radius;
+
+                if (has_sizes) {
+                    rad = m_sizes[i];
+                    if (rad < 1) rad = 1;
+                }
+
+                if (zcmap) {
+                    wxColour C(zcmap->ColourForValue(m_colours[i]));
+                    dc.Pen(C, 1);
+                    dc.Brush(C);
+                }
+
+                dc.Circle(map.ToDevice(p), rad);
             }
-
-            if (zcmap) {
-                wxColour C(zcmap->ColourForValue(m_colours[i]));
-                dc.Pen(C, 1);
-                dc.Brush(C);
-            }
-
-            dc.Circle(map.ToDevice(p), rad);
         }
     }
 
@@ -144,6 +169,54 @@ void wxPLScatterPlot::Draw(wxPLOutputDevice &dc, const wxPLDeviceMapping &map) {
     }
 }
 
+void wxPLScatterPlot::CountDensity(const wxPLDeviceMapping &map, double cell, int width, int height,
+                                   std::vector<unsigned int> &counts) {
+    wxRealPoint min = map.GetWorldMinimum();
+    wxRealPoint max = map.GetWorldMaximum();
+    wxRealPoint pos;
+    map.GetDeviceExtents(&pos, 0);
+
+    size_t len = Len();
+    for (size_t i = 0; i < len; i++) {
+        const wxRealPoint p = At(i);
+        if (p.x >= min.x && p.x <= max.x
+            && p.y >= min.y && p.y <= max.y)
+            counts[DensityCellIndex(map.ToDevice(p), pos, cell, width, height)]++;
+    }
+}
+
+void wxPLScatterPlot::DrawDensity(wxPLOutputDevice &dc, const wxPLDeviceMapping &map) {
+    wxRealPoint pos, size;
+    map.GetDeviceExtents(&pos, &size);
+
+    double cell = std::max(1.0, m_radius);
+    int width = std::max(1, (int) ceil(size.x / cell));
+    int height = std::max(1, (int) ceil(size.y / cell));
+
+    std::vector<unsigned int> counts((size_t) width * height, 0);
+    CountDensity(map, cell, width, height, counts);
+
+    unsigned int maxCount = *std::max_element(counts.begin(), counts.end());
+    if (maxCount == 0) return;
+
+    // shade by log count so sparse cells still show next to dense clusters
+    std::vector<double> levels(counts.size());
+    for (size_t i = 0; i < counts.size(); i++)
+        levels[i] = log(1.0 + counts[i]);
+
+    wxPLDensityColourMap cmap(m_colour, 0, log(1.0 + maxCount));
+    wxImage img(width, height, false);
+    cmap.ColoursForValues(&levels[0], levels.size(), img.GetData());
+
+    // empty cells let the plots underneath show through
+    img.SetAlpha();
+    unsigned char *alpha = img.GetAlpha();
+    for (size_t i = 0; i < counts.size(); i++)
+        alpha[i] = counts[i] > 0 ? 255 : 0;
+
+    dc.Image(img, pos.x, pos.y, width * cell, height * cell);
+}
+
 void wxPLScatterPlot::DrawInLegend(wxPLOutputDevice &dc, const wxPLRealRect &rct) {
     dc.Pen(m_colour, 1);
     dc.Brush(m_colour);
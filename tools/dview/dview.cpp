@@ -56,8 +56,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <wx/cmdline.h>
 #include <wx/tokenzr.h>
 #include <wx/msgdlg.h>
+#include <wx/timer.h>
 
 #include "wex/dview/dvplotctrl.h"
+#include "wex/dview/dvfileloader.h"
 #include "wex/dview/dvfilereader.h"
 
 #include "wex/plot/plplotctrl.h"
@@ -71,6 +73,10 @@ enum {
     // up to 100 recent items can be accommodated
             ID_RECENT,
     ID_RECENT_LAST = ID_RECENT + MAX_RECENT,
+    ID_FOLLOW_DATA,
+    ID_FOLLOW_TIMER,
+    ID_CANCEL_LOADING,
+    ID_FILE_LOADER,
 };
 
 class DViewFrame : public wxFrame {
@@ -81,12 +87,18 @@ private:
     wxMenu *mFileMenu, *mRecentMenu;
     wxString mRecentFiles[MAX_RECENT];
     wxArrayString mFileNames;
+    bool mFollowData;
+    wxTimer mFollowTimer;
+    std::vector<wxDVFileFollower> mFollowers;
+    wxDVFileLoader *mLoader;
 
 public:
 
     DViewFrame()
             : wxFrame(0, wxID_ANY, "Data Viewer", wxDefaultPosition, wxSize(800, 600)) {
         mRecentCount = 0;
+        mFollowData = false;
+        mFollowTimer.SetOwner(this, ID_FOLLOW_TIMER);
 
 #ifdef __WXMSW__
         SetIcon(wxIcon("appicon"));
@@ -98,6 +110,9 @@ public:
         mFileMenu->Append(wxID_OPEN, "Open...\tCtrl-O");
         mFileMenu->Append(wxID_ADD, "Append...\tCtrl-A");
         mFileMenu->Append(wxID_CLEAR, "Clear\tCtrl-W");
+        mFileMenu->AppendCheckItem(ID_FOLLOW_DATA, "Follow Appended Data");
+        mFileMenu->Append(ID_CANCEL_LOADING, "Cancel Loading\tEsc");
+        mFileMenu->Enable(ID_CANCEL_LOADING, false);
         mFileMenu->AppendSeparator();
         mFileMenu->Append(ID_RECENT_FILES, "Recent", mRecentMenu);
 
@@ -115,6 +130,8 @@ public:
 
         mPlotCtrl = new wxDVPlotCtrl(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, 0);
         mPlotCtrl->DisplayTabs();
+        mLoader = new wxDVFileLoader(mPlotCtrl, this, ID_FILE_LOADER);
+        CreateStatusBar();
 
         wxConfig cfg("DView", "NREL");
         long ct = 0;
@@ -135,6 +152,8 @@ public:
         }
 
         cfg.Read("LastDirectory", &mLastDir);
+        cfg.Read("FollowData", &mFollowData);
+        mFileMenu->Check(ID_FOLLOW_DATA, mFollowData);
 
         int x = 0, y = 0, width = 0, height = 0;
         bool maximized = false;
@@ -156,6 +175,10 @@ public:
         UpdateRecentMenu();
     }
 
+    virtual ~DViewFrame() {
+        delete mLoader; // before the plot, which the loader adds to
+    }
+
     void UpdateRecentMenu() {
         int i;
         for (i = 0; i < MAX_RECENT; i++) {
@@ -253,6 +276,9 @@ public:
     }
 
     void OnCloseFrame(wxCloseEvent &) {
+        StopFollowing();
+        mLoader->Cancel();
+
         /* save window position */
         bool b_maximize = this->IsMaximized();
         int f_x, f_y, f_width, f_height;
@@ -271,6 +297,7 @@ public:
         }
 
         cfg.Write("LastDirectory", mLastDir);
+        cfg.Write("FollowData", mFollowData);
         cfg.Write("FrameX", f_x);
         cfg.Write("FrameY", f_y);
         cfg.Write("FrameWidth", f_width);
@@ -280,21 +307,44 @@ public:
         Destroy();
     }
 
-    bool Load(const wxArrayString &filenames) {
-        bool FileExists = false;
-
+    // In the background, files are read by mLoader and show up as they are ready, see OnFileLoader;
+    // followed and Energy+ sql files are always read right away.
+    bool Load(const wxArrayString &filenames, bool background = true) {
         wxBeginBusyCursor();
 
-        for (size_t i = 0; i < filenames.GetCount(); i++) {
-            for (size_t j = 0; j < mFileNames.GetCount(); j++) {
-                if (filenames[i] == mFileNames[j]) {
-                    FileExists = true;
-                    break;
-                }
-            }
+        // When reading right away, several weather files are parsed at once up front;
+        // data sets are still added in the order given.
+        bool now = !background || mFollowData;
+        wxArrayString weatherFiles;
+        for (size_t i = 0; i < filenames.GetCount() && now; i++) {
+            if (wxDVFileReader::IsWeatherFile(filenames[i]) && mFileNames.Index(filenames[i]) == wxNOT_FOUND
+                && weatherFiles.Index(filenames[i]) == wxNOT_FOUND)
+                weatherFiles.Add(filenames[i]);
+        }
+        std::vector<std::vector<wxDVArrayDataSet *> > weatherData;
+        if (weatherFiles.GetCount() > 1)
+            wxDVFileReader::ReadWeatherFiles(weatherFiles, weatherData);
 
-            if (!FileExists) {
-                if (!wxDVFileReader::FastRead(mPlotCtrl, filenames[i])) {
+        for (size_t i = 0; i < filenames.GetCount(); i++) {
+            bool FileExists = mFileNames.Index(filenames[i]) != wxNOT_FOUND || mLoader->IsLoading(filenames[i]);
+
+            if (!FileExists && !now && filenames[i].Right(3).CmpNoCase("sql") != 0) {
+                mLoader->Load(filenames[i]);
+                mFileMenu->Enable(ID_CANCEL_LOADING, true);
+            } else if (!FileExists) {
+                bool ok;
+                int w = weatherFiles.Index(filenames[i]);
+                if (w != wxNOT_FOUND && (size_t) w < weatherData.size()) {
+                    ok = wxDVFileReader::AddWeatherDataSets(mPlotCtrl, filenames[i], weatherData[w]);
+                } else if (mFollowData) {
+                    mFollowers.push_back(wxDVFileFollower());
+                    ok = wxDVFileReader::FastRead(mPlotCtrl, filenames[i], 8760, 1024, true, &mFollowers.back());
+                    if (!mFollowers.back().IsOk())
+                        mFollowers.pop_back();
+                } else
+                    ok = wxDVFileReader::FastRead(mPlotCtrl, filenames[i]);
+
+                if (!ok) {
                     wxMessageBox(
                             wxT("The selected file is not of the correct format, is corrupt, no longer exists, or you do not have permission to open it."),
                             wxT("Error opening file."), wxICON_ERROR);
@@ -309,9 +359,91 @@ public:
 
         UpdateRecentMenu();
         wxEndBusyCursor();
+
+        if (mFollowers.size() > 0 && !mFollowTimer.IsRunning())
+            mFollowTimer.Start(1000);
         return true;
     }
 
+    void OnFileLoader(wxDVFileLoaderEvent &evt) {
+        wxString fileName = evt.GetFileName();
+        switch (evt.GetStatusCode()) {
+            case wxDVFileLoaderEvent::PROGRESS: {
+                wxString text = wxString::Format("Loading %s... %d%%", wxFileNameFromPath(fileName).c_str(),
+                                                 evt.GetPercent());
+                if (evt.GetFilesQueued() > 0)
+                    text += wxString::Format(" (%d more files)", evt.GetFilesQueued());
+                SetStatusText(text + "  Press Esc to cancel.");
+                break;
+            }
+            case wxDVFileLoaderEvent::LOADED:
+                AddRecent(fileName);
+                mFileNames.Add(fileName);
+                break;
+            case wxDVFileLoaderEvent::CANCELED:
+                //Channels published before the cancel stay in the plot; opening the file again would add them twice.
+                if (evt.GetDataSetsAdded() > 0 && mFileNames.Index(fileName) == wxNOT_FOUND)
+                    mFileNames.Add(fileName);
+                break;
+            case wxDVFileLoaderEvent::FAILED:
+                wxMessageBox(
+                        wxT("The selected file is not of the correct format, is corrupt, no longer exists, or you do not have permission to open it."),
+                        wxT("Error opening file."), wxICON_ERROR);
+                RemoveRecent(fileName);
+                break;
+        }
+
+        if (evt.GetStatusCode() != wxDVFileLoaderEvent::PROGRESS && !mLoader->IsBusy()) {
+            SetStatusText(evt.GetStatusCode() == wxDVFileLoaderEvent::CANCELED ? "Loading canceled." : "");
+            mFileMenu->Enable(ID_CANCEL_LOADING, false);
+        }
+    }
+
+    // must be called before the followed data sets are removed from the plot
+    void StopFollowing() {
+        mFollowTimer.Stop();
+        mFollowers.clear();
+    }
+
+    void OnFollowTimer(wxTimerEvent &) {
+        mPlotCtrl->GetStatisticsTable()->WaitForStatistics(); //The data sets are read while their statistics are computed.
+        mPlotCtrl->Freeze();
+        for (size_t k = 0; k < mFollowers.size(); k++) {
+            std::vector<size_t> prevLengths;
+            int rows = mFollowers[k].ReadAppendedRows(prevLengths);
+            if (rows < 0) {
+                wxLogStatus("Stopped following %s", mFollowers[k].GetFileName().c_str());
+                mFollowers[k].Stop();
+            } else if (rows > 0) {
+                const std::vector<wxDVArrayDataSet *> &dataSets = mFollowers[k].GetDataSets();
+                for (size_t i = 0; i < dataSets.size(); i++)
+                    mPlotCtrl->UpdateDataSet(dataSets[i], prevLengths[i], i + 1 == dataSets.size());
+            }
+        }
+        mPlotCtrl->Thaw();
+
+        for (size_t k = mFollowers.size(); k > 0; k--) {
+            if (!mFollowers[k - 1].IsOk())
+                mFollowers.erase(mFollowers.begin() + k - 1);
+        }
+        if (mFollowers.size() == 0)
+            mFollowTimer.Stop();
+    }
+
+    void OnFollowData(wxCommandEvent &evt) {
+        mFollowData = evt.IsChecked();
+        StopFollowing();
+        mLoader->Cancel();
+
+        // reload the open files so they are followed from where they end now
+        if (mFollowData && mFileNames.GetCount() > 0) {
+            wxArrayString files = mFileNames;
+            mPlotCtrl->RemoveAllDataSets();
+            mFileNames.Clear();
+            Load(files);
+        }
+    }
+
     void Open() {
         wxFileDialog fdlg(this, "Open Data File", mLastDir, "",
                           "All Files|*.*|CSV Files(*.csv)|*.csv|TXT Files(*.txt)|*.txt|SQL Files(*.sql)|*.sqlv|TMY3 Files(*.tmy3)|*.tmy3|EPW Files(*.epw)|*.epw",
@@ -327,6 +459,8 @@ public:
         switch (evt.GetId()) {
             case wxID_OPEN:
                 // clear everything first
+                StopFollowing();
+                mLoader->Cancel();
                 mPlotCtrl->RemoveAllDataSets();
                 mFileNames.Clear();
                 mPlotCtrl->SetOkToAccessState(true);
@@ -340,6 +474,8 @@ public:
                 break;
             case wxID_CLEAR:
                 mPlotCtrl->SetOkToAccessState(true);
+                StopFollowing();
+                mLoader->Cancel();
                 mPlotCtrl->RemoveAllDataSets();
                 mFileNames.Clear();
                 break;
@@ -348,6 +484,9 @@ public:
                 wxMessageBox(wxT("DView (" + wxGetLibraryVersionInfo().GetVersionString() + ") Version "
                                          __DATE__));
                 break;
+            case ID_CANCEL_LOADING:
+                mLoader->Cancel();
+                break;
             case wxID_EXIT:
                 Close(false);
                 break;
@@ -368,8 +507,12 @@ BEGIN_EVENT_TABLE(DViewFrame, wxFrame)
                 EVT_MENU(wxID_CLEAR, DViewFrame::OnCommand)
                 EVT_MENU(wxID_EXIT, DViewFrame::OnCommand)
                 EVT_MENU(wxID_ABOUT, DViewFrame::OnCommand)
+                EVT_MENU(ID_CANCEL_LOADING, DViewFrame::OnCommand)
+                EVT_DVFILELOADER(ID_FILE_LOADER, DViewFrame::OnFileLoader)
                 EVT_CLOSE(DViewFrame::OnCloseFrame)
                 EVT_MENU_RANGE(ID_RECENT, ID_RECENT + MAX_RECENT, DViewFrame::OnRecent)
+                EVT_MENU(ID_FOLLOW_DATA, DViewFrame::OnFollowData)
+                EVT_TIMER(ID_FOLLOW_TIMER, DViewFrame::OnFollowTimer)
 
 END_EVENT_TABLE()
 
@@ -399,7 +542,7 @@ public:
         DViewFrame *frame = new DViewFrame;
 
         if (m_arg_filenames.Count() > 0)
-            frame->Load(m_arg_filenames);
+            frame->Load(m_arg_filenames, false); // the options below apply to the data read
 
         if (m_arg_tab != -1)
             frame->GetPlot()->SelectTabIndex(m_arg_tab);